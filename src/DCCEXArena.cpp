@@ -0,0 +1,164 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXArena.h"
+
+#ifdef DCCEX_STATIC_MEMORY
+static StaticStringPool<DCCEX_STATIC_NAME_BYTES> namePool;
+#endif
+
+// class ListArena
+// Public methods
+
+ListArena::ListArena() : _buffer(nullptr), _capacity(0), _used(0), _ownsBuffer(false), _overflowCount(0) {}
+
+bool ListArena::begin(size_t capacity) {
+  end();
+#ifdef DCCEX_STATIC_MEMORY
+  (void)capacity;
+  return false;
+#else
+  if (capacity == 0)
+    return false;
+
+  _buffer = new uint8_t[capacity];
+  if (_buffer == nullptr)
+    return false;
+
+  _capacity = capacity;
+  _ownsBuffer = true;
+  return true;
+#endif
+}
+
+bool ListArena::begin(void *buffer, size_t size) {
+  end();
+  if (buffer == nullptr || size == 0)
+    return false;
+
+  _buffer = (uint8_t *)buffer;
+  _capacity = size;
+  _ownsBuffer = false;
+  return true;
+}
+
+void ListArena::end() {
+  if (_ownsBuffer && _buffer) {
+    delete[] _buffer;
+  }
+  _buffer = nullptr;
+  _capacity = 0;
+  _used = 0;
+  _ownsBuffer = false;
+  _overflowCount = 0;
+}
+
+bool ListArena::isEnabled() { return _buffer != nullptr; }
+
+void *ListArena::allocate(size_t size, size_t alignment) {
+  if (!_buffer)
+    return nullptr;
+
+  // Align relative to the real address so caller-provided buffers need no particular alignment
+  uintptr_t current = (uintptr_t)_buffer + _used;
+  uintptr_t aligned = (current + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+  size_t padding = aligned - current;
+
+  if (_used + padding + size > _capacity) {
+    _overflowCount++;
+    return nullptr;
+  }
+
+  _used += padding + size;
+  return (void *)aligned;
+}
+
+bool ListArena::owns(const void *ptr) {
+  if (!_buffer || !ptr)
+    return false;
+  const uint8_t *p = (const uint8_t *)ptr;
+  return (p >= _buffer && p < _buffer + _capacity);
+}
+
+void ListArena::reset() {
+  _used = 0;
+  _overflowCount = 0;
+}
+
+size_t ListArena::getBytesUsed() { return _used; }
+
+size_t ListArena::getCapacity() { return _capacity; }
+
+int ListArena::getOverflowCount() { return _overflowCount; }
+
+char *ListArena::copyString(ListArena *arena, const void *owner, const char *source, size_t reserve) {
+  if (source == nullptr)
+    return nullptr;
+
+  size_t length = strlen(source) + 1;
+  char *copy = nullptr;
+  if (arena && arena->owns(owner)) {
+    copy = (char *)arena->allocate(reserve + length, 1);
+  }
+  if (copy == nullptr) {
+#ifdef DCCEX_STATIC_MEMORY
+    return namePool.copy(source, reserve);
+#else
+    copy = new char[reserve + length];
+    if (copy == nullptr)
+      return nullptr;
+#endif
+  }
+  memcpy(copy + reserve, source, length);
+  return copy;
+}
+
+void ListArena::freeString(ListArena *arena, char *string) {
+  if (string == nullptr)
+    return;
+  if (arena && arena->owns(string))
+    return;
+#ifdef DCCEX_STATIC_MEMORY
+  namePool.release(string);
+#else
+  delete[] string;
+#endif
+}
+
+void ListArena::release(ListArena *arena, void *ptr) {
+  if (ptr == nullptr)
+    return;
+  if (arena && arena->owns(ptr))
+    return;
+  ::operator delete(ptr);
+}
+
+#ifdef DCCEX_STATIC_MEMORY
+StaticPoolStats ListArena::getNamePoolStats() { return namePool.getStats(); }
+#endif
+
+ListArena::~ListArena() { end(); }
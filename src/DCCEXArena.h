@@ -0,0 +1,187 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXARENA_H
+#define DCCEXARENA_H
+
+#include "DCCEXStaticPool.h"
+#include <Arduino.h>
+#include <new>
+
+const size_t ARENA_ALIGNMENT = 8; // Alignment for objects carved from an arena
+
+/**
+ * @brief Bump allocator used to carve an object list and its names from one contiguous block
+ * @details An arena is either allocated once on the heap via begin(capacity), or uses a caller-provided buffer via
+ * begin(buffer, size). Individual allocations are never freed, instead the whole arena is reset in one step once the
+ * list that uses it has been cleared. When an arena is full, callers fall back to normal heap allocation so a list is
+ * never truncated.
+ */
+class ListArena {
+public:
+  /**
+   * @brief Construct a new, disabled ListArena object
+   */
+  ListArena();
+
+  /**
+   * @brief Allocate a single block from the heap for this arena
+   * @details With DCCEX_STATIC_MEMORY defined this always fails, use begin(buffer, size) instead.
+   * @param capacity Size of the block in bytes
+   * @return true If the block was allocated
+   * @return false If allocation failed, the arena remains disabled
+   */
+  bool begin(size_t capacity);
+
+  /**
+   * @brief Use a caller-provided buffer for this arena, the buffer must outlive the arena
+   * @param buffer Pointer to the buffer
+   * @param size Size of the buffer in bytes
+   * @return true If the buffer is usable
+   * @return false If the buffer is nullptr or zero sized
+   */
+  bool begin(void *buffer, size_t size);
+
+  /**
+   * @brief Release the block (if heap allocated) and disable the arena
+   * @details Anything still allocated from the arena is invalid once this is called.
+   */
+  void end();
+
+  /**
+   * @brief Check if the arena has a block to allocate from
+   * @return true If enabled
+   * @return false If not
+   */
+  bool isEnabled();
+
+  /**
+   * @brief Allocate bytes from the arena
+   * @param size Number of bytes required
+   * @param alignment Alignment required (must be a power of 2)
+   * @return void* Pointer to the allocated bytes, or nullptr if disabled or full
+   */
+  void *allocate(size_t size, size_t alignment = ARENA_ALIGNMENT);
+
+  /**
+   * @brief Check if the provided pointer was allocated from this arena
+   * @param ptr Pointer to check
+   * @return true If the pointer is within the arena's block
+   * @return false If not
+   */
+  bool owns(const void *ptr);
+
+  /**
+   * @brief Free everything allocated from the arena in one step
+   * @details Only call this once all objects allocated from the arena have been destroyed.
+   */
+  void reset();
+
+  /**
+   * @brief Get the number of bytes currently allocated from the arena (including alignment padding)
+   * @return size_t Bytes used
+   */
+  size_t getBytesUsed();
+
+  /**
+   * @brief Get the size of the arena's block
+   * @return size_t Capacity in bytes
+   */
+  size_t getCapacity();
+
+  /**
+   * @brief Get the number of allocations that did not fit and fell back to the heap since the last reset
+   * @return int Count of overflowed allocations
+   */
+  int getOverflowCount();
+
+  /**
+   * @brief Create an object in the arena if provided and there is room, otherwise on the heap
+   * @details Objects created this way must be deleted with delete, the class must define an operator delete that
+   * calls ListArena::release() so arena memory is not handed back to the heap.
+   * @tparam T Type of object to create
+   * @tparam Args Constructor argument types
+   * @param arena Pointer to the arena to use, may be nullptr
+   * @param args Constructor arguments
+   * @return T* Pointer to the new object
+   */
+  template <typename T, typename... Args> static T *create(ListArena *arena, Args... args) {
+    void *memory = (arena) ? arena->allocate(sizeof(T)) : nullptr;
+    if (memory)
+      return ::new (memory) T(args...);
+    return new T(args...);
+  }
+
+  /**
+   * @brief Copy a string into the same storage as its owner
+   * @details If the owning object lives in the arena, the copy is carved from the arena, otherwise it is allocated on
+   * the heap with new[], or from the static name pool with DCCEX_STATIC_MEMORY defined.
+   * @param arena Pointer to the arena used by the owner's list, may be nullptr
+   * @param owner Pointer to the object that will own the string
+   * @param source String to copy
+   * @param reserve Optional - bytes to reserve in front of the copy, for data stored alongside the string
+   * @return char* Pointer to the start of the block, with the copy reserve bytes in, or nullptr if source is nullptr
+   */
+  static char *copyString(ListArena *arena, const void *owner, const char *source, size_t reserve = 0);
+
+  /**
+   * @brief Free a string created by copyString(), this does nothing for arena allocated strings
+   * @param arena Pointer to the arena used by the owner's list, may be nullptr
+   * @param string String to free
+   */
+  static void freeString(ListArena *arena, char *string);
+
+  /**
+   * @brief Free the memory of a destroyed object, this does nothing for arena allocated objects
+   * @details Intended to be called from class specific operator delete implementations.
+   * @param arena Pointer to the arena used by the object's list, may be nullptr
+   * @param ptr Pointer to the memory to free
+   */
+  static void release(ListArena *arena, void *ptr);
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Get the usage of the static name pool used for strings outside an arena
+   * @return StaticPoolStats Pool usage in bytes
+   */
+  static StaticPoolStats getNamePoolStats();
+#endif
+
+  /**
+   * @brief Destroy the ListArena object, releasing any heap allocated block
+   */
+  ~ListArena();
+
+private:
+  uint8_t *_buffer;
+  size_t _capacity;
+  size_t _used;
+  bool _ownsBuffer;
+  int _overflowCount;
+};
+
+#endif // DCCEXARENA_H
@@ -24,25 +24,41 @@
 
 // CSConsist public methods
 
-CSConsist *CSConsist::_first = nullptr;
+CSConsist::List CSConsist::_list;
 bool CSConsist::_alwaysReplicateFunctions = false;
+CSConsistIndexEntry *CSConsist::_memberIndex = nullptr;
+int CSConsist::_memberIndexCapacity = 0;
+int CSConsist::_memberIndexCount = 0;
+bool CSConsist::_memberIndexComplete = true;
+
+#ifdef DCCEX_STATIC_MEMORY
+static StaticPool<sizeof(CSConsist), DCCEX_STATIC_CSCONSISTS> csConsistPool;
+static StaticPool<sizeof(CSConsistMember), DCCEX_STATIC_CSCONSIST_MEMBERS> csConsistMemberPool;
+
+// Smallest power of 2 index that stays at most half full with every member pool slot in use
+static constexpr int staticIndexCapacity(int capacity) {
+  return (capacity >= DCCEX_STATIC_CSCONSIST_MEMBERS * 2) ? capacity : staticIndexCapacity(capacity * 2);
+}
+static CSConsistIndexEntry staticMemberIndex[staticIndexCapacity(CSCONSIST_INDEX_MIN_CAPACITY)];
 
-CSConsist::CSConsist(bool replicateFunctions)
-    : _replicateFunctions(replicateFunctions), _firstMember(nullptr), _next(nullptr), _memberCount(0) {
-  if (!_first) {
-    _first = this;
-  } else {
-    CSConsist *current = _first;
-    while (current->_next != nullptr) {
-      current = current->_next;
-    }
-    current->_next = this;
-  }
+void *CSConsistMember::operator new(size_t size) noexcept {
+  (void)size;
+  return csConsistMemberPool.allocate();
+}
+
+void CSConsistMember::operator delete(void *ptr) { csConsistMemberPool.release(ptr); }
+
+StaticPoolStats CSConsistMember::getPoolStats() { return csConsistMemberPool.getStats(); }
+#endif
+
+CSConsist::CSConsist(bool replicateFunctions) : _replicateFunctions(replicateFunctions), _next(nullptr) {
+  _list.append(this);
   if (_alwaysReplicateFunctions)
     _replicateFunctions = true;
+  MemoryStats::addObject(MemoryCSConsists, sizeof(CSConsist));
 }
 
-CSConsist *CSConsist::getFirst() { return _first; }
+CSConsist *CSConsist::getFirst() { return _list.getFirst(); }
 
 CSConsist *CSConsist::getNext() { return _next; }
 
@@ -54,61 +70,41 @@ void CSConsist::addMember(int address, bool reversed) {
     return;
 
   CSConsistMember *member = new CSConsistMember((uint16_t)address, (uint16_t)reversed);
+  if (member == nullptr)
+    return;
 
-  if (_firstMember == nullptr) {
-    _firstMember = member;
-  } else {
-    CSConsistMember *current = _firstMember;
-    while (current->next != nullptr) {
-      current = current->next;
-    }
-    current->next = member;
-  }
-  _memberCount++;
+  _members.append(member);
+  MemoryStats::addObject(MemoryCSConsists, sizeof(CSConsistMember));
+  _indexAdd(member->address, this);
 }
 
 void CSConsist::removeMember(int address) {
-  CSConsistMember *previous = nullptr;
-  CSConsistMember *current = _firstMember;
-  while (current) {
-    if (current->address == (uint16_t)address) {
-      CSConsistMember *next = current->next;
-      if (previous) {
-        previous->next = next;
-      } else {
-        _firstMember = next;
-      }
-      delete current;
-      current = next;
-    } else {
-      previous = current;
-      current = current->next;
-    }
-  }
-
-  if (!_firstMember)
-    _firstMember = nullptr;
+  CSConsistMember *member = getMember(address);
+  if (member == nullptr)
+    return;
 
-  _memberCount--;
-  if (_memberCount < 0)
-    _memberCount = 0;
+  _members.remove(member);
+  delete member;
+  MemoryStats::addObject(MemoryCSConsists, -(long)sizeof(CSConsistMember));
+  _indexRemove((uint16_t)address, this);
 }
 
 void CSConsist::removeAllMembers() {
-  CSConsistMember *current = _firstMember;
-  while (current != nullptr) {
-    CSConsistMember *next = current->next;
-    delete current;
-    current = next;
+  while (CSConsistMember *member = _members.getFirst()) {
+    uint16_t address = member->address;
+    _members.remove(member);
+    delete member;
+    MemoryStats::addObject(MemoryCSConsists, -(long)sizeof(CSConsistMember));
+    _indexRemove(address, this);
   }
-  _firstMember = nullptr;
-  _memberCount = 0;
 }
 
-CSConsistMember *CSConsist::getFirstMember() { return _firstMember; }
+CSConsistMember *CSConsist::getFirstMember() { return _members.getFirst(); }
+
+const CSConsistMemberList &CSConsist::getMemberList() { return _members; }
 
 CSConsistMember *CSConsist::getMember(int address) {
-  for (CSConsistMember *member = _firstMember; member; member = member->next) {
+  for (CSConsistMember *member : _members) {
     if (member->address == (uint16_t)address) {
       return member;
     }
@@ -118,7 +114,7 @@ CSConsistMember *CSConsist::getMember(int address) {
 }
 
 bool CSConsist::isInConsist(int address) {
-  for (CSConsistMember *member = _firstMember; member; member = member->next) {
+  for (CSConsistMember *member : _members) {
     if (member->address == (uint16_t)address) {
       return true;
     }
@@ -128,7 +124,7 @@ bool CSConsist::isInConsist(int address) {
 }
 
 bool CSConsist::isReversed(int address) {
-  for (CSConsistMember *member = _firstMember; member; member = member->next) {
+  for (CSConsistMember *member : _members) {
     if (member->address == (uint16_t)address) {
       return member->reversed;
     }
@@ -137,20 +133,32 @@ bool CSConsist::isReversed(int address) {
   return false;
 }
 
-bool CSConsist::isValid() { return (_memberCount > 1); }
+bool CSConsist::isValid() { return (_members.getCount() > 1); }
 
-int CSConsist::getMemberCount() { return _memberCount; }
+int CSConsist::getMemberCount() { return _members.getCount(); }
 
 void CSConsist::clearCSConsists() {
-  if (!_first)
-    return;
+  while (_list.getFirst() != nullptr)
+    delete _list.getFirst();
 
-  while (_first != nullptr)
-    delete _first;
+  // With no members left, the index can be trusted again
+  _memberIndexComplete = true;
 }
 
 CSConsist *CSConsist::getLeadLocoCSConsist(int address) {
-  for (CSConsist *csConsist = _first; csConsist; csConsist = csConsist->getNext()) {
+  // A lead loco is a member, so if it's indexed against a single CSConsist that is the only candidate
+  if (_memberIndexComplete) {
+    int slot = _indexFind((uint16_t)address);
+    if (slot < 0)
+      return nullptr;
+    if (_memberIndex[slot].count == 1) {
+      CSConsist *csConsist = _memberIndex[slot].csConsist;
+      CSConsistMember *first = csConsist->getFirstMember();
+      return (first && first->address == (uint16_t)address) ? csConsist : nullptr;
+    }
+  }
+
+  for (CSConsist *csConsist : _list) {
     CSConsistMember *first = csConsist->getFirstMember();
     if (first && first->address == (uint16_t)address) {
       return csConsist;
@@ -160,8 +168,13 @@ CSConsist *CSConsist::getLeadLocoCSConsist(int address) {
 }
 
 CSConsist *CSConsist::getMemberCSConsist(int address) {
-  for (CSConsist *csConsist = _first; csConsist; csConsist = csConsist->getNext()) {
-    for (CSConsistMember *member = csConsist->getFirstMember(); member; member = member->next) {
+  if (_memberIndexComplete) {
+    int slot = _indexFind((uint16_t)address);
+    return (slot < 0) ? nullptr : _memberIndex[slot].csConsist;
+  }
+
+  for (CSConsist *csConsist : _list) {
+    for (CSConsistMember *member : csConsist->_members) {
       if (member->address == (uint16_t)address) {
         return csConsist;
       }
@@ -170,6 +183,8 @@ CSConsist *CSConsist::getMemberCSConsist(int address) {
   return nullptr;
 }
 
+const CSConsist::List &CSConsist::getList() { return _list; }
+
 void CSConsist::setAlwaysReplicateFunctions(bool replicate) { _alwaysReplicateFunctions = replicate; }
 
 bool CSConsist::getAlwaysReplicateFunctions() { return _alwaysReplicateFunctions; }
@@ -178,24 +193,150 @@ void CSConsist::setReplicateFunctions(bool replicate) { _replicateFunctions = re
 
 bool CSConsist::getReplicateFunctions() { return _replicateFunctions; }
 
+#ifdef DCCEX_STATIC_MEMORY
+void *CSConsist::operator new(size_t size) noexcept {
+  (void)size;
+  return csConsistPool.allocate();
+}
+
+void CSConsist::operator delete(void *ptr) { csConsistPool.release(ptr); }
+
+StaticPoolStats CSConsist::getPoolStats() { return csConsistPool.getStats(); }
+#endif
+
 CSConsist::~CSConsist() {
   // Clean up the member list first
   removeAllMembers();
 
-  // If there's no CSConsist list, no need to clean up
-  if (!_first)
+  // Clean up the CSConsist linked list
+  _list.remove(this);
+  MemoryStats::addObject(MemoryCSConsists, -(long)sizeof(CSConsist));
+}
+
+// CSConsist private methods
+
+int CSConsist::_indexSlot(uint16_t address) { return (int)((address * 40503U) & (_memberIndexCapacity - 1)); }
+
+int CSConsist::_indexFind(uint16_t address) {
+  if (_memberIndex == nullptr)
+    return -1;
+
+  // Linear probing, the index is never full so an empty slot always ends the search
+  for (int slot = _indexSlot(address);; slot = (slot + 1) & (_memberIndexCapacity - 1)) {
+    if (_memberIndex[slot].address == address)
+      return slot;
+    if (_memberIndex[slot].address == CSCONSIST_INDEX_EMPTY)
+      return -1;
+  }
+}
+
+void CSConsist::_indexAdd(uint16_t address, CSConsist *csConsist) {
+  int slot = _indexFind(address);
+  if (slot >= 0) {
+    _memberIndex[slot].count++;
     return;
+  }
 
-  // Clean up the CSConsist linked list
-  if (_first == this) {
-    _first = this->_next;
-  } else {
-    CSConsist *current = _first;
-    while (current->getNext() != this) {
-      current = current->_next;
+  // Keep the index at most half full so probe sequences stay short
+  if ((_memberIndexCount + 1) * 2 > _memberIndexCapacity && !_indexGrow()) {
+    if (_memberIndexCount + 1 >= _memberIndexCapacity) {
+      _memberIndexComplete = false;
+      return;
     }
-    if (current->_next) {
-      current->_next = this->_next;
+  }
+
+  for (slot = _indexSlot(address); _memberIndex[slot].address != CSCONSIST_INDEX_EMPTY;
+       slot = (slot + 1) & (_memberIndexCapacity - 1)) {
+  }
+  _memberIndex[slot].address = address;
+  _memberIndex[slot].count = 1;
+  _memberIndex[slot].csConsist = csConsist;
+  _memberIndexCount++;
+}
+
+void CSConsist::_indexRemove(uint16_t address, CSConsist *csConsist) {
+  int slot = _indexFind(address);
+  if (slot < 0)
+    return;
+
+  CSConsistIndexEntry *entry = &_memberIndex[slot];
+  if (entry->count > 1) {
+    // Still a member elsewhere, if it was indexed against this CSConsist find the other one
+    entry->count--;
+    if (entry->csConsist == csConsist) {
+      for (CSConsist *other : _list) {
+        if (other != csConsist && other->isInConsist(address)) {
+          entry->csConsist = other;
+          break;
+        }
+      }
+    }
+    return;
+  }
+
+  // Shift following entries back so no probe sequence is broken by the empty slot
+  int mask = _memberIndexCapacity - 1;
+  int empty = slot;
+  for (int next = (slot + 1) & mask; _memberIndex[next].address != CSCONSIST_INDEX_EMPTY; next = (next + 1) & mask) {
+    int preferred = _indexSlot(_memberIndex[next].address);
+    if (((next - preferred) & mask) >= ((next - empty) & mask)) {
+      _memberIndex[empty] = _memberIndex[next];
+      empty = next;
+    }
+  }
+  _memberIndex[empty].address = CSCONSIST_INDEX_EMPTY;
+  _memberIndexCount--;
+
+  // Release the index once there are no members left
+  if (_memberIndexCount == 0) {
+    MemoryStats::addBufferBytes(MemoryCSConsists, -(long)(_memberIndexCapacity * sizeof(CSConsistIndexEntry)));
+#ifndef DCCEX_STATIC_MEMORY
+    delete[] _memberIndex;
+#endif
+    _memberIndex = nullptr;
+    _memberIndexCapacity = 0;
+    _memberIndexComplete = true;
+  }
+}
+
+bool CSConsist::_indexGrow() {
+#ifdef DCCEX_STATIC_MEMORY
+  // The static index is sized for every member so never needs to grow
+  if (_memberIndex)
+    return false;
+  for (CSConsistIndexEntry &entry : staticMemberIndex) {
+    entry.address = CSCONSIST_INDEX_EMPTY;
+  }
+  _memberIndex = staticMemberIndex;
+  _memberIndexCapacity = sizeof(staticMemberIndex) / sizeof(staticMemberIndex[0]);
+  MemoryStats::addBufferBytes(MemoryCSConsists, sizeof(staticMemberIndex));
+  return true;
+#else
+  int capacity = (_memberIndexCapacity == 0) ? CSCONSIST_INDEX_MIN_CAPACITY : _memberIndexCapacity * 2;
+  CSConsistIndexEntry *index = new CSConsistIndexEntry[capacity];
+  if (index == nullptr)
+    return false;
+
+  for (int slot = 0; slot < capacity; slot++) {
+    index[slot].address = CSCONSIST_INDEX_EMPTY;
+  }
+
+  // Re-insert all existing entries into the new slots
+  CSConsistIndexEntry *oldIndex = _memberIndex;
+  int oldCapacity = _memberIndexCapacity;
+  _memberIndex = index;
+  _memberIndexCapacity = capacity;
+  for (int oldSlot = 0; oldSlot < oldCapacity; oldSlot++) {
+    if (oldIndex[oldSlot].address == CSCONSIST_INDEX_EMPTY)
+      continue;
+    int slot = _indexSlot(oldIndex[oldSlot].address);
+    while (_memberIndex[slot].address != CSCONSIST_INDEX_EMPTY) {
+      slot = (slot + 1) & (capacity - 1);
     }
+    _memberIndex[slot] = oldIndex[oldSlot];
   }
+  delete[] oldIndex;
+  MemoryStats::addBufferBytes(MemoryCSConsists, (long)((capacity - oldCapacity) * sizeof(CSConsistIndexEntry)));
+  return true;
+#endif
 }
@@ -23,6 +23,9 @@
 #ifndef DCCEXCSCONSIST_H
 #define DCCEXCSCONSIST_H
 
+#include "DCCEXList.h"
+#include "DCCEXMemory.h"
+#include "DCCEXStaticPool.h"
 #include <Arduino.h>
 
 /**
@@ -39,6 +42,44 @@ struct CSConsistMember {
    * @param reversed True if reversed to normal direction of travel
    */
   CSConsistMember(int address, bool reversed) : address(address), reversed(reversed), next(nullptr) {}
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Allocate a CSConsistMember from a static pool of DCCEX_STATIC_CSCONSIST_MEMBERS objects
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Return a CSConsistMember to the static pool
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+  /**
+   * @brief Get the usage of the static pool CSConsistMember objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+};
+
+class CSConsist;
+
+/// @brief List of CSConsistMember objects, linked by their next pointer
+typedef IntrusiveList<CSConsistMember, &CSConsistMember::next> CSConsistMemberList;
+
+const uint16_t CSCONSIST_INDEX_EMPTY = 0xFFFF; // Address used to mark an empty member index slot
+const int CSCONSIST_INDEX_MIN_CAPACITY = 16;  // Initial number of slots in the member index (must be a power of 2)
+
+/**
+ * @brief Structure for an entry in the CSConsist member index
+ */
+struct CSConsistIndexEntry {
+  uint16_t address;     // DCC address of the member, or CSCONSIST_INDEX_EMPTY
+  uint16_t count;       // Number of CSConsist objects this address is a member of
+  CSConsist *csConsist; // CSConsist the address was first added to
 };
 
 /**
@@ -144,6 +185,8 @@ public:
 
   /**
    * @brief Get the CSConsist the provided address is a member of
+   * @details This uses an index of member addresses maintained by addMember() and removeMember(). Should an address be
+   * a member of more than one CSConsist, the one it was first added to is returned.
    * @param address DCC address of the member loco to check for
    * @return CSConsist* Pointer to the CSConsist object, or nullptr if none found
    */
@@ -176,6 +219,27 @@ public:
    */
   bool getReplicateFunctions();
 
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Allocate a CSConsist from a static pool of DCCEX_STATIC_CSCONSISTS objects
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Return a CSConsist to the static pool
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+  /**
+   * @brief Get the usage of the static pool CSConsist objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+
   /**
    * @brief Destroy the CSConsist object
    */
@@ -183,11 +247,67 @@ public:
 
 private:
   bool _replicateFunctions;
-  CSConsistMember *_firstMember;
+  CSConsistMemberList _members;
   CSConsist *_next;
-  int _memberCount;
-  static CSConsist *_first;
   static bool _alwaysReplicateFunctions;
+  static CSConsistIndexEntry *_memberIndex; // Open addressed hash table of member address to CSConsist
+  static int _memberIndexCapacity;          // Number of slots in the member index
+  static int _memberIndexCount;             // Number of used slots in the member index
+  static bool _memberIndexComplete;         // False if an allocation failure left addresses out of the index
+
+  /**
+   * @brief Get the preferred slot for an address in the member index
+   * @param address DCC address
+   * @return int Slot number
+   */
+  static int _indexSlot(uint16_t address);
+
+  /**
+   * @brief Find the slot holding an address in the member index
+   * @param address DCC address
+   * @return int Slot number, or -1 if not found
+   */
+  static int _indexFind(uint16_t address);
+
+  /**
+   * @brief Add a member address to the index
+   * @param address DCC address of the member
+   * @param csConsist Pointer to the CSConsist it was added to
+   */
+  static void _indexAdd(uint16_t address, CSConsist *csConsist);
+
+  /**
+   * @brief Remove a member address from the index once it has been removed from a CSConsist
+   * @param address DCC address of the member
+   * @param csConsist Pointer to the CSConsist it was removed from
+   */
+  static void _indexRemove(uint16_t address, CSConsist *csConsist);
+
+  /**
+   * @brief Double the number of slots in the member index
+   * @return true If the index was resized
+   * @return false If allocation failed
+   */
+  static bool _indexGrow();
+
+public:
+  /// @brief List of CSConsist objects, linked by their next pointer
+  typedef IntrusiveList<CSConsist, &CSConsist::_next> List;
+
+  /**
+   * @brief Get the list of CSConsist objects, which can be used in range-based for loops
+   * @return const List& Reference to the CSConsist list
+   */
+  static const List &getList();
+
+  /**
+   * @brief Get the list of members of this CSConsist, which can be used in range-based for loops
+   * @return const CSConsistMemberList& Reference to the member list
+   */
+  const CSConsistMemberList &getMemberList();
+
+private:
+  static List _list;
 };
 
 #endif // DCCEXCSCONSIST_H
@@ -0,0 +1,278 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXCVBatch.h"
+
+static const int MAX_CV = 1024;
+
+// class DCCEXCVBatch
+// Public methods
+
+DCCEXCVBatch::DCCEXCVBatch(DCCEXProtocol *protocol)
+    : _protocol(protocol), _entries(nullptr), _capacity(0), _count(0), _ownsEntries(false), _running(false),
+      _cancelled(false), _restoring(false), _nextToQueue(0), _nextToComplete(0), _failed(0), _startTime(0),
+      _endTime(0), _callback(nullptr), _context(nullptr) {}
+
+bool DCCEXCVBatch::begin(int capacity) {
+  end();
+#ifdef DCCEX_STATIC_MEMORY
+  (void)capacity;
+  return false;
+#else
+  if (capacity <= 0)
+    return false;
+
+  _entries = new CVBatchEntry[capacity];
+  if (_entries == nullptr)
+    return false;
+
+  _capacity = capacity;
+  _ownsEntries = true;
+  return true;
+#endif
+}
+
+bool DCCEXCVBatch::begin(CVBatchEntry *entries, int capacity) {
+  end();
+  if (entries == nullptr || capacity <= 0)
+    return false;
+
+  _entries = entries;
+  _capacity = capacity;
+  _ownsEntries = false;
+  return true;
+}
+
+void DCCEXCVBatch::end() {
+  if (_running)
+    return;
+
+  if (_ownsEntries && _entries) {
+    delete[] _entries;
+  }
+  _entries = nullptr;
+  _capacity = 0;
+  _count = 0;
+  _ownsEntries = false;
+}
+
+bool DCCEXCVBatch::addCV(int cv, uint8_t value) {
+  if (_running || cv < 1 || cv > MAX_CV || _count == _capacity)
+    return false;
+
+  CVBatchEntry &entry = _entries[_count++];
+  entry.cv = cv;
+  entry.value = value;
+  entry.status = CVBatchPending;
+  return true;
+}
+
+int DCCEXCVBatch::addRange(int first, int last) {
+  int added = 0;
+  for (int cv = first; cv <= last; cv++) {
+    if (!addCV(cv))
+      break;
+    added++;
+  }
+  return added;
+}
+
+void DCCEXCVBatch::clear() {
+  if (!_running)
+    _count = 0;
+}
+
+bool DCCEXCVBatch::startBackup(CVBatchProgressCallback callback, void *context) {
+  return _start(false, callback, context);
+}
+
+bool DCCEXCVBatch::startRestore(CVBatchProgressCallback callback, void *context) {
+  return _start(true, callback, context);
+}
+
+void DCCEXCVBatch::cancel() { _cancelled = true; }
+
+bool DCCEXCVBatch::isRunning() { return _running; }
+
+CVBatchProgress DCCEXCVBatch::getProgress() {
+  CVBatchProgress progress;
+  progress.total = _count;
+  progress.completed = _nextToComplete;
+  progress.failed = _failed;
+  progress.elapsed = (_running ? millis() : _endTime) - _startTime;
+  progress.cvsPerMinute = progress.elapsed > 0 ? (unsigned long)progress.completed * 60000UL / progress.elapsed : 0;
+  progress.eta = 0;
+  if (_running && progress.completed > 0) {
+    progress.eta = progress.elapsed / progress.completed * (progress.total - progress.completed);
+  }
+  return progress;
+}
+
+int DCCEXCVBatch::getCount() { return _count; }
+
+CVBatchEntry *DCCEXCVBatch::getEntry(int index) {
+  if (index < 0 || index >= _count)
+    return nullptr;
+
+  return &_entries[index];
+}
+
+int DCCEXCVBatch::writeTo(Print *stream) {
+  if (stream == nullptr)
+    return 0;
+
+  int written = 0;
+  stream->println("# DCCEX CV backup: cv,value");
+  for (int index = 0; index < _count; index++) {
+    if (_entries[index].status != CVBatchDone)
+      continue;
+    stream->print((int)_entries[index].cv);
+    stream->print(',');
+    stream->println((int)_entries[index].value);
+    written++;
+  }
+  return written;
+}
+
+int DCCEXCVBatch::readFrom(Stream *stream) {
+  if (stream == nullptr || _running)
+    return 0;
+
+  _count = 0;
+  char line[16];
+  int length = 0;
+  bool overlong = false;
+  while (stream->available()) {
+    int c = stream->read();
+    if (c != '\n' && c != '\r') {
+      if (length < (int)sizeof(line) - 1) {
+        line[length++] = c;
+      } else {
+        overlong = true;
+      }
+      if (stream->available())
+        continue;
+    }
+
+    // Parse the completed line, which may be the last one with no line ending
+    line[length] = 0;
+    if (length > 0 && line[0] != '#' && !overlong) {
+      char *comma = strchr(line, ',');
+      int cv = atoi(line);
+      int value = comma ? atoi(comma + 1) : -1;
+      if (comma && value >= 0 && value <= 255)
+        addCV(cv, value);
+    }
+    length = 0;
+    overlong = false;
+  }
+  return _count;
+}
+
+DCCEXCVBatch::~DCCEXCVBatch() {
+  // Operations still queued would call back into this batch once destroyed
+  if (_running && _protocol)
+    _protocol->cancelCVOperations(this);
+  _running = false;
+  end();
+}
+
+// Private methods
+
+bool DCCEXCVBatch::_start(bool restoring, CVBatchProgressCallback callback, void *context) {
+  if (_running || _count == 0 || _protocol == nullptr)
+    return false;
+
+  _restoring = restoring;
+  _callback = callback;
+  _context = context;
+  _cancelled = false;
+  _nextToQueue = 0;
+  _nextToComplete = 0;
+  _failed = 0;
+  _startTime = millis();
+  _endTime = 0;
+  for (int index = 0; index < _count; index++) {
+    _entries[index].status = CVBatchPending;
+  }
+
+  // Once one operation is queued, each completion frees a slot in the protocol's table before calling back, so the
+  // batch can always queue its next operation and only a full table at the start can stop it
+  _running = true;
+  _queueOperations();
+  if (_nextToQueue == 0) {
+    _running = false;
+    return false;
+  }
+  return true;
+}
+
+void DCCEXCVBatch::_queueOperations() {
+  while (!_cancelled && _nextToQueue < _count && _nextToQueue - _nextToComplete < CV_BATCH_PIPELINE_DEPTH) {
+    CVBatchEntry &entry = _entries[_nextToQueue];
+    int id;
+    if (_restoring) {
+      id = _protocol->writeCV(entry.cv, entry.value, _operationComplete, this);
+    } else {
+      id = _protocol->readCV(entry.cv, _operationComplete, this);
+    }
+    if (id == -1)
+      break;
+    _nextToQueue++;
+  }
+}
+
+void DCCEXCVBatch::_finish() {
+  _running = false;
+  _endTime = millis();
+  if (_callback)
+    _callback(getProgress(), _context);
+}
+
+void DCCEXCVBatch::_operationComplete(const CVOperation &operation, void *context) {
+  DCCEXCVBatch *batch = (DCCEXCVBatch *)context;
+  if (!batch->_running || batch->_nextToComplete >= batch->_nextToQueue)
+    return;
+
+  // Tracked operations complete in the order they were queued
+  CVBatchEntry &entry = batch->_entries[batch->_nextToComplete++];
+  if (operation.result == CVResultSuccess) {
+    entry.status = CVBatchDone;
+    if (!batch->_restoring)
+      entry.value = operation.value;
+  } else {
+    entry.status = CVBatchFailed;
+    batch->_failed++;
+  }
+
+  batch->_queueOperations();
+  if (batch->_nextToComplete == batch->_nextToQueue && (batch->_cancelled || batch->_nextToQueue == batch->_count)) {
+    batch->_finish();
+  } else if (batch->_callback) {
+    batch->_callback(batch->getProgress(), batch->_context);
+  }
+}
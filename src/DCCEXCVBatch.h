@@ -0,0 +1,216 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXCVBATCH_H
+#define DCCEXCVBATCH_H
+
+#include "DCCEXProtocol.h"
+
+const int CV_BATCH_PIPELINE_DEPTH = 2; // Tracked operations a batch keeps queued, so the next follows each response
+
+/// @brief State of one CV in a batch
+enum CVBatchStatus {
+  CVBatchPending, // Not yet read or written
+  CVBatchDone,    // Read or written successfully
+  CVBatchFailed,  // Failed or timed out after any retries
+};
+
+/// @brief One CV in a batch, packed into 4 bytes
+struct CVBatchEntry {
+  uint16_t cv;    // CV number
+  uint8_t value;  // Value read, or value to write
+  uint8_t status; // CVBatchStatus of the CV
+};
+
+/// @brief Progress of a running batch, passed to its progress callback
+struct CVBatchProgress {
+  int total;                  // Number of CVs in the batch
+  int completed;              // Number of CVs done or failed
+  int failed;                 // Number of CVs failed
+  unsigned long elapsed;      // Time in ms since the batch started
+  unsigned long cvsPerMinute; // Throughput so far
+  unsigned long eta;          // Estimated time in ms until the batch completes
+};
+
+/// @brief Function called after each CV in a batch completes, and once more when the batch ends
+typedef void (*CVBatchProgressCallback)(const CVBatchProgress &progress, void *context);
+
+/**
+ * @brief Reads or writes a list of CVs on the programming track as tracked CV operations
+ * @details A backup reads every CV in the list with readCV(), and a restore writes each value with writeCV(). The
+ * batch keeps the next operation queued so it is sent as soon as each response arrives, leaving the programming track
+ * idle only while the command station works. Failed or timed out attempts are retried as set by
+ * DCCEXProtocol::setCVOperationTimeout(). Destroying a running batch cancels its queued operations.
+ */
+class DCCEXCVBatch {
+public:
+  /**
+   * @brief Construct a new, empty DCCEXCVBatch object
+   * @param protocol Protocol instance to send operations through
+   */
+  DCCEXCVBatch(DCCEXProtocol *protocol);
+
+  /**
+   * @brief Allocate storage for the list of CVs from the heap
+   * @details With DCCEX_STATIC_MEMORY defined this always fails, use begin(entries, capacity) instead.
+   * @param capacity Number of CVs the list can hold
+   * @return true If the storage was allocated
+   * @return false If allocation failed
+   */
+  bool begin(int capacity);
+
+  /**
+   * @brief Use a caller-provided array for the list of CVs, the array must outlive the batch
+   * @param entries Array of entries
+   * @param capacity Number of entries in the array
+   * @return true If the array is usable
+   * @return false If the array is nullptr or empty
+   */
+  bool begin(CVBatchEntry *entries, int capacity);
+
+  /**
+   * @brief Release the storage (if heap allocated) and empty the list, the batch must not be running
+   */
+  void end();
+
+  /**
+   * @brief Add a CV to the list
+   * @param cv CV number (1 - 1024)
+   * @param value Optional - value to write when restoring (default 0)
+   * @return true If added
+   * @return false If the CV is invalid, the list is full, or the batch is running
+   */
+  bool addCV(int cv, uint8_t value = 0);
+
+  /**
+   * @brief Add a range of CVs to the list
+   * @param first First CV number
+   * @param last Last CV number, inclusive
+   * @return int Number of CVs added, fewer than requested if the list filled up
+   */
+  int addRange(int first, int last);
+
+  /**
+   * @brief Empty the list, the batch must not be running
+   */
+  void clear();
+
+  /**
+   * @brief Read every CV in the list from the Loco on the programming track
+   * @param callback Function called with progress, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return true If started
+   * @return false If the list is empty, the batch is already running, or the protocol's table of tracked operations is
+   * full
+   */
+  bool startBackup(CVBatchProgressCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Write the value of every CV in the list to the Loco on the programming track
+   * @param callback Function called with progress, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return true If started
+   * @return false If the list is empty, the batch is already running, or the protocol's table of tracked operations is
+   * full
+   */
+  bool startRestore(CVBatchProgressCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Stop queueing operations, the batch stops running once those already queued complete
+   */
+  void cancel();
+
+  /**
+   * @brief Check if the batch is reading or writing CVs
+   * @return true If running
+   * @return false If not
+   */
+  bool isRunning();
+
+  /**
+   * @brief Get the progress of the current or last run
+   * @return CVBatchProgress Progress
+   */
+  CVBatchProgress getProgress();
+
+  /**
+   * @brief Get the number of CVs in the list
+   * @return int Count of CVs
+   */
+  int getCount();
+
+  /**
+   * @brief Get a CV in the list
+   * @param index Index in the list
+   * @return CVBatchEntry* Pointer to the entry, or nullptr if the index is invalid
+   */
+  CVBatchEntry *getEntry(int index);
+
+  /**
+   * @brief Write the CVs read or written successfully as text, one "cv,value" line each after a header comment
+   * @param stream Stream to write to, eg. a file
+   * @return int Number of CVs written
+   */
+  int writeTo(Print *stream);
+
+  /**
+   * @brief Replace the list with the CVs read from text in the format written by writeTo()
+   * @details Blank lines and lines starting with # are skipped, as are lines that are not a valid "cv,value".
+   * @param stream Stream to read from until no more is available, eg. a file
+   * @return int Number of CVs added to the list
+   */
+  int readFrom(Stream *stream);
+
+  /**
+   * @brief Destroy the DCCEXCVBatch object, cancelling any queued operations and releasing any heap allocated storage
+   */
+  ~DCCEXCVBatch();
+
+private:
+  DCCEXProtocol *_protocol;          // Protocol instance operations are sent through
+  CVBatchEntry *_entries;            // List of CVs
+  int _capacity;                     // Number of entries the list can hold
+  int _count;                        // Number of entries in the list
+  bool _ownsEntries;                 // Flag that the list was allocated from the heap
+  bool _running;                     // Flag that operations are queued or still to be queued
+  bool _cancelled;                   // Flag to stop queueing operations
+  bool _restoring;                   // Flag that the run writes rather than reads
+  int _nextToQueue;                  // Index of the next entry to queue an operation for
+  int _nextToComplete;               // Index of the next entry to complete, operations complete in order
+  int _failed;                       // Number of entries failed in this run
+  unsigned long _startTime;          // Time in ms the run started
+  unsigned long _endTime;            // Time in ms the run ended
+  CVBatchProgressCallback _callback; // Function called with progress, may be nullptr
+  void *_context;                    // Passed to the callback
+
+  bool _start(bool restoring, CVBatchProgressCallback callback, void *context);
+  void _queueOperations();
+  void _finish();
+  static void _operationComplete(const CVOperation &operation, void *context);
+};
+
+#endif // DCCEXCVBATCH_H
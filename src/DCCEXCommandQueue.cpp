@@ -0,0 +1,179 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXCommandQueue.h"
+
+#ifdef DCCEX_THREADED
+
+// class DCCEXCommandQueue
+// Public methods
+
+DCCEXCommandQueue::DCCEXCommandQueue(MemorySubsystem subsystem)
+    : _buffer(nullptr), _capacity(0), _head(0), _tail(0), _pending(0), _dropping(false), _overflowCount(0),
+      _ownsBuffer(false), _subsystem(subsystem) {}
+
+bool DCCEXCommandQueue::begin(size_t capacity) {
+  end();
+#ifdef DCCEX_STATIC_MEMORY
+  (void)capacity;
+  return false;
+#else
+  // One byte always stays free to tell a full ring from an empty one, and a command needs a terminator
+  if (capacity < 3)
+    return false;
+
+  _buffer = new char[capacity];
+  if (_buffer == nullptr)
+    return false;
+
+  _capacity = capacity;
+  _ownsBuffer = true;
+  MemoryStats::addBufferBytes(_subsystem, _capacity);
+  return true;
+#endif
+}
+
+bool DCCEXCommandQueue::begin(char *buffer, size_t capacity) {
+  end();
+  if (buffer == nullptr || capacity < 3)
+    return false;
+
+  _buffer = buffer;
+  _capacity = capacity;
+  _ownsBuffer = false;
+  return true;
+}
+
+void DCCEXCommandQueue::end() {
+  if (_ownsBuffer && _buffer) {
+    delete[] _buffer;
+    MemoryStats::addBufferBytes(_subsystem, -(long)_capacity);
+  }
+  _buffer = nullptr;
+  _capacity = 0;
+  _head.store(0);
+  _tail.store(0);
+  _pending = 0;
+  _dropping = false;
+  _overflowCount.store(0);
+  _ownsBuffer = false;
+}
+
+bool DCCEXCommandQueue::isEnabled() { return _buffer != nullptr; }
+
+bool DCCEXCommandQueue::append(char c) {
+  if (!_buffer || _dropping)
+    return false;
+
+  // Keep room for this character, the terminator, and the free byte
+  size_t tail = _tail.load(std::memory_order_acquire);
+  size_t used = (_pending + _capacity - tail) % _capacity;
+  if (used + 3 > _capacity) {
+    _dropping = true;
+    return false;
+  }
+
+  _buffer[_pending] = c;
+  if (++_pending == _capacity)
+    _pending = 0;
+  return true;
+}
+
+bool DCCEXCommandQueue::commit() {
+  size_t head = _head.load(std::memory_order_relaxed);
+  if (_dropping) {
+    _pending = head;
+    _dropping = false;
+    _overflowCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (!_buffer || _pending == head)
+    return false;
+
+  // append() kept room for the terminator
+  _buffer[_pending] = 0;
+  if (++_pending == _capacity)
+    _pending = 0;
+  _head.store(_pending, std::memory_order_release);
+  return true;
+}
+
+void DCCEXCommandQueue::discard() {
+  _pending = _head.load(std::memory_order_relaxed);
+  _dropping = false;
+}
+
+bool DCCEXCommandQueue::push(const char *command) {
+  if (command == nullptr)
+    return false;
+
+  while (*command) {
+    append(*command++);
+  }
+  return commit();
+}
+
+bool DCCEXCommandQueue::pop(char *command, size_t size) {
+  if (!_buffer)
+    return false;
+
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  if (tail == _head.load(std::memory_order_acquire))
+    return false;
+
+  size_t length = 0;
+  char c;
+  do {
+    c = _buffer[tail];
+    if (++tail == _capacity)
+      tail = 0;
+    if (length + 1 < size)
+      command[length++] = c;
+  } while (c != 0);
+  if (size > 0)
+    command[length] = 0;
+
+  _tail.store(tail, std::memory_order_release);
+  return true;
+}
+
+size_t DCCEXCommandQueue::getBytesUsed() {
+  if (!_buffer)
+    return 0;
+
+  size_t head = _head.load(std::memory_order_acquire);
+  size_t tail = _tail.load(std::memory_order_acquire);
+  return (head + _capacity - tail) % _capacity;
+}
+
+size_t DCCEXCommandQueue::getCapacity() { return _capacity; }
+
+unsigned long DCCEXCommandQueue::getOverflowCount() { return _overflowCount.load(std::memory_order_relaxed); }
+
+DCCEXCommandQueue::~DCCEXCommandQueue() { end(); }
+
+#endif // DCCEX_THREADED
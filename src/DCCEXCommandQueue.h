@@ -0,0 +1,157 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXCOMMANDQUEUE_H
+#define DCCEXCOMMANDQUEUE_H
+
+// Only available with DCCEX_THREADED defined, as it needs std::atomic which many Arduino platforms lack
+#ifdef DCCEX_THREADED
+
+#include "DCCEXMemory.h"
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Lock-free single producer, single consumer ring of text commands
+ * @details One thread writes commands and one other thread reads them, with no locks. Each command is stored with
+ * its terminator, so the ring holds as many commands as fit in its capacity in bytes. The producer builds a command
+ * with append() and publishes it with commit(), so the consumer never sees a partial command. A command that does not
+ * fit is dropped whole and counted. begin() and end() must only be called while neither thread is using the ring.
+ */
+class DCCEXCommandQueue {
+public:
+  /**
+   * @brief Construct a new, disabled DCCEXCommandQueue object
+   * @param subsystem Memory subsystem heap allocated storage is counted against
+   */
+  DCCEXCommandQueue(MemorySubsystem subsystem);
+
+  /**
+   * @brief Allocate storage for the ring from the heap
+   * @details With DCCEX_STATIC_MEMORY defined this always fails, use begin(buffer, capacity) instead.
+   * @param capacity Number of bytes the ring can hold, including a terminator for each command
+   * @return true If the storage was allocated
+   * @return false If allocation failed, the ring remains disabled
+   */
+  bool begin(size_t capacity);
+
+  /**
+   * @brief Use a caller-provided buffer for the ring, the buffer must outlive the ring
+   * @param buffer Pointer to the buffer
+   * @param capacity Number of bytes in the buffer
+   * @return true If the buffer is usable
+   * @return false If the buffer is nullptr or too small
+   */
+  bool begin(char *buffer, size_t capacity);
+
+  /**
+   * @brief Release the storage (if heap allocated), discard any commands, and disable the ring
+   */
+  void end();
+
+  /**
+   * @brief Check if the ring has storage to hold commands
+   * @return true If enabled
+   * @return false If not
+   */
+  bool isEnabled();
+
+  /**
+   * @brief Producer only - add a character to the command being written
+   * @param c Character to add
+   * @return true If added
+   * @return false If the ring is disabled or full, the command will be dropped when committed
+   */
+  bool append(char c);
+
+  /**
+   * @brief Producer only - publish the command being written to the consumer
+   * @return true If published
+   * @return false If nothing was written, or the command did not fit and was dropped
+   */
+  bool commit();
+
+  /**
+   * @brief Producer only - discard the command being written
+   */
+  void discard();
+
+  /**
+   * @brief Producer only - write and publish a whole command
+   * @param command Command to write
+   * @return true If published
+   * @return false If the command is empty, or did not fit and was dropped
+   */
+  bool push(const char *command);
+
+  /**
+   * @brief Consumer only - remove the oldest command from the ring
+   * @param command Buffer to copy the command into, longer commands are truncated
+   * @param size Size of the buffer in bytes, including the terminator
+   * @return true If a command was removed
+   * @return false If the ring is empty or disabled
+   */
+  bool pop(char *command, size_t size);
+
+  /**
+   * @brief Get the number of bytes of published commands waiting to be read
+   * @return size_t Bytes used
+   */
+  size_t getBytesUsed();
+
+  /**
+   * @brief Get the number of bytes the ring can hold
+   * @return size_t Capacity in bytes, 0 if disabled
+   */
+  size_t getCapacity();
+
+  /**
+   * @brief Get the number of commands dropped because the ring was full
+   * @return unsigned long Count of dropped commands
+   */
+  unsigned long getOverflowCount();
+
+  /**
+   * @brief Destroy the DCCEXCommandQueue object, releasing any heap allocated storage
+   */
+  ~DCCEXCommandQueue();
+
+private:
+  char *_buffer;                             // Storage for the ring
+  size_t _capacity;                          // Size of the storage in bytes
+  std::atomic<size_t> _head;                 // Count of bytes published, written only by the producer
+  std::atomic<size_t> _tail;                 // Count of bytes read, written only by the consumer
+  size_t _pending;                           // Count of bytes written by the producer, including unpublished ones
+  bool _dropping;                            // Flag that the command being written did not fit
+  std::atomic<unsigned long> _overflowCount; // Count of commands dropped because the ring was full
+  bool _ownsBuffer;                          // Flag that the storage was allocated from the heap
+  MemorySubsystem _subsystem;                // Memory subsystem heap allocated storage is counted against
+};
+
+#endif // DCCEX_THREADED
+
+#endif // DCCEXCOMMANDQUEUE_H
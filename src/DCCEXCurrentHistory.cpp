@@ -0,0 +1,141 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXCurrentHistory.h"
+
+// class DCCEXCurrentHistory
+// Public methods
+
+DCCEXCurrentHistory::DCCEXCurrentHistory()
+    : _samples(nullptr), _capacity(0), _head(0), _count(0), _sum(0), _ownsBuffer(false) {}
+
+bool DCCEXCurrentHistory::begin(int capacity) {
+  end();
+#ifdef DCCEX_STATIC_MEMORY
+  (void)capacity;
+  return false;
+#else
+  if (capacity <= 0)
+    return false;
+
+  _samples = new int[capacity];
+  if (_samples == nullptr)
+    return false;
+
+  _capacity = capacity;
+  _ownsBuffer = true;
+  MemoryStats::addBufferBytes(MemoryTelemetry, sizeof(int) * _capacity);
+  return true;
+#endif
+}
+
+bool DCCEXCurrentHistory::begin(int *buffer, int capacity) {
+  end();
+  if (buffer == nullptr || capacity <= 0)
+    return false;
+
+  _samples = buffer;
+  _capacity = capacity;
+  _ownsBuffer = false;
+  return true;
+}
+
+void DCCEXCurrentHistory::end() {
+  if (_ownsBuffer && _samples) {
+    delete[] _samples;
+    MemoryStats::addBufferBytes(MemoryTelemetry, -(long)(sizeof(int) * _capacity));
+  }
+  _samples = nullptr;
+  _capacity = 0;
+  _ownsBuffer = false;
+  clear();
+}
+
+bool DCCEXCurrentHistory::isEnabled() { return _samples != nullptr; }
+
+void DCCEXCurrentHistory::add(int sample) {
+  if (!_samples)
+    return;
+
+  if (_count == _capacity) {
+    _sum -= _samples[_head];
+  } else {
+    _count++;
+  }
+  _samples[_head] = sample;
+  _sum += sample;
+  _head = (_head + 1) % _capacity;
+}
+
+void DCCEXCurrentHistory::clear() {
+  _head = 0;
+  _count = 0;
+  _sum = 0;
+}
+
+int DCCEXCurrentHistory::getCount() { return _count; }
+
+int DCCEXCurrentHistory::getLatest() {
+  if (_count == 0)
+    return -1;
+
+  return _samples[(_head + _capacity - 1) % _capacity];
+}
+
+int DCCEXCurrentHistory::getMin() {
+  if (_count == 0)
+    return -1;
+
+  // The oldest samples are overwritten first, so the held ones always start at index 0 until the ring wraps
+  int min = _samples[0];
+  for (int i = 1; i < _count; i++) {
+    if (_samples[i] < min)
+      min = _samples[i];
+  }
+  return min;
+}
+
+int DCCEXCurrentHistory::getMax() {
+  if (_count == 0)
+    return -1;
+
+  int max = _samples[0];
+  for (int i = 1; i < _count; i++) {
+    if (_samples[i] > max)
+      max = _samples[i];
+  }
+  return max;
+}
+
+int DCCEXCurrentHistory::getMean() {
+  if (_count == 0)
+    return -1;
+
+  return _sum / _count;
+}
+
+DCCEXCurrentHistory::~DCCEXCurrentHistory() { end(); }
@@ -0,0 +1,131 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXCURRENTHISTORY_H
+#define DCCEXCURRENTHISTORY_H
+
+#include "DCCEXMemory.h"
+#include <Arduino.h>
+
+/**
+ * @brief Fixed-size ring of the most recent current samples for one track
+ * @details Once full, each new sample replaces the oldest. The mean is kept from a running sum, and the minimum and
+ * maximum are found from the samples held, so they roll with the history.
+ */
+class DCCEXCurrentHistory {
+public:
+  /**
+   * @brief Construct a new, disabled DCCEXCurrentHistory object
+   */
+  DCCEXCurrentHistory();
+
+  /**
+   * @brief Allocate storage for the samples from the heap
+   * @details With DCCEX_STATIC_MEMORY defined this always fails, use begin(buffer, capacity) instead.
+   * @param capacity Number of samples to keep
+   * @return true If the storage was allocated
+   * @return false If allocation failed, the history remains disabled
+   */
+  bool begin(int capacity);
+
+  /**
+   * @brief Use a caller-provided buffer for the samples, the buffer must outlive the history
+   * @param buffer Pointer to the buffer
+   * @param capacity Number of samples in the buffer
+   * @return true If the buffer is usable
+   * @return false If the buffer is nullptr or capacity is not positive
+   */
+  bool begin(int *buffer, int capacity);
+
+  /**
+   * @brief Release the storage (if heap allocated), discard all samples, and disable the history
+   */
+  void end();
+
+  /**
+   * @brief Check if the history has storage to hold samples
+   * @return true If enabled
+   * @return false If not
+   */
+  bool isEnabled();
+
+  /**
+   * @brief Add a sample, replacing the oldest if full
+   * @param sample Current sample
+   */
+  void add(int sample);
+
+  /**
+   * @brief Discard all samples, keeping the storage
+   */
+  void clear();
+
+  /**
+   * @brief Get the number of samples held
+   * @return int Sample count
+   */
+  int getCount();
+
+  /**
+   * @brief Get the most recent sample
+   * @return int Latest sample, -1 if there are none
+   */
+  int getLatest();
+
+  /**
+   * @brief Get the smallest sample held
+   * @return int Minimum, -1 if there are none
+   */
+  int getMin();
+
+  /**
+   * @brief Get the largest sample held
+   * @return int Maximum, -1 if there are none
+   */
+  int getMax();
+
+  /**
+   * @brief Get the mean of the samples held
+   * @return int Mean rounded down, -1 if there are none
+   */
+  int getMean();
+
+  /**
+   * @brief Destroy the DCCEXCurrentHistory object, releasing any heap allocated storage
+   */
+  ~DCCEXCurrentHistory();
+
+private:
+  int *_samples;    // Storage for the ring
+  int _capacity;    // Number of samples the ring can hold
+  int _head;        // Index the next sample is written to
+  int _count;       // Number of samples held
+  long _sum;        // Sum of the samples held
+  bool _ownsBuffer; // Flag that the storage was allocated from the heap
+};
+
+#endif // DCCEXCURRENTHISTORY_H
@@ -0,0 +1,584 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXProtocol.h"
+
+// class DCCEXEventQueue
+// Public methods
+
+DCCEXEventQueue::DCCEXEventQueue()
+    : _events(nullptr), _capacity(0), _head(0), _count(0), _peakCount(0), _overflowCount(0), _ownsBuffer(false) {}
+
+bool DCCEXEventQueue::begin(int capacity) {
+  end();
+#ifdef DCCEX_STATIC_MEMORY
+  (void)capacity;
+  return false;
+#else
+  if (capacity <= 0)
+    return false;
+
+  _events = new DCCEXEvent[capacity];
+  if (_events == nullptr)
+    return false;
+
+  _capacity = capacity;
+  _ownsBuffer = true;
+  MemoryStats::addBufferBytes(MemoryEvents, sizeof(DCCEXEvent) * _capacity);
+  return true;
+#endif
+}
+
+bool DCCEXEventQueue::begin(DCCEXEvent *buffer, int capacity) {
+  end();
+  if (buffer == nullptr || capacity <= 0)
+    return false;
+
+  _events = buffer;
+  _capacity = capacity;
+  _ownsBuffer = false;
+  return true;
+}
+
+void DCCEXEventQueue::end() {
+  if (_ownsBuffer && _events) {
+    delete[] _events;
+    MemoryStats::addBufferBytes(MemoryEvents, -(long)(sizeof(DCCEXEvent) * _capacity));
+  }
+  _events = nullptr;
+  _capacity = 0;
+  _head = 0;
+  _count = 0;
+  _peakCount = 0;
+  _overflowCount = 0;
+  _ownsBuffer = false;
+}
+
+bool DCCEXEventQueue::isEnabled() { return _events != nullptr; }
+
+DCCEXEvent *DCCEXEventQueue::push(DCCEXEventType type) {
+  if (!_events)
+    return nullptr;
+
+  if (_count == _capacity) {
+    _overflowCount++;
+    return nullptr;
+  }
+
+  int tail = _head + _count;
+  if (tail >= _capacity)
+    tail -= _capacity;
+  _count++;
+  if (_count > _peakCount)
+    _peakCount = _count;
+
+  DCCEXEvent *event = &_events[tail];
+  memset(event, 0, sizeof(DCCEXEvent));
+  event->type = type;
+  return event;
+}
+
+bool DCCEXEventQueue::pop(DCCEXEvent &event) {
+  if (_count == 0)
+    return false;
+
+  event = _events[_head];
+  if (++_head == _capacity)
+    _head = 0;
+  _count--;
+  return true;
+}
+
+void DCCEXEventQueue::clear() {
+  _head = 0;
+  _count = 0;
+}
+
+int DCCEXEventQueue::getCount() { return _count; }
+
+int DCCEXEventQueue::getCapacity() { return _capacity; }
+
+int DCCEXEventQueue::getPeakCount() { return _peakCount; }
+
+unsigned long DCCEXEventQueue::getOverflowCount() { return _overflowCount; }
+
+void DCCEXEventQueue::setText(DCCEXEvent *event, const char *text) {
+  if (text == nullptr)
+    return;
+  strncpy(event->text, text, DCCEX_EVENT_TEXT_LENGTH - 1);
+  event->text[DCCEX_EVENT_TEXT_LENGTH - 1] = '\0';
+}
+
+DCCEXEventQueue::~DCCEXEventQueue() { end(); }
+
+// class DCCEXEventRecorder
+// Public methods
+
+DCCEXEventRecorder::DCCEXEventRecorder(DCCEXEventQueue *queue) : _queue(queue) {}
+
+void DCCEXEventRecorder::receivedServerVersion(int major, int minor, int patch) {
+  _record(EventServerVersion, major, minor, patch);
+}
+
+void DCCEXEventRecorder::receivedMessage(const char *message) {
+  DCCEXEvent *event = _queue->push(EventMessage);
+  if (event)
+    DCCEXEventQueue::setText(event, message);
+}
+
+void DCCEXEventRecorder::receivedRosterList() { _record(EventRosterList); }
+
+void DCCEXEventRecorder::receivedTurnoutList() { _record(EventTurnoutList); }
+
+void DCCEXEventRecorder::receivedRouteList() { _record(EventRouteList); }
+
+void DCCEXEventRecorder::receivedTurntableList() { _record(EventTurntableList); }
+
+void DCCEXEventRecorder::receivedLocoUpdate(Loco *loco) {
+  DCCEXEvent *event = _queue->push(EventLocoUpdate);
+  if (event) {
+    event->values[0] = loco->getAddress();
+    event->object = loco;
+  }
+}
+
+void DCCEXEventRecorder::receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) {
+  _record(EventLocoBroadcast, address, speed, direction, functionMap);
+}
+
+void DCCEXEventRecorder::receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap,
+                                                        int mergedCount) {
+  DCCEXEvent *event = _record(EventLocoBroadcast, address, speed, direction, functionMap);
+  if (event)
+    event->values[4] = mergedCount;
+}
+
+void DCCEXEventRecorder::receivedTrackPower(TrackPower state) { _record(EventTrackPower, state); }
+
+void DCCEXEventRecorder::receivedTrackCurrentGauge(char track, int limit) {
+  _record(EventTrackCurrentGauge, track, limit);
+}
+
+void DCCEXEventRecorder::receivedTrackCurrent(char track, int current) { _record(EventTrackCurrent, track, current); }
+
+void DCCEXEventRecorder::receivedIndividualTrackPower(TrackPower state, int track) {
+  _record(EventIndividualTrackPower, state, track);
+}
+
+void DCCEXEventRecorder::receivedTrackType(char track, TrackManagerMode type, int address) {
+  _record(EventTrackType, track, type, address);
+}
+
+void DCCEXEventRecorder::receivedTurnoutAction(int turnoutId, bool thrown) {
+  _record(EventTurnoutAction, turnoutId, thrown);
+}
+
+void DCCEXEventRecorder::receivedTurntableAction(int turntableId, int position, bool moving) {
+  _record(EventTurntableAction, turntableId, position, moving);
+}
+
+void DCCEXEventRecorder::receivedReadLoco(int address) { _record(EventReadLoco, address); }
+
+void DCCEXEventRecorder::receivedValidateCV(int cv, int value) { _record(EventValidateCV, cv, value); }
+
+void DCCEXEventRecorder::receivedValidateCVBit(int cv, int bit, int value) {
+  _record(EventValidateCVBit, cv, bit, value);
+}
+
+void DCCEXEventRecorder::receivedWriteLoco(int address) { _record(EventWriteLoco, address); }
+
+void DCCEXEventRecorder::receivedWriteCV(int cv, int value) { _record(EventWriteCV, cv, value); }
+
+void DCCEXEventRecorder::receivedScreenUpdate(int screen, int row, const char *message) {
+  DCCEXEvent *event = _record(EventScreenUpdate, screen, row);
+  if (event)
+    DCCEXEventQueue::setText(event, message);
+}
+
+void DCCEXEventRecorder::receivedCSConsist(int leadLoco, CSConsist *csConsist) { _record(EventCSConsist, leadLoco); }
+
+void DCCEXEventRecorder::receivedSetFastClock(int minutes, int speedFactor) {
+  _record(EventSetFastClock, minutes, speedFactor);
+}
+
+void DCCEXEventRecorder::receivedFastClockTime(int minutes) { _record(EventFastClockTime, minutes); }
+
+void DCCEXEventRecorder::dispatch(const DCCEXEvent &event, DCCEXProtocolDelegate *delegate) {
+  if (!delegate)
+    return;
+
+  const int *v = event.values;
+  switch (event.type) {
+  case EventServerVersion:
+    delegate->receivedServerVersion(v[0], v[1], v[2]);
+    break;
+
+  case EventMessage:
+    delegate->receivedMessage(event.text);
+    break;
+
+  case EventRosterList:
+    delegate->receivedRosterList();
+    break;
+
+  case EventTurnoutList:
+    delegate->receivedTurnoutList();
+    break;
+
+  case EventRouteList:
+    delegate->receivedRouteList();
+    break;
+
+  case EventTurntableList:
+    delegate->receivedTurntableList();
+    break;
+
+  case EventLocoUpdate: {
+    // Only notify if the Loco has not been deleted since the event was recorded
+    Loco *loco = _findLoco(v[0], event.object);
+    if (loco)
+      delegate->receivedLocoUpdate(loco);
+    break;
+  }
+
+  case EventLocoBroadcast:
+    if (v[4] > 0) {
+      delegate->receivedCoalescedLocoBroadcast(v[0], v[1], (Direction)v[2], v[3], v[4]);
+    } else {
+      delegate->receivedLocoBroadcast(v[0], v[1], (Direction)v[2], v[3]);
+    }
+    break;
+
+  case EventTrackPower:
+    delegate->receivedTrackPower((TrackPower)v[0]);
+    break;
+
+  case EventTrackCurrentGauge:
+    delegate->receivedTrackCurrentGauge((char)v[0], v[1]);
+    break;
+
+  case EventTrackCurrent:
+    delegate->receivedTrackCurrent((char)v[0], v[1]);
+    break;
+
+  case EventIndividualTrackPower:
+    delegate->receivedIndividualTrackPower((TrackPower)v[0], v[1]);
+    break;
+
+  case EventTrackType:
+    delegate->receivedTrackType((char)v[0], (TrackManagerMode)v[1], v[2]);
+    break;
+
+  case EventTurnoutAction:
+    delegate->receivedTurnoutAction(v[0], v[1]);
+    break;
+
+  case EventTurntableAction:
+    delegate->receivedTurntableAction(v[0], v[1], v[2]);
+    break;
+
+  case EventReadLoco:
+    delegate->receivedReadLoco(v[0]);
+    break;
+
+  case EventValidateCV:
+    delegate->receivedValidateCV(v[0], v[1]);
+    break;
+
+  case EventValidateCVBit:
+    delegate->receivedValidateCVBit(v[0], v[1], v[2]);
+    break;
+
+  case EventWriteLoco:
+    delegate->receivedWriteLoco(v[0]);
+    break;
+
+  case EventWriteCV:
+    delegate->receivedWriteCV(v[0], v[1]);
+    break;
+
+  case EventScreenUpdate:
+    delegate->receivedScreenUpdate(v[0], v[1], event.text);
+    break;
+
+  case EventCSConsist:
+    // The CSConsist is looked up again in case it has been deleted since the event was recorded
+    delegate->receivedCSConsist(v[0], CSConsist::getLeadLocoCSConsist(v[0]));
+    break;
+
+  case EventSetFastClock:
+    delegate->receivedSetFastClock(v[0], v[1]);
+    break;
+
+  case EventFastClockTime:
+    delegate->receivedFastClockTime(v[0]);
+    break;
+
+  default:
+    break;
+  }
+}
+
+// Private methods
+
+DCCEXEvent *DCCEXEventRecorder::_record(DCCEXEventType type, int value0, int value1, int value2, int value3) {
+  DCCEXEvent *event = _queue->push(type);
+  if (event) {
+    event->values[0] = value0;
+    event->values[1] = value1;
+    event->values[2] = value2;
+    event->values[3] = value3;
+  }
+  return event;
+}
+
+Loco *DCCEXEventRecorder::_findLoco(int address, void *object) {
+  for (int slot = LocoStateTable::findAddress(address); slot >= 0;
+       slot = LocoStateTable::findAddress(address, slot + 1)) {
+    if (LocoStateTable::getLoco(slot) == object)
+      return LocoStateTable::getLoco(slot);
+  }
+  return nullptr;
+}
+
+// class DCCEXObserverList
+// Public methods
+
+DCCEXObserverList::DCCEXObserverList() {
+  for (int index = 0; index <= MAX_OBSERVERS; index++) {
+    _observers[index] = nullptr;
+    _masks[index] = 0;
+  }
+}
+
+void DCCEXObserverList::setDelegate(DCCEXProtocolDelegate *delegate) {
+  _observers[0] = delegate;
+  _masks[0] = (delegate) ? EVENT_MASK_ALL : 0;
+}
+
+bool DCCEXObserverList::add(DCCEXProtocolDelegate *observer, uint32_t eventMask) {
+  if (observer == nullptr)
+    return false;
+
+  int free = 0;
+  for (int index = 1; index <= MAX_OBSERVERS; index++) {
+    if (_observers[index] == observer) {
+      _masks[index] = eventMask;
+      return true;
+    }
+    if (_observers[index] == nullptr && free == 0)
+      free = index;
+  }
+  if (free == 0)
+    return false;
+
+  _observers[free] = observer;
+  _masks[free] = eventMask;
+  return true;
+}
+
+bool DCCEXObserverList::remove(DCCEXProtocolDelegate *observer) {
+  for (int index = 1; index <= MAX_OBSERVERS; index++) {
+    if (observer && _observers[index] == observer) {
+      _observers[index] = nullptr;
+      _masks[index] = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t DCCEXObserverList::getMask() {
+  uint32_t mask = 0;
+  for (int index = 0; index <= MAX_OBSERVERS; index++) {
+    mask |= _masks[index];
+  }
+  return mask;
+}
+
+void DCCEXObserverList::receivedServerVersion(int major, int minor, int patch) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventServerVersion, index))
+    observer->receivedServerVersion(major, minor, patch);
+}
+
+void DCCEXObserverList::receivedMessage(const char *message) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventMessage, index))
+    observer->receivedMessage(message);
+}
+
+void DCCEXObserverList::receivedRosterList() {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventRosterList, index))
+    observer->receivedRosterList();
+}
+
+void DCCEXObserverList::receivedTurnoutList() {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTurnoutList, index))
+    observer->receivedTurnoutList();
+}
+
+void DCCEXObserverList::receivedRouteList() {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventRouteList, index))
+    observer->receivedRouteList();
+}
+
+void DCCEXObserverList::receivedTurntableList() {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTurntableList, index))
+    observer->receivedTurntableList();
+}
+
+void DCCEXObserverList::receivedLocoUpdate(Loco *loco) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventLocoUpdate, index))
+    observer->receivedLocoUpdate(loco);
+}
+
+void DCCEXObserverList::receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventLocoBroadcast, index))
+    observer->receivedLocoBroadcast(address, speed, direction, functionMap);
+}
+
+void DCCEXObserverList::receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap,
+                                                       int mergedCount) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventLocoBroadcast, index))
+    observer->receivedCoalescedLocoBroadcast(address, speed, direction, functionMap, mergedCount);
+}
+
+void DCCEXObserverList::receivedTrackPower(TrackPower state) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTrackPower, index))
+    observer->receivedTrackPower(state);
+}
+
+void DCCEXObserverList::receivedTrackCurrentGauge(char track, int limit) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTrackCurrentGauge, index))
+    observer->receivedTrackCurrentGauge(track, limit);
+}
+
+void DCCEXObserverList::receivedTrackCurrent(char track, int current) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTrackCurrent, index))
+    observer->receivedTrackCurrent(track, current);
+}
+
+void DCCEXObserverList::receivedIndividualTrackPower(TrackPower state, int track) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventIndividualTrackPower, index))
+    observer->receivedIndividualTrackPower(state, track);
+}
+
+void DCCEXObserverList::receivedTrackType(char track, TrackManagerMode type, int address) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTrackType, index))
+    observer->receivedTrackType(track, type, address);
+}
+
+void DCCEXObserverList::receivedTurnoutAction(int turnoutId, bool thrown) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTurnoutAction, index))
+    observer->receivedTurnoutAction(turnoutId, thrown);
+}
+
+void DCCEXObserverList::receivedTurntableAction(int turntableId, int position, bool moving) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventTurntableAction, index))
+    observer->receivedTurntableAction(turntableId, position, moving);
+}
+
+void DCCEXObserverList::receivedReadLoco(int address) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventReadLoco, index))
+    observer->receivedReadLoco(address);
+}
+
+void DCCEXObserverList::receivedValidateCV(int cv, int value) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventValidateCV, index))
+    observer->receivedValidateCV(cv, value);
+}
+
+void DCCEXObserverList::receivedValidateCVBit(int cv, int bit, int value) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventValidateCVBit, index))
+    observer->receivedValidateCVBit(cv, bit, value);
+}
+
+void DCCEXObserverList::receivedWriteLoco(int address) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventWriteLoco, index))
+    observer->receivedWriteLoco(address);
+}
+
+void DCCEXObserverList::receivedWriteCV(int cv, int value) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventWriteCV, index))
+    observer->receivedWriteCV(cv, value);
+}
+
+void DCCEXObserverList::receivedScreenUpdate(int screen, int row, const char *message) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventScreenUpdate, index))
+    observer->receivedScreenUpdate(screen, row, message);
+}
+
+void DCCEXObserverList::receivedCSConsist(int leadLoco, CSConsist *csConsist) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventCSConsist, index))
+    observer->receivedCSConsist(leadLoco, csConsist);
+}
+
+void DCCEXObserverList::receivedSetFastClock(int minutes, int speedFactor) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventSetFastClock, index))
+    observer->receivedSetFastClock(minutes, speedFactor);
+}
+
+void DCCEXObserverList::receivedFastClockTime(int minutes) {
+  int index = 0;
+  while (DCCEXProtocolDelegate *observer = _next(EventFastClockTime, index))
+    observer->receivedFastClockTime(minutes);
+}
+
+// Private methods
+
+DCCEXProtocolDelegate *DCCEXObserverList::_next(DCCEXEventType type, int &index) {
+  uint32_t bit = 1UL << type;
+  while (index <= MAX_OBSERVERS) {
+    int current = index++;
+    if (_observers[current] && (_masks[current] & bit))
+      return _observers[current];
+  }
+  return nullptr;
+}
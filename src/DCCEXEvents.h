@@ -0,0 +1,188 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXEVENTS_H
+#define DCCEXEVENTS_H
+
+#include <Arduino.h>
+
+#ifndef DCCEX_EVENT_TEXT_LENGTH
+#define DCCEX_EVENT_TEXT_LENGTH 64 // Bytes held for an event's text, longer text is truncated
+#endif
+
+const int EVENT_VALUE_COUNT = 5; // Number of numeric values held by an event
+
+/// @brief Types of event, one for each DCCEXProtocolDelegate callback
+enum DCCEXEventType {
+  EventServerVersion,        // values: major, minor, patch
+  EventMessage,              // text: message
+  EventRosterList,           // No values
+  EventTurnoutList,          // No values
+  EventRouteList,            // No values
+  EventTurntableList,        // No values
+  EventLocoUpdate,           // values: address, object: Loco
+  EventLocoBroadcast,        // values: address, speed, direction, functionMap, mergedCount (0 if not coalesced)
+  EventTrackPower,           // values: state
+  EventTrackCurrentGauge,    // values: track, limit
+  EventTrackCurrent,         // values: track, current
+  EventIndividualTrackPower, // values: state, track
+  EventTrackType,            // values: track, type, address
+  EventTurnoutAction,        // values: turnoutId, thrown
+  EventTurntableAction,      // values: turntableId, position, moving
+  EventReadLoco,             // values: address
+  EventValidateCV,           // values: cv, value
+  EventValidateCVBit,        // values: cv, bit, value
+  EventWriteLoco,            // values: address
+  EventWriteCV,              // values: cv, value
+  EventScreenUpdate,         // values: screen, row, text: message
+  EventCSConsist,            // values: leadLoco
+  EventSetFastClock,         // values: minutes, speedFactor
+  EventFastClockTime,        // values: minutes
+};
+
+const int EVENT_TYPE_COUNT = 24;                                // Number of types in DCCEXEventType
+const uint32_t EVENT_MASK_ALL = (1UL << EVENT_TYPE_COUNT) - 1; // Mask subscribing to every event type
+const int MAX_OBSERVERS = 4;                                   // Observers that can be added besides the delegate
+
+/// @brief A single event with its own copy of every argument, so it stays valid after further commands are parsed
+struct DCCEXEvent {
+  DCCEXEventType type;                // Type of event
+  int values[EVENT_VALUE_COUNT];      // Numeric arguments, in the order the callback receives them
+  void *object;                       // Loco for EventLocoUpdate, otherwise nullptr
+  char text[DCCEX_EVENT_TEXT_LENGTH]; // Text argument, null terminated, empty if the event has none
+};
+
+/**
+ * @brief Fixed capacity ring of events recorded between parsing and the application handling them
+ * @details Storage is either allocated once on the heap via begin(capacity), or uses a caller-provided array via
+ * begin(buffer, capacity). When the ring is full, new events are dropped and counted so the oldest are kept in order.
+ */
+class DCCEXEventQueue {
+public:
+  /**
+   * @brief Construct a new, disabled DCCEXEventQueue object
+   */
+  DCCEXEventQueue();
+
+  /**
+   * @brief Allocate storage for the ring from the heap
+   * @details With DCCEX_STATIC_MEMORY defined this always fails, use begin(buffer, capacity) instead.
+   * @param capacity Number of events the ring can hold
+   * @return true If the storage was allocated
+   * @return false If allocation failed, the ring remains disabled
+   */
+  bool begin(int capacity);
+
+  /**
+   * @brief Use a caller-provided array for the ring, the array must outlive the ring
+   * @param buffer Pointer to the array of events
+   * @param capacity Number of events in the array
+   * @return true If the array is usable
+   * @return false If the array is nullptr or empty
+   */
+  bool begin(DCCEXEvent *buffer, int capacity);
+
+  /**
+   * @brief Release the storage (if heap allocated), discard any events, and disable the ring
+   */
+  void end();
+
+  /**
+   * @brief Check if the ring has storage to record events in
+   * @return true If enabled
+   * @return false If not
+   */
+  bool isEnabled();
+
+  /**
+   * @brief Get a new event at the back of the ring to fill in
+   * @details The event is cleared to the provided type with no values, object, or text.
+   * @param type Type of the event
+   * @return DCCEXEvent* Pointer to the event, or nullptr if disabled or full
+   */
+  DCCEXEvent *push(DCCEXEventType type);
+
+  /**
+   * @brief Remove the oldest event from the ring
+   * @param event Event to copy the oldest event into
+   * @return true If an event was removed
+   * @return false If the ring is empty
+   */
+  bool pop(DCCEXEvent &event);
+
+  /**
+   * @brief Discard every event in the ring
+   */
+  void clear();
+
+  /**
+   * @brief Get the number of events in the ring
+   * @return int Count of events
+   */
+  int getCount();
+
+  /**
+   * @brief Get the number of events the ring can hold
+   * @return int Capacity in events, 0 if disabled
+   */
+  int getCapacity();
+
+  /**
+   * @brief Get the most events held at once since the ring was enabled
+   * @return int Peak count of events
+   */
+  int getPeakCount();
+
+  /**
+   * @brief Get the number of events dropped because the ring was full
+   * @return unsigned long Count of dropped events
+   */
+  unsigned long getOverflowCount();
+
+  /**
+   * @brief Copy text into an event, truncating it to fit
+   * @param event Event to copy into
+   * @param text Text to copy, may be nullptr
+   */
+  static void setText(DCCEXEvent *event, const char *text);
+
+  /**
+   * @brief Destroy the DCCEXEventQueue object, releasing any heap allocated storage
+   */
+  ~DCCEXEventQueue();
+
+private:
+  DCCEXEvent *_events;
+  int _capacity;
+  int _head;
+  int _count;
+  int _peakCount;
+  unsigned long _overflowCount;
+  bool _ownsBuffer;
+};
+
+#endif // DCCEXEVENTS_H
@@ -54,18 +54,33 @@ byte DCCEXInbound::_opcode = 0;
 int32_t *DCCEXInbound::_parameterValues = nullptr;
 char *DCCEXInbound::_cmdBuffer = nullptr;
 
+#ifdef DCCEX_STATIC_MEMORY
+static int32_t staticParameterValues[DCCEX_STATIC_COMMAND_PARAMS];
+#endif
+
 // Public methods
 
 void DCCEXInbound::setup(int16_t maxParameterValues) {
+  long previousBytes = (_parameterValues) ? _maxParams * sizeof(int32_t) : 0;
+#ifdef DCCEX_STATIC_MEMORY
+  if (maxParameterValues > DCCEX_STATIC_COMMAND_PARAMS)
+    maxParameterValues = DCCEX_STATIC_COMMAND_PARAMS;
+  _parameterValues = staticParameterValues;
+#else
   _parameterValues = (int32_t *)realloc(_parameterValues, maxParameterValues * sizeof(int32_t));
+#endif
   _maxParams = maxParameterValues;
+  MemoryStats::addBufferBytes(MemoryParser, (long)(_maxParams * sizeof(int32_t)) - previousBytes);
   _parameterCount = 0;
   _opcode = 0;
 }
 
 void DCCEXInbound::cleanup() {
   if (_parameterValues) {
+    MemoryStats::addBufferBytes(MemoryParser, -(long)(_maxParams * sizeof(int32_t)));
+#ifndef DCCEX_STATIC_MEMORY
     free(_parameterValues);
+#endif
     _parameterValues = nullptr;
   }
 }
@@ -96,6 +111,7 @@ char *DCCEXInbound::getTextParameter(int16_t parameterNumber) {
   return _cmdBuffer + (_parameterValues[parameterNumber] & ~QUOTE_FLAG_AREA);
 }
 
+#ifndef DCCEX_STATIC_MEMORY
 char *DCCEXInbound::copyTextParameter(int16_t parameterNumber) {
   char *unsafe = getTextParameter(parameterNumber);
   if (!unsafe)
@@ -104,6 +120,7 @@ char *DCCEXInbound::copyTextParameter(int16_t parameterNumber) {
   strcpy(safe, unsafe);
   return safe;
 }
+#endif
 
 bool DCCEXInbound::parse(char *command) {
   _parameterCount = 0;
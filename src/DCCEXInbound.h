@@ -30,6 +30,8 @@
 #ifndef DCCEXINBOUND_H
 #define DCCEXINBOUND_H
 
+#include "DCCEXMemory.h"
+#include "DCCEXStaticPool.h"
 #include <Arduino.h>
 
 /* How to use this:
@@ -45,7 +47,8 @@
 class DCCEXInbound {
 public:
   /// @brief Setup parser once with enough space to handle the maximum number of
-  ///  parameters expected from the command station.
+  ///  parameters expected from the command station. With DCCEX_STATIC_MEMORY defined, this is limited to
+  ///  DCCEX_STATIC_COMMAND_PARAMS and no memory is allocated.
   /// @param maxParameterValues Maximum parameter values to accommodate
   static void setup(int16_t maxParameterValues);
 
@@ -79,10 +82,12 @@ public:
   /// @return Char array of text (use once and discard)
   static char *getTextParameter(int16_t parameterNumber);
 
+#ifndef DCCEX_STATIC_MEMORY
   /// @brief gets address of a heap copy of text type parameter.
   /// @param parameterNumber
   /// @return
   static char *copyTextParameter(int16_t parameterNumber);
+#endif
 
   /// @brief dump list of parameters obtained
   /// @param out Address of output e.g. &Serial
@@ -0,0 +1,111 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXLatency.h"
+
+// Largest time in ms each bucket holds, the last holds everything longer
+static const unsigned long bucketLimits[LATENCY_BUCKETS] = {5,   10,  15,  20,  30,   40,   50,   75,
+                                                            100, 150, 200, 300, 500, 1000, 2000, 0xFFFFFFFF};
+
+// class LatencyHistogram
+// Public methods
+
+LatencyHistogram::LatencyHistogram() { reset(); }
+
+void LatencyHistogram::add(unsigned long ms) {
+  int bucket = 0;
+  while (ms > bucketLimits[bucket]) {
+    bucket++;
+  }
+
+  if (_buckets[bucket] == 0xFFFF) {
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+      _buckets[i] /= 2;
+    }
+  }
+  _buckets[bucket]++;
+  _count++;
+  _total += ms;
+  if (ms > _max)
+    _max = ms;
+}
+
+void LatencyHistogram::reset() {
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    _buckets[i] = 0;
+  }
+  _count = 0;
+  _total = 0;
+  _max = 0;
+}
+
+unsigned long LatencyHistogram::getCount() { return _count; }
+
+unsigned long LatencyHistogram::getMax() { return _max; }
+
+unsigned long LatencyHistogram::getMean() {
+  if (_count == 0)
+    return 0;
+
+  return _total / _count;
+}
+
+unsigned long LatencyHistogram::getPercentile(int percent) {
+  unsigned long held = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    held += _buckets[i];
+  }
+  if (held == 0)
+    return 0;
+
+  // Rank of the percentile, rounded up so p100 is the largest time
+  unsigned long rank = (held * percent + 99) / 100;
+  if (rank == 0)
+    rank = 1;
+
+  unsigned long seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += _buckets[i];
+    if (seen >= rank)
+      return (bucketLimits[i] < _max) ? bucketLimits[i] : _max;
+  }
+  return _max;
+}
+
+uint16_t LatencyHistogram::getBucketCount(int bucket) {
+  if (bucket < 0 || bucket >= LATENCY_BUCKETS)
+    return 0;
+
+  return _buckets[bucket];
+}
+
+unsigned long LatencyHistogram::getBucketLimit(int bucket) {
+  if (bucket < 0 || bucket >= LATENCY_BUCKETS)
+    return 0;
+
+  return bucketLimits[bucket];
+}
@@ -0,0 +1,104 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXLATENCY_H
+#define DCCEXLATENCY_H
+
+#include <Arduino.h>
+
+const int LATENCY_BUCKETS = 16; // Number of buckets in a LatencyHistogram
+
+/**
+ * @brief Histogram of response times in milliseconds, with fixed buckets from 5ms to over 2 seconds
+ * @details Percentiles are estimated as the upper limit of the bucket holding them, but never more than the largest
+ * time recorded. If a bucket's count would overflow, every bucket is halved so the shape of the histogram is kept.
+ */
+class LatencyHistogram {
+public:
+  /**
+   * @brief Construct a new, empty LatencyHistogram object
+   */
+  LatencyHistogram();
+
+  /**
+   * @brief Record a response time
+   * @param ms Response time in milliseconds
+   */
+  void add(unsigned long ms);
+
+  /**
+   * @brief Discard all recorded times
+   */
+  void reset();
+
+  /**
+   * @brief Get the number of times recorded
+   * @return unsigned long Count of times
+   */
+  unsigned long getCount();
+
+  /**
+   * @brief Get the largest time recorded
+   * @return unsigned long Time in ms, 0 if none
+   */
+  unsigned long getMax();
+
+  /**
+   * @brief Get the mean of the times recorded
+   * @return unsigned long Time in ms, 0 if none
+   */
+  unsigned long getMean();
+
+  /**
+   * @brief Estimate a percentile of the times recorded
+   * @param percent Percentile to estimate, eg. 95 for p95
+   * @return unsigned long Time in ms, 0 if none
+   */
+  unsigned long getPercentile(int percent);
+
+  /**
+   * @brief Get the number of times in a bucket
+   * @param bucket Bucket number, 0 to LATENCY_BUCKETS - 1
+   * @return uint16_t Count, relative to the other buckets once halved
+   */
+  uint16_t getBucketCount(int bucket);
+
+  /**
+   * @brief Get the largest time a bucket holds
+   * @param bucket Bucket number, 0 to LATENCY_BUCKETS - 1
+   * @return unsigned long Time in ms, 0xFFFFFFFF for the last bucket
+   */
+  static unsigned long getBucketLimit(int bucket);
+
+private:
+  uint16_t _buckets[LATENCY_BUCKETS]; // Count of times in each bucket
+  unsigned long _count;               // Count of times recorded
+  unsigned long _total;               // Sum of the times recorded, for the mean
+  unsigned long _max;                 // Largest time recorded
+};
+
+#endif // DCCEXLATENCY_H
@@ -0,0 +1,210 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXLIST_H
+#define DCCEXLIST_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Singly linked list of objects that hold their own next pointer
+ * @details The list tracks its head, tail, and count so appending and counting are constant time, and supports
+ * range-based for loops. Removing the first object is constant time, removing any other object walks the list to find
+ * the previous object. The list never allocates or frees memory, objects are owned by the caller.
+ * @tparam T Type of object in the list
+ * @tparam Next Pointer to the member of T holding the pointer to the next object
+ */
+template <typename T, T *T::*Next> class IntrusiveList {
+public:
+  /**
+   * @brief Forward iterator over the objects in an IntrusiveList
+   */
+  class Iterator {
+  public:
+    /**
+     * @brief Construct a new Iterator object
+     * @param item Pointer to the object to start at, nullptr for the end of the list
+     */
+    Iterator(T *item) : _item(item) {}
+
+    /**
+     * @brief Get the current object
+     * @return T* Pointer to the current object
+     */
+    T *operator*() const { return _item; }
+
+    /**
+     * @brief Move to the next object
+     * @return Iterator& This iterator
+     */
+    Iterator &operator++() {
+      _item = _item->*Next;
+      return *this;
+    }
+
+    /**
+     * @brief Compare with another iterator
+     * @param other Iterator to compare with
+     * @return true If the iterators point to different objects
+     * @return false If they point to the same object
+     */
+    bool operator!=(const Iterator &other) const { return _item != other._item; }
+
+  private:
+    T *_item;
+  };
+
+  /**
+   * @brief Construct a new, empty IntrusiveList object
+   * @details This is constexpr so static lists are initialised before any global objects are constructed.
+   */
+  constexpr IntrusiveList() : _head(nullptr), _tail(nullptr), _count(0) {}
+
+  /**
+   * @brief Get the first object in the list
+   * @return T* Pointer to the first object, or nullptr if the list is empty
+   */
+  T *getFirst() const { return _head; }
+
+  /**
+   * @brief Get the last object in the list
+   * @return T* Pointer to the last object, or nullptr if the list is empty
+   */
+  T *getLast() const { return _tail; }
+
+  /**
+   * @brief Get the number of objects in the list
+   * @return int Object count
+   */
+  int getCount() const { return _count; }
+
+  /**
+   * @brief Add an object to the end of the list
+   * @param item Pointer to the object to add, it must not already be in a list
+   */
+  void append(T *item) {
+    if (item == nullptr)
+      return;
+    item->*Next = nullptr;
+    if (_tail) {
+      _tail->*Next = item;
+    } else {
+      _head = item;
+    }
+    _tail = item;
+    _count++;
+  }
+
+  /**
+   * @brief Remove an object from the list
+   * @param item Pointer to the object to remove
+   * @return true If the object was found and removed
+   * @return false If the object is not in the list
+   */
+  bool remove(T *item) {
+    if (item == nullptr || _head == nullptr)
+      return false;
+
+    T *previous = nullptr;
+    if (_head != item) {
+      previous = _head;
+      while (previous->*Next && previous->*Next != item) {
+        previous = previous->*Next;
+      }
+      if (previous->*Next != item)
+        return false;
+    }
+
+    if (previous) {
+      previous->*Next = item->*Next;
+    } else {
+      _head = item->*Next;
+    }
+    if (_tail == item)
+      _tail = previous;
+    item->*Next = nullptr;
+    _count--;
+    return true;
+  }
+
+  /**
+   * @brief Point an object in the list at a new next object, as the deprecated setNext() methods did
+   * @details Objects that followed the object are no longer in the list unless they follow the new next object, and
+   * are not freed. The tail and count are then worked out again by walking the list.
+   * @param item Pointer to the object to change
+   * @param next Pointer to the new next object, or nullptr to end the list at item
+   * @return true If the object was found and changed
+   * @return false If the object is not in the list, or next is the object or before it, which would make a loop
+   */
+  bool relink(T *item, T *next) {
+    T *current = _head;
+    while (current && current != item) {
+      if (current == next)
+        return false;
+      current = current->*Next;
+    }
+    if (current == nullptr || next == item)
+      return false;
+
+    item->*Next = next;
+    _tail = nullptr;
+    _count = 0;
+    for (current = _head; current; current = current->*Next) {
+      _tail = current;
+      _count++;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Forget all objects without freeing them
+   */
+  void reset() {
+    _head = nullptr;
+    _tail = nullptr;
+    _count = 0;
+  }
+
+  /**
+   * @brief Get an iterator at the first object
+   * @return Iterator Iterator for range-based for loops
+   */
+  Iterator begin() const { return Iterator(_head); }
+
+  /**
+   * @brief Get an iterator past the last object
+   * @return Iterator Iterator for range-based for loops
+   */
+  Iterator end() const { return Iterator(nullptr); }
+
+private:
+  T *_head;
+  T *_tail;
+  int _count;
+};
+
+#endif // DCCEXLIST_H
@@ -30,53 +30,262 @@
 #include "DCCEXLoco.h"
 #include <Arduino.h>
 
+// class LocoStateTable
+// Public methods
+
+// Bytes each slot needs across all arrays
+static const size_t LOCO_STATE_SLOT_SIZE =
+    sizeof(Loco *) + sizeof(int) + sizeof(uint32_t) + 2 * sizeof(int16_t) + sizeof(uint8_t) + FUNCTION_BITSET_BYTES;
+
+#ifdef DCCEX_STATIC_MEMORY
+alignas(Loco *) static uint8_t staticStateBlock[LOCO_STATE_SLOT_SIZE * DCCEX_STATIC_LOCOS];
+#endif
+
+uint8_t *LocoStateTable::_block = nullptr;
+int LocoStateTable::_count = 0;
+int LocoStateTable::_capacity = 0;
+Loco **LocoStateTable::_locos = nullptr;
+int *LocoStateTable::_addresses = nullptr;
+uint32_t *LocoStateTable::_lastUsed = nullptr;
+uint32_t LocoStateTable::_useCounter = 0;
+int16_t *LocoStateTable::_speeds = nullptr;
+int16_t *LocoStateTable::_userSpeeds = nullptr;
+uint8_t *LocoStateTable::_flags = nullptr;
+uint8_t *LocoStateTable::_functionStates = nullptr;
+
+int LocoStateTable::getCount() { return _count; }
+
+Loco *LocoStateTable::getLoco(int slot) {
+  if (slot < 0 || slot >= _count)
+    return nullptr;
+  return _locos[slot];
+}
+
+int LocoStateTable::findAddress(int address, int startSlot) {
+  for (int slot = (startSlot < 0) ? 0 : startSlot; slot < _count; slot++) {
+    if (_addresses[slot] == address)
+      return slot;
+  }
+  return -1;
+}
+
+int LocoStateTable::findUserChangePending(int startSlot) {
+  for (int slot = (startSlot < 0) ? 0 : startSlot; slot < _count; slot++) {
+    if (_flags[slot] & LOCO_STATE_USER_CHANGE_PENDING)
+      return slot;
+  }
+  return -1;
+}
+
+int LocoStateTable::getMovingCount() {
+  int moving = 0;
+  for (int slot = 0; slot < _count; slot++) {
+    if (_speeds[slot] > 0)
+      moving++;
+  }
+  return moving;
+}
+
+size_t LocoStateTable::getBytesAllocated() { return (_block) ? LOCO_STATE_SLOT_SIZE * _capacity : 0; }
+
+void LocoStateTable::markUsed(int slot) {
+  if (slot < 0 || slot >= _count)
+    return;
+  _lastUsed[slot] = ++_useCounter;
+}
+
+uint32_t LocoStateTable::getLastUsed(int slot) {
+  if (slot < 0 || slot >= _count)
+    return 0;
+  return _lastUsed[slot];
+}
+
+void LocoStateTable::setCached(int slot, bool cached) {
+  if (slot < 0 || slot >= _count)
+    return;
+  if (cached) {
+    _flags[slot] |= LOCO_STATE_CACHED;
+  } else {
+    _flags[slot] &= ~LOCO_STATE_CACHED;
+  }
+}
+
+bool LocoStateTable::isCached(int slot) {
+  if (slot < 0 || slot >= _count)
+    return false;
+  return _flags[slot] & LOCO_STATE_CACHED;
+}
+
+int LocoStateTable::getCachedCount() {
+  int cached = 0;
+  for (int slot = 0; slot < _count; slot++) {
+    if (_flags[slot] & LOCO_STATE_CACHED)
+      cached++;
+  }
+  return cached;
+}
+
+int LocoStateTable::findLeastRecentlyUsedCached() {
+  int oldest = -1;
+  for (int slot = 0; slot < _count; slot++) {
+    if ((_flags[slot] & (LOCO_STATE_CACHED | LOCO_STATE_USER_CHANGE_PENDING)) != LOCO_STATE_CACHED)
+      continue;
+    if (oldest < 0 || _lastUsed[slot] < _lastUsed[oldest])
+      oldest = slot;
+  }
+  return oldest;
+}
+
+// Private methods
+
+void LocoStateTable::_carve(uint8_t *block, int capacity) {
+  // Largest alignment first so every array is naturally aligned
+  _locos = (Loco **)block;
+  block += sizeof(Loco *) * capacity;
+  _addresses = (int *)block;
+  block += sizeof(int) * capacity;
+  _lastUsed = (uint32_t *)block;
+  block += sizeof(uint32_t) * capacity;
+  _speeds = (int16_t *)block;
+  block += sizeof(int16_t) * capacity;
+  _userSpeeds = (int16_t *)block;
+  block += sizeof(int16_t) * capacity;
+  _flags = block;
+  block += capacity;
+  _functionStates = block;
+}
+
+uint16_t LocoStateTable::_allocate(Loco *loco, int address) {
+  if (_count == _capacity) {
+    long previousBytes = getBytesAllocated();
+#ifdef DCCEX_STATIC_MEMORY
+    // The static block holds as many slots as the Loco pool has objects, so never needs to grow
+    if (_block)
+      return NO_LOCO_SLOT;
+    _block = staticStateBlock;
+    _capacity = DCCEX_STATIC_LOCOS;
+    _carve(_block, _capacity);
+#else
+    int capacity = (_capacity == 0) ? LOCO_STATE_MIN_CAPACITY : _capacity * 2;
+    if (capacity >= NO_LOCO_SLOT)
+      return NO_LOCO_SLOT;
+    uint8_t *block = new uint8_t[LOCO_STATE_SLOT_SIZE * capacity];
+    if (block == nullptr)
+      return NO_LOCO_SLOT;
+    Loco **oldLocos = _locos;
+    int *oldAddresses = _addresses;
+    uint32_t *oldLastUsed = _lastUsed;
+    int16_t *oldSpeeds = _speeds;
+    int16_t *oldUserSpeeds = _userSpeeds;
+    uint8_t *oldFlags = _flags;
+    uint8_t *oldFunctionStates = _functionStates;
+    _carve(block, capacity);
+    if (_count > 0) {
+      memcpy(_locos, oldLocos, sizeof(Loco *) * _count);
+      memcpy(_addresses, oldAddresses, sizeof(int) * _count);
+      memcpy(_lastUsed, oldLastUsed, sizeof(uint32_t) * _count);
+      memcpy(_speeds, oldSpeeds, sizeof(int16_t) * _count);
+      memcpy(_userSpeeds, oldUserSpeeds, sizeof(int16_t) * _count);
+      memcpy(_flags, oldFlags, _count);
+      memcpy(_functionStates, oldFunctionStates, FUNCTION_BITSET_BYTES * _count);
+    }
+    delete[] _block;
+    _block = block;
+    _capacity = capacity;
+#endif
+    MemoryStats::addBufferBytes(MemoryLocoState, (long)getBytesAllocated() - previousBytes);
+  }
+
+  uint16_t slot = _count++;
+  _locos[slot] = loco;
+  _addresses[slot] = address;
+  _lastUsed[slot] = ++_useCounter;
+  _speeds[slot] = 0;
+  _userSpeeds[slot] = 0;
+  _flags[slot] = LOCO_STATE_FORWARD | LOCO_STATE_USER_FORWARD;
+  memset(&_functionStates[slot * FUNCTION_BITSET_BYTES], 0, FUNCTION_BITSET_BYTES);
+  return slot;
+}
+
+void LocoStateTable::_release(uint16_t slot) {
+  if (slot >= _count)
+    return;
+
+  int last = _count - 1;
+  if (slot != last) {
+    _locos[slot] = _locos[last];
+    _addresses[slot] = _addresses[last];
+    _lastUsed[slot] = _lastUsed[last];
+    _speeds[slot] = _speeds[last];
+    _userSpeeds[slot] = _userSpeeds[last];
+    _flags[slot] = _flags[last];
+    memcpy(&_functionStates[slot * FUNCTION_BITSET_BYTES], &_functionStates[last * FUNCTION_BITSET_BYTES],
+           FUNCTION_BITSET_BYTES);
+    _locos[slot]->_slot = slot;
+  }
+  _count = last;
+
+  // Hand the block back once the last Loco has gone
+  if (_count == 0) {
+    MemoryStats::addBufferBytes(MemoryLocoState, -(long)getBytesAllocated());
+#ifndef DCCEX_STATIC_MEMORY
+    delete[] _block;
+#endif
+    _block = nullptr;
+    _capacity = 0;
+    _carve(nullptr, 0);
+  }
+}
+
 // class Loco
 // Public methods
 
-Loco *Loco::_first = nullptr;
-Loco *Loco::_firstLocalLoco = nullptr;
+Loco::List Loco::_roster;
+Loco::List Loco::_localLocos;
+ListArena *Loco::_arena = nullptr;
+bool Loco::_lazyFunctionLabels = false;
 
 Loco::Loco(int address, LocoSource source) : _address(address), _source(source) {
-  for (int i = 0; i < MAX_FUNCTIONS; i++) {
-    _functionNames[i] = nullptr;
-  }
-  _direction = Forward;
-  _speed = 0;
+  _functionLabels = nullptr;
+  _functionLabelsDecoded = true;
+  _functionCount = 0;
+  _slot = LocoStateTable::_allocate(this, address);
   _name = nullptr;
-  _functionStates = 0;
-  _momentaryFlags = 0;
+  memset(_momentaryFlags, 0, sizeof(_momentaryFlags));
   _next = nullptr;
-  _userSpeed = 0;
-  _userDirection = Forward;
-  _userChangePending = false;
+  _functionLabelBytes = 0;
   if (_source == LocoSource::LocoSourceRoster) {
-    _addToList(&_first, this);
+    _roster.append(this);
   } else {
-    _addToList(&_firstLocalLoco, this);
+    _localLocos.append(this);
   }
+  MemoryStats::addObject(_getMemorySubsystem(), sizeof(Loco));
 }
 
 int Loco::getAddress() { return _address; }
 
 void Loco::setName(const char *name) {
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(_getMemorySubsystem(), _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
-  int nameLength = strlen(name);
-  _name = new char[nameLength + 1];
-  strcpy(_name, name);
+  _name = ListArena::copyString(_arena, this, name);
+  MemoryStats::addName(_getMemorySubsystem(), _name, true);
 }
 
 const char *Loco::getName() { return _name; }
 
-void Loco::setSpeed(int speed) { _speed = speed; }
+void Loco::setSpeed(int speed) {
+  if (_slot != NO_LOCO_SLOT)
+    LocoStateTable::_speeds[_slot] = speed;
+}
 
-int Loco::getSpeed() { return _speed; }
+int Loco::getSpeed() { return (_slot != NO_LOCO_SLOT) ? LocoStateTable::_speeds[_slot] : 0; }
 
-void Loco::setDirection(Direction direction) { _direction = direction; }
+void Loco::setDirection(Direction direction) { _setStateFlag(LOCO_STATE_FORWARD, direction == Forward); }
 
-Direction Loco::getDirection() { return (Direction)_direction; }
+Direction Loco::getDirection() { return _getStateFlag(LOCO_STATE_FORWARD) ? Forward : Reverse; }
 
 LocoSource Loco::getSource() { return (LocoSource)_source; }
 
@@ -84,148 +293,215 @@ void Loco::setupFunctions(const char *functionNames) {
   if (functionNames == nullptr) {
     return;
   }
-  // Copy functionNames so we can clean up later
-  char *fNames = new char[strlen(functionNames) + 1];
-  if (fNames == nullptr) {
-    return; // Bail out if malloc failed
+
+  // Remove any existing labels first
+  _clearFunctionLabels();
+
+  // Size the offset table from the number of labels, each separated by /
+  int functionCount = 1;
+  for (const char *c = functionNames; *c && functionCount < MAX_FUNCTIONS; c++) {
+    if (*c == '/')
+      functionCount++;
   }
-  strcpy(fNames, functionNames); // Copy names
 
-  // Remove any existing names first
-  for (int nameIndex = 0; nameIndex < MAX_FUNCTIONS; nameIndex++) {
-    if (_functionNames[nameIndex] != nullptr) {
-      delete[] _functionNames[nameIndex];
-      _functionNames[nameIndex] = nullptr;
-    }
+  // Copy all labels into a single buffer stored alongside this Loco, behind the offset of each one
+  size_t offsetBytes = functionCount * sizeof(uint16_t);
+  _functionLabels = ListArena::copyString(_arena, this, functionNames, offsetBytes);
+  if (_functionLabels == nullptr) {
+    return; // Bail out if allocation failed
+  }
+  memset(_functionLabels, 0xFF, offsetBytes);
+  _functionCount = functionCount;
+  _functionLabelBytes = offsetBytes + strlen(functionNames) + 1;
+  MemoryStats::addLabelBytes(_getMemorySubsystem(), _functionLabelBytes);
+
+  // Labels are decoded now, or on first use if lazy function labels are enabled
+  _functionLabelsDecoded = false;
+  if (!_lazyFunctionLabels) {
+    _decodeFunctionLabels();
   }
+}
 
-  int fNameIndex = 0;                // Index for each function name
-  int fNamesLength = strlen(fNames); // Length of all names for sizing later
-  int fNameStartChar = 0;            // Position of the first char in the name
+bool Loco::isFunctionOn(int function) {
+  if (function < 0 || function >= MAX_FUNCTIONS || _slot == NO_LOCO_SLOT)
+    return false;
+  uint8_t *functionStates = &LocoStateTable::_functionStates[_slot * FUNCTION_BITSET_BYTES];
+  return functionStates[function >> 3] & (1 << (function & 7));
+}
 
-  // Iterate through the fNames char array to look for names
-  for (int charIndex = 0; charIndex <= fNamesLength; charIndex++) {
-    // End of name is either / or null terminator
-    // Start of name will be in char array index fNameStart
-    if (fNames[charIndex] == '/' || fNames[charIndex] == '\0') {
-      // Make sure we're at a sane index
-      if (fNameIndex < MAX_FUNCTIONS) {
-        bool momentary = false;
-        // If start is *, it's momentary, name starts at following index
-        if (fNames[fNameStartChar] == '*') {
-          momentary = true;
-          fNameStartChar++;
-        }
-        int nameLength = charIndex - fNameStartChar;           // Calculate length of name
-        _functionNames[fNameIndex] = new char[nameLength + 1]; // Allocate mem + null terminator
-        if (_functionNames[fNameIndex] != nullptr) {
-          // Copy the name to the array index and null terminate it
-          strncpy(_functionNames[fNameIndex], &fNames[fNameStartChar], nameLength);
-          _functionNames[fNameIndex][nameLength] = '\0';
-        }
-        // Set the momentary flag
-        if (momentary) {
-          _momentaryFlags |= 1 << fNameIndex;
-        } else {
-          _momentaryFlags &= ~(1 << fNameIndex);
-        }
-        // Move to the next index
-        fNameIndex++;
-      } else {
-        break;
-      }
-      fNameStartChar = charIndex + 1; // Calculate the start index of the next name
-    }
+void Loco::setFunctionState(int function, bool state) {
+  if (function < 0 || function >= MAX_FUNCTIONS || _slot == NO_LOCO_SLOT)
+    return;
+  uint8_t *functionStates = &LocoStateTable::_functionStates[_slot * FUNCTION_BITSET_BYTES];
+  if (state) {
+    functionStates[function >> 3] |= (1 << (function & 7));
+  } else {
+    functionStates[function >> 3] &= ~(1 << (function & 7));
   }
-  delete[] fNames; // Clean up fNames
 }
 
-bool Loco::isFunctionOn(int function) { return _functionStates & 1 << function; }
-
-void Loco::setFunctionStates(int functionStates) { _functionStates = functionStates; }
+void Loco::setFunctionStates(int functionStates) {
+  for (int function = 0; function < BROADCAST_FUNCTIONS && function < MAX_FUNCTIONS; function++) {
+    setFunctionState(function, (uint32_t)functionStates & (1UL << function));
+  }
+}
 
-int Loco::getFunctionStates() { return _functionStates; }
+int Loco::getFunctionStates() {
+  uint32_t functionStates = 0;
+  for (int function = 0; function < BROADCAST_FUNCTIONS && function < MAX_FUNCTIONS; function++) {
+    if (isFunctionOn(function))
+      functionStates |= (1UL << function);
+  }
+  return functionStates;
+}
 
-const char *Loco::getFunctionName(int function) { return _functionNames[function]; }
+const char *Loco::getFunctionName(int function) {
+  if (!_functionLabelsDecoded)
+    _decodeFunctionLabels();
+  if (function < 0 || function >= _functionCount || _getFunctionOffset(function) == NO_FUNCTION_LABEL)
+    return nullptr;
+  return _getFunctionLabelStart() + _getFunctionOffset(function);
+}
 
-bool Loco::isFunctionMomentary(int function) { return _momentaryFlags & 1 << function; }
+bool Loco::isFunctionMomentary(int function) {
+  if (!_functionLabelsDecoded)
+    _decodeFunctionLabels();
+  if (function < 0 || function >= MAX_FUNCTIONS)
+    return false;
+  return _momentaryFlags[function >> 3] & (1 << (function & 7));
+}
 
-Loco *Loco::getFirst() { return _first; }
+Loco *Loco::getFirst() { return _roster.getFirst(); }
 
-void Loco::setNext(Loco *loco) { _next = loco; }
+void Loco::setNext(Loco *loco) {
+  // Roster and local Locos are in separate lists
+  if (loco && loco->_source != _source)
+    return;
+  if (_source == LocoSource::LocoSourceRoster) {
+    _roster.relink(this, loco);
+  } else {
+    _localLocos.relink(this, loco);
+  }
+}
 
 Loco *Loco::getNext() { return _next; }
 
 Loco *Loco::getByAddress(int address) {
-  Loco *loco = _findAddressInList(&_first, address);
+  Loco *loco = _findAddressInList(_roster, address);
   if (loco != nullptr)
     return loco;
 
-  loco = _findAddressInList(&_firstLocalLoco, address);
+  loco = _findAddressInList(_localLocos, address);
   return loco;
 }
 
-void Loco::clearRoster() { _clearList(&_first); }
+void Loco::clearRoster() { _clearList(_roster); }
 
 void Loco::setUserSpeed(int speed) {
-  _userSpeed = speed;
-  if (_userSpeed != _speed)
-    _userChangePending = true;
+  if (_slot == NO_LOCO_SLOT)
+    return;
+  LocoStateTable::_userSpeeds[_slot] = speed;
+  if (speed != LocoStateTable::_speeds[_slot])
+    _setStateFlag(LOCO_STATE_USER_CHANGE_PENDING, true);
 }
 
-int Loco::getUserSpeed() { return _userSpeed; }
+int Loco::getUserSpeed() { return (_slot != NO_LOCO_SLOT) ? LocoStateTable::_userSpeeds[_slot] : 0; }
 
 void Loco::setUserDirection(Direction direction) {
-  _userDirection = direction;
-  if (_userDirection != _direction)
-    _userChangePending = true;
+  _setStateFlag(LOCO_STATE_USER_FORWARD, direction == Forward);
+  if (direction != getDirection())
+    _setStateFlag(LOCO_STATE_USER_CHANGE_PENDING, true);
 }
 
-Direction Loco::getUserDirection() { return _userDirection; }
+Direction Loco::getUserDirection() { return _getStateFlag(LOCO_STATE_USER_FORWARD) ? Forward : Reverse; }
+
+void Loco::resetUserChangePending() { _setStateFlag(LOCO_STATE_USER_CHANGE_PENDING, false); }
+
+bool Loco::getUserChangePending() { return _getStateFlag(LOCO_STATE_USER_CHANGE_PENDING); }
+
+int Loco::getStateSlot() { return (_slot != NO_LOCO_SLOT) ? _slot : -1; }
+
+Loco *Loco::getFirstLocalLoco() { return _localLocos.getFirst(); }
+
+void Loco::clearLocalLocos() { _clearList(_localLocos); }
+
+const Loco::List &Loco::getRosterList() { return _roster; }
+
+const Loco::List &Loco::getLocalLocoList() { return _localLocos; }
 
-void Loco::resetUserChangePending() { _userChangePending = false; }
+void Loco::setLazyFunctionLabels(bool lazy) { _lazyFunctionLabels = lazy; }
 
-bool Loco::getUserChangePending() { return _userChangePending; }
+bool Loco::getLazyFunctionLabels() { return _lazyFunctionLabels; }
 
-Loco *Loco::getFirstLocalLoco() { return _firstLocalLoco; }
+void Loco::setArena(ListArena *arena) { _arena = arena; }
 
-void Loco::clearLocalLocos() { _clearList(&_firstLocalLoco); }
+ListArena *Loco::getArena() { return _arena; }
+
+#ifdef DCCEX_STATIC_MEMORY
+static StaticPool<sizeof(Loco), DCCEX_STATIC_LOCOS> locoPool;
+
+void *Loco::operator new(size_t size) noexcept {
+  (void)size;
+  return locoPool.allocate();
+}
+
+void Loco::operator delete(void *ptr) { locoPool.release(ptr); }
+
+StaticPoolStats Loco::getPoolStats() { return locoPool.getStats(); }
+#else
+void *Loco::operator new(size_t size) noexcept { return ::operator new(size, std::nothrow); }
+
+void Loco::operator delete(void *ptr) { ListArena::release(_arena, ptr); }
+#endif
 
 Loco::~Loco() {
-  _removeFromList(&_first, this);
-  _removeFromList(&_firstLocalLoco, this);
+  if (_source == LocoSource::LocoSourceRoster) {
+    _roster.remove(this);
+  } else {
+    _localLocos.remove(this);
+  }
+
+  if (_slot != NO_LOCO_SLOT) {
+    LocoStateTable::_release(_slot);
+    _slot = NO_LOCO_SLOT;
+  }
 
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(_getMemorySubsystem(), _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
 
-  for (int i = 0; i < MAX_FUNCTIONS; i++) {
-    if (_functionNames[i]) {
-      delete[] _functionNames[i];
-      _functionNames[i] = nullptr;
-    }
-  }
+  _clearFunctionLabels();
 
   _next = nullptr;
+  MemoryStats::addObject(_getMemorySubsystem(), -(long)sizeof(Loco));
 }
 
 // Private methods
 
-void Loco::_addToList(Loco **listHead, Loco *loco) {
-  if (!*listHead) {
-    *listHead = loco;
+MemorySubsystem Loco::_getMemorySubsystem() {
+  return (_source == LocoSource::LocoSourceRoster) ? MemoryRoster : MemoryLocalLocos;
+}
+
+bool Loco::_getStateFlag(uint8_t flag) {
+  if (_slot == NO_LOCO_SLOT)
+    return (flag != LOCO_STATE_USER_CHANGE_PENDING);
+  return LocoStateTable::_flags[_slot] & flag;
+}
+
+void Loco::_setStateFlag(uint8_t flag, bool state) {
+  if (_slot == NO_LOCO_SLOT)
+    return;
+  if (state) {
+    LocoStateTable::_flags[_slot] |= flag;
   } else {
-    Loco *current = *listHead;
-    while (current->_next != nullptr) {
-      current = current->_next;
-    }
-    current->_next = loco;
+    LocoStateTable::_flags[_slot] &= ~flag;
   }
 }
 
-Loco *Loco::_findAddressInList(Loco **listHead, int address) {
-  for (Loco *loco = *listHead; loco; loco = loco->getNext()) {
+Loco *Loco::_findAddressInList(const List &list, int address) {
+  for (Loco *loco : list) {
     if (loco->getAddress() == address) {
       return loco;
     }
@@ -233,30 +509,66 @@ Loco *Loco::_findAddressInList(Loco **listHead, int address) {
   return nullptr;
 }
 
-void Loco::_removeFromList(Loco **listHead, Loco *loco) {
-  if (!listHead || !*listHead || !loco) {
+void Loco::_clearFunctionLabels() {
+  if (_functionLabels) {
+    MemoryStats::addLabelBytes(_getMemorySubsystem(), -(long)_functionLabelBytes);
+    ListArena::freeString(_arena, _functionLabels);
+    _functionLabels = nullptr;
+    _functionLabelBytes = 0;
+  }
+  _functionCount = 0;
+  memset(_momentaryFlags, 0, sizeof(_momentaryFlags));
+  _functionLabelsDecoded = true;
+}
+
+char *Loco::_getFunctionLabelStart() { return _functionLabels + _functionCount * sizeof(uint16_t); }
+
+uint16_t Loco::_getFunctionOffset(int function) {
+  // Copied rather than cast as labels leave the offsets unaligned in arena and static pool buffers
+  uint16_t offset;
+  memcpy(&offset, _functionLabels + function * sizeof(uint16_t), sizeof(offset));
+  return offset;
+}
+
+void Loco::_setFunctionOffset(int function, uint16_t offset) {
+  memcpy(_functionLabels + function * sizeof(uint16_t), &offset, sizeof(offset));
+}
+
+void Loco::_decodeFunctionLabels() {
+  _functionLabelsDecoded = true;
+  if (_functionLabels == nullptr) {
     return;
   }
 
-  if (*listHead == loco) {
-    *listHead = loco->getNext();
-  } else {
-    Loco *currentLoco = *listHead;
-    while (currentLoco && currentLoco->getNext() != loco) {
-      currentLoco = currentLoco->getNext();
-    }
-    if (currentLoco) {
-      currentLoco->setNext(loco->getNext());
+  char *labels = _getFunctionLabelStart();
+  int fNameIndex = 0;     // Index for each function name
+  int fNameStartChar = 0; // Position of the first char in the name
+
+  // Iterate through the buffer to look for names, replacing each separator with a null terminator
+  for (int charIndex = 0; fNameIndex < _functionCount && charIndex < NO_FUNCTION_LABEL; charIndex++) {
+    char c = labels[charIndex];
+    // End of name is either / or null terminator
+    if (c == '/' || c == '\0') {
+      // If start is *, it's momentary, name starts at following index
+      if (labels[fNameStartChar] == '*') {
+        _momentaryFlags[fNameIndex >> 3] |= (1 << (fNameIndex & 7));
+        fNameStartChar++;
+      }
+      labels[charIndex] = '\0';
+      _setFunctionOffset(fNameIndex, fNameStartChar);
+      // Move to the next index
+      fNameIndex++;
+      fNameStartChar = charIndex + 1; // Calculate the start index of the next name
+      if (c == '\0')
+        break;
     }
   }
 }
 
-void Loco::_clearList(Loco **listHead) {
-  if (!listHead)
-    return;
-
-  while (*listHead != nullptr) {
-    delete *listHead;
+void Loco::_clearList(List &list) {
+  // Each Loco removes itself from the head of the list when deleted
+  while (list.getFirst() != nullptr) {
+    delete list.getFirst();
   }
 }
 
@@ -341,6 +653,8 @@ void Consist::addLoco(int address, Facing facing) {
     }
   }
   Loco *loco = new Loco(address, LocoSourceEntry);
+  if (loco == nullptr)
+    return;
   ConsistLoco *conLoco = new ConsistLoco(loco, facing);
   _addLocoToConsist(conLoco);
 }
@@ -30,11 +30,28 @@
 #ifndef DCCEXLOCO_H
 #define DCCEXLOCO_H
 
+#include "DCCEXArena.h"
+#include "DCCEXList.h"
+#include "DCCEXMemory.h"
 #include <Arduino.h>
 
-static const int MAX_FUNCTIONS = 32;
-const int MAX_OBJECT_NAME_LENGTH = 30;      // including Loco name, Turnout/Point names, Route names, etc. names
-#define MAX_SINGLE_COMMAND_PARAM_LENGTH 500 // Unfortunately includes the function list for an individual loco
+#ifndef DCCEX_MAX_FUNCTIONS
+#define DCCEX_MAX_FUNCTIONS 69 // F0 to F68, override as a build flag only to reduce memory use
+#endif
+
+static const int MAX_FUNCTIONS = DCCEX_MAX_FUNCTIONS;
+static_assert(MAX_FUNCTIONS <= 255, "DCCEX_MAX_FUNCTIONS must fit the Loco function label count");
+const int FUNCTION_BITSET_BYTES = (MAX_FUNCTIONS + 7) / 8; // Bytes to hold one bit per function
+const int BROADCAST_FUNCTIONS = 29;                        // Loco broadcasts report the states of F0 to F28
+const int MAX_OBJECT_NAME_LENGTH = 30;                     // including Loco name, Turnout/Point names, etc. names
+#define MAX_SINGLE_COMMAND_PARAM_LENGTH 500                // Unfortunately includes the function list for a loco
+const uint16_t NO_FUNCTION_LABEL = 0xFFFF;                 // Function label offset used when a function has no label
+const uint16_t NO_LOCO_SLOT = 0xFFFF;                      // Slot used when a Loco has no entry in the state table
+const int LOCO_STATE_MIN_CAPACITY = 8;                     // Initial number of slots in the Loco state table
+const uint8_t LOCO_STATE_FORWARD = 0x01;                   // State flag for authoritative direction Forward
+const uint8_t LOCO_STATE_USER_FORWARD = 0x02;              // State flag for user requested direction Forward
+const uint8_t LOCO_STATE_USER_CHANGE_PENDING = 0x04;       // State flag for a pending user speed/direction change
+const uint8_t LOCO_STATE_CACHED = 0x08;                    // State flag for a Loco created and owned by the library
 
 enum Direction {
   Reverse = 0,
@@ -51,6 +68,134 @@ enum Facing {
   FacingReversed = 1,
 };
 
+class Loco;
+
+/**
+ * @brief Structure-of-arrays table holding the live state of every Loco object
+ * @details Each Loco owns one dense slot in this table, holding its address, speed, direction, user requested changes,
+ * and function states in separate contiguous arrays. Scanning every Loco for pending changes, movement, or a broadcast
+ * address therefore only touches these arrays rather than every Loco object. Slots are kept dense by moving the last
+ * slot into any slot that is released, so a slot number is only valid until the next Loco is deleted.
+ */
+class LocoStateTable {
+public:
+  /**
+   * @brief Get the number of slots in use, valid slots are 0 to getCount() - 1
+   * @return int Slot count
+   */
+  static int getCount();
+
+  /**
+   * @brief Get the Loco that owns a slot
+   * @param slot Slot number
+   * @return Loco* Pointer to the Loco, or nullptr if the slot is invalid
+   */
+  static Loco *getLoco(int slot);
+
+  /**
+   * @brief Find the next slot with the provided DCC address
+   * @param address DCC address to look for
+   * @param startSlot Slot to start looking from
+   * @return int Slot number, or -1 if not found
+   */
+  static int findAddress(int address, int startSlot = 0);
+
+  /**
+   * @brief Find the next slot with a user speed or direction change pending
+   * @param startSlot Slot to start looking from
+   * @return int Slot number, or -1 if none are pending
+   */
+  static int findUserChangePending(int startSlot = 0);
+
+  /**
+   * @brief Get the number of Locos with a speed greater than 0
+   * @return int Count of moving Locos
+   */
+  static int getMovingCount();
+
+  /**
+   * @brief Get the number of bytes allocated to the table
+   * @return size_t Bytes allocated
+   */
+  static size_t getBytesAllocated();
+
+  /**
+   * @brief Record that a slot's Loco has just been used, for least recently used eviction
+   * @param slot Slot number
+   */
+  static void markUsed(int slot);
+
+  /**
+   * @brief Get when a slot's Loco was last used
+   * @param slot Slot number
+   * @return uint32_t Use sequence number, higher is more recent, 0 if the slot is invalid
+   */
+  static uint32_t getLastUsed(int slot);
+
+  /**
+   * @brief Set whether a slot's Loco was created by the library and may be evicted from the local Loco cache
+   * @param slot Slot number
+   * @param cached True if cached
+   */
+  static void setCached(int slot, bool cached);
+
+  /**
+   * @brief Check if a slot's Loco was created by the library and may be evicted from the local Loco cache
+   * @param slot Slot number
+   * @return true If cached
+   * @return false If not cached, or the slot is invalid
+   */
+  static bool isCached(int slot);
+
+  /**
+   * @brief Get the number of cached Locos
+   * @return int Count of cached Locos
+   */
+  static int getCachedCount();
+
+  /**
+   * @brief Find the least recently used cached Loco that has no user change pending
+   * @return int Slot number, or -1 if there is none
+   */
+  static int findLeastRecentlyUsedCached();
+
+private:
+  static uint8_t *_block;          // Single allocation holding all arrays
+  static int _count;               // Number of slots in use
+  static int _capacity;            // Number of slots allocated
+  static Loco **_locos;            // Loco owning each slot
+  static int *_addresses;          // DCC address
+  static uint32_t *_lastUsed;      // Use sequence number when last used
+  static uint32_t _useCounter;     // Last use sequence number handed out
+  static int16_t *_speeds;         // Authoritative speed
+  static int16_t *_userSpeeds;     // Requested user speed
+  static uint8_t *_flags;          // Direction, user direction, user change pending, and cached flags
+  static uint8_t *_functionStates; // FUNCTION_BITSET_BYTES per slot, one bit per function
+
+  /**
+   * @brief Point each array at its part of a block
+   * @param block Block to carve the arrays from
+   * @param capacity Number of slots the block holds
+   */
+  static void _carve(uint8_t *block, int capacity);
+
+  /**
+   * @brief Allocate a slot for a new Loco, growing the table if required
+   * @param loco Pointer to the Loco
+   * @param address DCC address of the Loco
+   * @return uint16_t Slot number, or NO_LOCO_SLOT if allocation failed
+   */
+  static uint16_t _allocate(Loco *loco, int address);
+
+  /**
+   * @brief Release a slot, moving the last slot into its place to keep the table dense
+   * @param slot Slot number to release
+   */
+  static void _release(uint16_t slot);
+
+  friend class Loco;
+};
+
 /// @brief Class for a Loco object representing a DCC addressed locomotive
 class Loco {
 public:
@@ -92,20 +237,28 @@ public:
   LocoSource getSource();
 
   /// @brief Setup functions for the loco
+  /// @details If lazy function labels are enabled, the labels are only decoded on the first call to
+  /// getFunctionName() or isFunctionMomentary().
   /// @param functionNames Char array of function names
   void setupFunctions(const char *functionNames);
 
   /// @brief Test if function is on
-  /// @param function Number of the function to test
-  /// @return true|false
+  /// @param function Number of the function to test (0 to MAX_FUNCTIONS - 1)
+  /// @return true|false, false if the function is out of range
   bool isFunctionOn(int function);
 
-  /// @brief Set function states
-  /// @param functionStates Integer representing all function states
+  /// @brief Set the state of a single function, no other function states are changed
+  /// @param function Number of the function to set (0 to MAX_FUNCTIONS - 1)
+  /// @param state true for on, false for off
+  void setFunctionState(int function, bool state);
+
+  /// @brief Set function states for the functions reported in Loco broadcasts (F0 to F28)
+  /// @details States of functions from F29 upwards are not changed.
+  /// @param functionStates Integer representing the function states, bit 0 = F0
   void setFunctionStates(int functionStates);
 
-  /// @brief Get function states
-  /// @return Integer representing current function states
+  /// @brief Get function states for the functions reported in Loco broadcasts (F0 to F28)
+  /// @return Integer representing current function states, bit 0 = F0
   int getFunctionStates();
 
   /// @brief Get the name/label for a function
@@ -122,8 +275,12 @@ public:
   /// @return Pointer to the first Loco object
   static Loco *getFirst();
 
-  /// @brief Set the next loco in the roster list
-  /// @param loco Pointer to the next Loco object
+  /**
+   * @brief DEPRECATED Set the next loco in the roster list, this will be REMOVED in 2.0.0 as the library keeps the list
+   * @details Locos that followed this one are dropped from the list but not deleted. Ignored if it
+   * would make a loop, or for a Loco in the other of the roster and local Loco lists.
+   * @param loco Pointer to the next Loco object, or nullptr to end the list here
+   */
   void setNext(Loco *loco);
 
   /// @brief Get next Loco object
@@ -174,6 +331,12 @@ public:
    */
   bool getUserChangePending();
 
+  /**
+   * @brief Get the slot holding this Loco's live state in the LocoStateTable
+   * @return int Slot number, or -1 if no slot could be allocated
+   */
+  int getStateSlot();
+
   /**
    * @brief Get the First Local Loco object
    * @return Loco* Pointer to the first loco with LocoSourceEntry type
@@ -185,50 +348,158 @@ public:
    */
   static void clearLocalLocos();
 
+  /**
+   * @brief Enable or disable lazy decoding of function labels for all Locos
+   * @details When enabled, setupFunctions() only stores the raw label string, and the labels and momentary flags are
+   * decoded the first time getFunctionName() or isFunctionMomentary() is called for that Loco.
+   * @param lazy True to decode labels on first use (default false)
+   */
+  static void setLazyFunctionLabels(bool lazy);
+
+  /**
+   * @brief Check if lazy decoding of function labels is enabled
+   * @return true If labels are decoded on first use
+   * @return false If labels are decoded by setupFunctions()
+   */
+  static bool getLazyFunctionLabels();
+
+  /**
+   * @brief Set the arena roster Locos and their names are allocated from
+   * @param arena Pointer to the ListArena, or nullptr to use the heap
+   */
+  static void setArena(ListArena *arena);
+
+  /**
+   * @brief Get the arena roster Locos and their names are allocated from
+   * @return ListArena* Pointer to the ListArena, or nullptr if not in use
+   */
+  static ListArena *getArena();
+
+  /**
+   * @brief Allocate a Loco on the heap, use ListArena::create() to allocate from an arena
+   * @details With DCCEX_STATIC_MEMORY defined, this allocates from a static pool of DCCEX_STATIC_LOCOS objects instead.
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Free a Loco, arena allocated Locos are reclaimed when the arena is reset
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Get the usage of the static pool Loco objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+
   /// @brief Destructor for the Loco object
   ~Loco();
 
 private:
-  int _address;                        // DCC address
-  char *_name;                         // Name
-  int _speed;                          // Authoritative speed
-  Direction _direction;                // Authoritative direction
-  LocoSource _source;                  // Roster or manually entered Loco
-  char *_functionNames[MAX_FUNCTIONS]; // Static array of function names
-  int32_t _functionStates;             // State of each function
-  int32_t _momentaryFlags;             // Flag if functions are momentary
-  static Loco *_first;                 // Pointer to the first Loco object in the roster
-  Loco *_next;                         // Pointer to the next Loco in the roster
-  int _userSpeed;                      // Track user speed request
-  Direction _userDirection;            // Track user direction request
-  bool _userChangePending;             // Flag if user has speed/direction pending
-  static Loco *_firstLocalLoco;        // Pointer to the first local loco object
+  int _address;                                   // DCC address
+  char *_name;                                    // Name
+  uint16_t _slot;                                 // Slot holding live state in the LocoStateTable
+  LocoSource _source;                             // Roster or manually entered Loco
+  char *_functionLabels;                          // Offset of each label, then all labels each null terminated
+  uint16_t _functionLabelBytes;                   // Bytes allocated to _functionLabels
+  uint8_t _functionCount;                         // Number of labels, and offsets in front of them
+  bool _functionLabelsDecoded;                    // False if _functionLabels still holds the raw label string
+  static bool _lazyFunctionLabels;                // Flag to defer decoding labels until first use
+  uint8_t _momentaryFlags[FUNCTION_BITSET_BYTES]; // Flag if functions are momentary, one bit per function
+  Loco *_next;                                    // Pointer to the next Loco in the roster or local list
+  static ListArena *_arena;                       // Optional arena for roster Locos and their names
+
+  friend class LocoStateTable;
+
+public:
+  /// @brief List of Loco objects, linked by their next pointer
+  typedef IntrusiveList<Loco, &Loco::_next> List;
 
   /**
-   * @brief Add the loco to a list
-   * @param listHead Pointer to the list entry point to add it to
-   * @param loco Pointer to the Loco to add
+   * @brief Get the list of roster Locos, which can be used in range-based for loops
+   * @return const List& Reference to the roster list
    */
-  static void _addToList(Loco **listHead, Loco *loco);
+  static const List &getRosterList();
+
+  /**
+   * @brief Get the list of local Locos, which can be used in range-based for loops
+   * @return const List& Reference to the local Loco list
+   */
+  static const List &getLocalLocoList();
+
+private:
+  static List _roster;     // Loco objects with LocoSourceRoster
+  static List _localLocos; // Loco objects with LocoSourceEntry
 
   /**
    * @brief Helper method to find the Loco associated with the specified address in a list
-   * @param listHead Pointer to the list entry point to look for the address
+   * @param list List to look for the address in
    * @param address DCC address to look for
    * @return Loco*
    */
-  static Loco *_findAddressInList(Loco **listHead, int address);
-
-  /// @brief Method to remove this loco from the roster list
-  /// @param listHead Pointer to the list entry point to remove it from
-  /// @param loco Pointer to the Loco to remove
-  static void _removeFromList(Loco **listHead, Loco *loco);
+  static Loco *_findAddressInList(const List &list, int address);
 
   /**
    * @brief Helper method to clear all locos from the provided list
-   * @param listHead Pointer to the first loco in the list
+   * @param list List to clear
+   */
+  static void _clearList(List &list);
+
+  /**
+   * @brief Free the function label buffer and reset all label offsets
+   */
+  void _clearFunctionLabels();
+
+  /**
+   * @brief Get the labels in the function label buffer, which follow the offset of each one
+   * @return char* Pointer to the first label
+   */
+  char *_getFunctionLabelStart();
+
+  /**
+   * @brief Get the offset of a label from the start of the labels
+   * @param function Function number, must be less than _functionCount
+   * @return uint16_t Offset of the label, or NO_FUNCTION_LABEL if not yet decoded
+   */
+  uint16_t _getFunctionOffset(int function);
+
+  /**
+   * @brief Set the offset of a label from the start of the labels
+   * @param function Function number, must be less than _functionCount
+   * @param offset Offset of the label
+   */
+  void _setFunctionOffset(int function, uint16_t offset);
+
+  /**
+   * @brief Split the raw label string into null terminated labels, setting offsets and momentary flags
+   */
+  void _decodeFunctionLabels();
+
+  /**
+   * @brief Get the subsystem this Loco's memory is reported against
+   * @return MemorySubsystem MemoryRoster or MemoryLocalLocos
+   */
+  MemorySubsystem _getMemorySubsystem();
+
+  /**
+   * @brief Read one of the LOCO_STATE_ flags from this Loco's slot
+   * @param flag Flag to read
+   * @return true If set
+   * @return false If not set
+   */
+  bool _getStateFlag(uint8_t flag);
+
+  /**
+   * @brief Set or clear one of the LOCO_STATE_ flags in this Loco's slot
+   * @param flag Flag to change
+   * @param state True to set, false to clear
    */
-  static void _clearList(Loco **listHead);
+  void _setStateFlag(uint8_t flag, bool state);
 
   friend class Consist;
 };
@@ -0,0 +1,119 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "DCCEXMemory.h"
+
+// class MemoryStats
+// Public methods
+
+MemoryUsage MemoryStats::_usage[MEMORY_SUBSYSTEM_COUNT];
+MemoryUsage MemoryStats::_peak[MEMORY_SUBSYSTEM_COUNT];
+size_t MemoryStats::_totalBytes = 0;
+size_t MemoryStats::_peakTotalBytes = 0;
+
+void MemoryStats::addObject(MemorySubsystem subsystem, long bytes) {
+  if (subsystem < 0 || subsystem >= MEMORY_SUBSYSTEM_COUNT)
+    return;
+  _usage[subsystem].objectCount += (bytes < 0) ? -1 : 1;
+  _usage[subsystem].objectBytes += bytes;
+  _update(subsystem, bytes);
+}
+
+void MemoryStats::addName(MemorySubsystem subsystem, const char *name, bool added) {
+  if (subsystem < 0 || subsystem >= MEMORY_SUBSYSTEM_COUNT || name == nullptr)
+    return;
+  long bytes = strlen(name) + 1;
+  if (!added)
+    bytes = -bytes;
+  _usage[subsystem].nameBytes += bytes;
+  _update(subsystem, bytes);
+}
+
+void MemoryStats::addLabelBytes(MemorySubsystem subsystem, long bytes) {
+  if (subsystem < 0 || subsystem >= MEMORY_SUBSYSTEM_COUNT)
+    return;
+  _usage[subsystem].labelBytes += bytes;
+  _update(subsystem, bytes);
+}
+
+void MemoryStats::addBufferBytes(MemorySubsystem subsystem, long bytes) {
+  if (subsystem < 0 || subsystem >= MEMORY_SUBSYSTEM_COUNT)
+    return;
+  _usage[subsystem].bufferBytes += bytes;
+  _update(subsystem, bytes);
+}
+
+MemoryUsage MemoryStats::getUsage(MemorySubsystem subsystem) {
+  if (subsystem < 0 || subsystem >= MEMORY_SUBSYSTEM_COUNT) {
+    MemoryUsage usage = {0, 0, 0, 0, 0, 0};
+    return usage;
+  }
+  return _usage[subsystem];
+}
+
+MemoryUsage MemoryStats::getPeakUsage(MemorySubsystem subsystem) {
+  if (subsystem < 0 || subsystem >= MEMORY_SUBSYSTEM_COUNT) {
+    MemoryUsage usage = {0, 0, 0, 0, 0, 0};
+    return usage;
+  }
+  return _peak[subsystem];
+}
+
+size_t MemoryStats::getTotalBytes() { return _totalBytes; }
+
+size_t MemoryStats::getPeakTotalBytes() { return _peakTotalBytes; }
+
+void MemoryStats::resetPeaks() {
+  for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+    _peak[subsystem] = _usage[subsystem];
+  }
+  _peakTotalBytes = _totalBytes;
+}
+
+// Private methods
+
+void MemoryStats::_update(MemorySubsystem subsystem, long bytes) {
+  MemoryUsage &usage = _usage[subsystem];
+  MemoryUsage &peak = _peak[subsystem];
+  usage.totalBytes += bytes;
+  _totalBytes += bytes;
+
+  if (usage.objectCount > peak.objectCount)
+    peak.objectCount = usage.objectCount;
+  if (usage.objectBytes > peak.objectBytes)
+    peak.objectBytes = usage.objectBytes;
+  if (usage.nameBytes > peak.nameBytes)
+    peak.nameBytes = usage.nameBytes;
+  if (usage.labelBytes > peak.labelBytes)
+    peak.labelBytes = usage.labelBytes;
+  if (usage.bufferBytes > peak.bufferBytes)
+    peak.bufferBytes = usage.bufferBytes;
+  if (usage.totalBytes > peak.totalBytes)
+    peak.totalBytes = usage.totalBytes;
+  if (_totalBytes > _peakTotalBytes)
+    _peakTotalBytes = _totalBytes;
+}
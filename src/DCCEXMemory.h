@@ -0,0 +1,143 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXMEMORY_H
+#define DCCEXMEMORY_H
+
+#include <Arduino.h>
+
+/// @brief Subsystems memory usage is reported for
+enum MemorySubsystem {
+  MemoryRoster,           // Roster Loco objects, names, and function labels
+  MemoryLocalLocos,       // Local Loco objects, names, and function labels
+  MemoryLocoState,        // Live Loco state table
+  MemoryTurnouts,         // Turnout objects and names
+  MemoryRoutes,           // Route objects and names
+  MemoryTurntables,       // Turntable objects and names
+  MemoryTurntableIndexes, // TurntableIndex objects, names, and unused reserved index blocks
+  MemoryCSConsists,       // CSConsist and CSConsistMember objects, and the member index
+  MemoryParser,           // Inbound command buffers and parsed parameters
+  MemoryOutbound,         // Outbound command buffer
+  MemoryEvents,           // Event queue
+  MemoryTelemetry,        // Track current history
+};
+
+const int MEMORY_SUBSYSTEM_COUNT = 12; // Number of subsystems in MemorySubsystem
+
+/// @brief Bytes and objects used by a single subsystem
+struct MemoryUsage {
+  int objectCount;    // Number of objects
+  size_t objectBytes; // Bytes used by the objects themselves
+  size_t nameBytes;   // Bytes used by names, including terminators
+  size_t labelBytes;  // Bytes used by function labels, including terminators
+  size_t bufferBytes; // Bytes used by buffers and tables
+  size_t totalBytes;  // Sum of all bytes used
+};
+
+/**
+ * @brief Live memory accounting for the object lists
+ * @details Objects add and remove their own bytes as they are created, named, and destroyed, so usage is always
+ * current without walking any list. Peaks hold the largest value each field has reached since the last call to
+ * resetPeaks(), so a peak's fields may come from different moments.
+ */
+class MemoryStats {
+public:
+  /**
+   * @brief Record an object being created or destroyed
+   * @param subsystem Subsystem the object belongs to
+   * @param bytes Size of the object, positive when created and negative when destroyed
+   */
+  static void addObject(MemorySubsystem subsystem, long bytes);
+
+  /**
+   * @brief Record name bytes being allocated or freed
+   * @param subsystem Subsystem the name belongs to
+   * @param name Name being allocated (added) or about to be freed (removed), nullptr is ignored
+   * @param added True if allocated, false if being freed
+   */
+  static void addName(MemorySubsystem subsystem, const char *name, bool added);
+
+  /**
+   * @brief Record function label bytes being allocated or freed
+   * @param subsystem Subsystem the labels belong to
+   * @param bytes Number of bytes, positive when allocated and negative when freed
+   */
+  static void addLabelBytes(MemorySubsystem subsystem, long bytes);
+
+  /**
+   * @brief Record buffer or table bytes being allocated or freed
+   * @param subsystem Subsystem the buffer belongs to
+   * @param bytes Number of bytes, positive when allocated and negative when freed
+   */
+  static void addBufferBytes(MemorySubsystem subsystem, long bytes);
+
+  /**
+   * @brief Get the current usage of a subsystem
+   * @param subsystem Subsystem to check
+   * @return MemoryUsage Current usage, all zero if the subsystem is invalid
+   */
+  static MemoryUsage getUsage(MemorySubsystem subsystem);
+
+  /**
+   * @brief Get the peak usage of a subsystem since the last call to resetPeaks()
+   * @param subsystem Subsystem to check
+   * @return MemoryUsage Peak usage, all zero if the subsystem is invalid
+   */
+  static MemoryUsage getPeakUsage(MemorySubsystem subsystem);
+
+  /**
+   * @brief Get the total bytes currently used across all subsystems
+   * @return size_t Total bytes
+   */
+  static size_t getTotalBytes();
+
+  /**
+   * @brief Get the peak total bytes used across all subsystems since the last call to resetPeaks()
+   * @return size_t Peak total bytes
+   */
+  static size_t getPeakTotalBytes();
+
+  /**
+   * @brief Reset every peak to the current usage
+   */
+  static void resetPeaks();
+
+private:
+  static MemoryUsage _usage[MEMORY_SUBSYSTEM_COUNT];
+  static MemoryUsage _peak[MEMORY_SUBSYSTEM_COUNT];
+  static size_t _totalBytes;
+  static size_t _peakTotalBytes;
+
+  /**
+   * @brief Apply a change in bytes to a subsystem's total and update the peaks
+   * @param subsystem Subsystem that changed
+   * @param bytes Change in bytes
+   */
+  static void _update(MemorySubsystem subsystem, long bytes);
+};
+
+#endif // DCCEXMEMORY_H
@@ -44,6 +44,276 @@ Function/method prefixes
 static const int MIN_SPEED = 0;
 static const int MAX_SPEED = 126;
 
+#ifdef DCCEX_STATIC_HANDLER
+#include "DCCEXStaticHandler.h"
+
+/*
+ * For each handler method, _has_<method>() is true at compile time if the handler can be called with the provided
+ * arguments, and _call_<method>() calls it directly, or does nothing if the handler has no such method.
+ */
+#define DCCEX_HANDLER_METHOD(method)                                                                                   \
+  template <typename H, typename... A>                                                                                 \
+  static constexpr auto _has_##method(int, A... a)->decltype((void)((H *)nullptr)->method(a...), bool()) {            \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+  template <typename H, typename... A> static constexpr bool _has_##method(long, A...) { return false; }              \
+  template <typename H, typename... A>                                                                                 \
+  static inline auto _call_##method(H *handler, int, A... a)->decltype((void)handler->method(a...)) {                  \
+    handler->method(a...);                                                                                             \
+  }                                                                                                                    \
+  template <typename H, typename... A> static inline void _call_##method(H *, long, A...) {}
+
+// Compile time checks and direct calls for every handler method
+struct DCCEXHandlerMethods {
+  DCCEX_HANDLER_METHOD(receivedServerVersion)
+  DCCEX_HANDLER_METHOD(receivedMessage)
+  DCCEX_HANDLER_METHOD(receivedRosterList)
+  DCCEX_HANDLER_METHOD(receivedTurnoutList)
+  DCCEX_HANDLER_METHOD(receivedRouteList)
+  DCCEX_HANDLER_METHOD(receivedTurntableList)
+  DCCEX_HANDLER_METHOD(receivedLocoUpdate)
+  DCCEX_HANDLER_METHOD(receivedLocoBroadcast)
+  DCCEX_HANDLER_METHOD(receivedCoalescedLocoBroadcast)
+  DCCEX_HANDLER_METHOD(receivedTrackPower)
+  DCCEX_HANDLER_METHOD(receivedTrackCurrentGauge)
+  DCCEX_HANDLER_METHOD(receivedTrackCurrent)
+  DCCEX_HANDLER_METHOD(receivedIndividualTrackPower)
+  DCCEX_HANDLER_METHOD(receivedTrackType)
+  DCCEX_HANDLER_METHOD(receivedTurnoutAction)
+  DCCEX_HANDLER_METHOD(receivedTurntableAction)
+  DCCEX_HANDLER_METHOD(receivedReadLoco)
+  DCCEX_HANDLER_METHOD(receivedValidateCV)
+  DCCEX_HANDLER_METHOD(receivedValidateCVBit)
+  DCCEX_HANDLER_METHOD(receivedWriteLoco)
+  DCCEX_HANDLER_METHOD(receivedWriteCV)
+  DCCEX_HANDLER_METHOD(receivedScreenUpdate)
+  DCCEX_HANDLER_METHOD(receivedCSConsist)
+  DCCEX_HANDLER_METHOD(receivedSetFastClock)
+  DCCEX_HANDLER_METHOD(receivedFastClockTime)
+};
+
+#undef DCCEX_HANDLER_METHOD
+
+typedef DCCEXHandlerMethods M;
+typedef DCCEX_STATIC_HANDLER Handler;
+
+// A handler with only one of the two Loco broadcast methods receives both kinds of broadcast through it
+static constexpr bool HANDLER_HAS_LOCO_BROADCAST = M::_has_receivedLocoBroadcast<Handler>(0, 0, 0, Forward, 0);
+static constexpr bool HANDLER_HAS_COALESCED_LOCO_BROADCAST =
+    M::_has_receivedCoalescedLocoBroadcast<Handler>(0, 0, 0, Forward, 0, 0);
+
+const uint32_t DCCEXStaticDispatch::handlerMask =
+    (M::_has_receivedServerVersion<Handler>(0, 0, 0, 0) ? (1UL << EventServerVersion) : 0) |
+    (M::_has_receivedMessage<Handler>(0, (const char *)nullptr) ? (1UL << EventMessage) : 0) |
+    (M::_has_receivedRosterList<Handler>(0) ? (1UL << EventRosterList) : 0) |
+    (M::_has_receivedTurnoutList<Handler>(0) ? (1UL << EventTurnoutList) : 0) |
+    (M::_has_receivedRouteList<Handler>(0) ? (1UL << EventRouteList) : 0) |
+    (M::_has_receivedTurntableList<Handler>(0) ? (1UL << EventTurntableList) : 0) |
+    (M::_has_receivedLocoUpdate<Handler>(0, (Loco *)nullptr) ? (1UL << EventLocoUpdate) : 0) |
+    ((HANDLER_HAS_LOCO_BROADCAST || HANDLER_HAS_COALESCED_LOCO_BROADCAST) ? (1UL << EventLocoBroadcast) : 0) |
+    (M::_has_receivedTrackPower<Handler>(0, PowerOff) ? (1UL << EventTrackPower) : 0) |
+    (M::_has_receivedTrackCurrentGauge<Handler>(0, 'A', 0) ? (1UL << EventTrackCurrentGauge) : 0) |
+    (M::_has_receivedTrackCurrent<Handler>(0, 'A', 0) ? (1UL << EventTrackCurrent) : 0) |
+    (M::_has_receivedIndividualTrackPower<Handler>(0, PowerOff, 0) ? (1UL << EventIndividualTrackPower) : 0) |
+    (M::_has_receivedTrackType<Handler>(0, 'A', MAIN, 0) ? (1UL << EventTrackType) : 0) |
+    (M::_has_receivedTurnoutAction<Handler>(0, 0, false) ? (1UL << EventTurnoutAction) : 0) |
+    (M::_has_receivedTurntableAction<Handler>(0, 0, 0, false) ? (1UL << EventTurntableAction) : 0) |
+    (M::_has_receivedReadLoco<Handler>(0, 0) ? (1UL << EventReadLoco) : 0) |
+    (M::_has_receivedValidateCV<Handler>(0, 0, 0) ? (1UL << EventValidateCV) : 0) |
+    (M::_has_receivedValidateCVBit<Handler>(0, 0, 0, 0) ? (1UL << EventValidateCVBit) : 0) |
+    (M::_has_receivedWriteLoco<Handler>(0, 0) ? (1UL << EventWriteLoco) : 0) |
+    (M::_has_receivedWriteCV<Handler>(0, 0, 0) ? (1UL << EventWriteCV) : 0) |
+    (M::_has_receivedScreenUpdate<Handler>(0, 0, 0, (const char *)nullptr) ? (1UL << EventScreenUpdate) : 0) |
+    (M::_has_receivedCSConsist<Handler>(0, 0, (CSConsist *)nullptr) ? (1UL << EventCSConsist) : 0) |
+    (M::_has_receivedSetFastClock<Handler>(0, 0, 0) ? (1UL << EventSetFastClock) : 0) |
+    (M::_has_receivedFastClockTime<Handler>(0, 0) ? (1UL << EventFastClockTime) : 0);
+
+inline void DCCEXStaticDispatch::receivedServerVersion(int major, int minor, int patch) {
+  if (_handlerWants(EventServerVersion))
+    M::_call_receivedServerVersion(_handler, 0, major, minor, patch);
+  if (_delegateWants(EventServerVersion))
+    _delegate->receivedServerVersion(major, minor, patch);
+}
+
+inline void DCCEXStaticDispatch::receivedMessage(const char *message) {
+  if (_handlerWants(EventMessage))
+    M::_call_receivedMessage(_handler, 0, message);
+  if (_delegateWants(EventMessage))
+    _delegate->receivedMessage(message);
+}
+
+inline void DCCEXStaticDispatch::receivedRosterList() {
+  if (_handlerWants(EventRosterList))
+    M::_call_receivedRosterList(_handler, 0);
+  if (_delegateWants(EventRosterList))
+    _delegate->receivedRosterList();
+}
+
+inline void DCCEXStaticDispatch::receivedTurnoutList() {
+  if (_handlerWants(EventTurnoutList))
+    M::_call_receivedTurnoutList(_handler, 0);
+  if (_delegateWants(EventTurnoutList))
+    _delegate->receivedTurnoutList();
+}
+
+inline void DCCEXStaticDispatch::receivedRouteList() {
+  if (_handlerWants(EventRouteList))
+    M::_call_receivedRouteList(_handler, 0);
+  if (_delegateWants(EventRouteList))
+    _delegate->receivedRouteList();
+}
+
+inline void DCCEXStaticDispatch::receivedTurntableList() {
+  if (_handlerWants(EventTurntableList))
+    M::_call_receivedTurntableList(_handler, 0);
+  if (_delegateWants(EventTurntableList))
+    _delegate->receivedTurntableList();
+}
+
+inline void DCCEXStaticDispatch::receivedLocoUpdate(Loco *loco) {
+  if (_handlerWants(EventLocoUpdate))
+    M::_call_receivedLocoUpdate(_handler, 0, loco);
+  if (_delegateWants(EventLocoUpdate))
+    _delegate->receivedLocoUpdate(loco);
+}
+
+inline void DCCEXStaticDispatch::receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) {
+  if (_handlerWants(EventLocoBroadcast)) {
+    if (HANDLER_HAS_LOCO_BROADCAST)
+      M::_call_receivedLocoBroadcast(_handler, 0, address, speed, direction, functionMap);
+    else
+      M::_call_receivedCoalescedLocoBroadcast(_handler, 0, address, speed, direction, functionMap, 1);
+  }
+  if (_delegateWants(EventLocoBroadcast))
+    _delegate->receivedLocoBroadcast(address, speed, direction, functionMap);
+}
+
+inline void DCCEXStaticDispatch::receivedCoalescedLocoBroadcast(int address, int speed, Direction direction,
+                                                                int functionMap, int mergedCount) {
+  if (_handlerWants(EventLocoBroadcast)) {
+    if (HANDLER_HAS_COALESCED_LOCO_BROADCAST)
+      M::_call_receivedCoalescedLocoBroadcast(_handler, 0, address, speed, direction, functionMap, mergedCount);
+    else
+      M::_call_receivedLocoBroadcast(_handler, 0, address, speed, direction, functionMap);
+  }
+  if (_delegateWants(EventLocoBroadcast))
+    _delegate->receivedCoalescedLocoBroadcast(address, speed, direction, functionMap, mergedCount);
+}
+
+inline void DCCEXStaticDispatch::receivedTrackPower(TrackPower state) {
+  if (_handlerWants(EventTrackPower))
+    M::_call_receivedTrackPower(_handler, 0, state);
+  if (_delegateWants(EventTrackPower))
+    _delegate->receivedTrackPower(state);
+}
+
+inline void DCCEXStaticDispatch::receivedTrackCurrentGauge(char track, int limit) {
+  if (_handlerWants(EventTrackCurrentGauge))
+    M::_call_receivedTrackCurrentGauge(_handler, 0, track, limit);
+  if (_delegateWants(EventTrackCurrentGauge))
+    _delegate->receivedTrackCurrentGauge(track, limit);
+}
+
+inline void DCCEXStaticDispatch::receivedTrackCurrent(char track, int current) {
+  if (_handlerWants(EventTrackCurrent))
+    M::_call_receivedTrackCurrent(_handler, 0, track, current);
+  if (_delegateWants(EventTrackCurrent))
+    _delegate->receivedTrackCurrent(track, current);
+}
+
+inline void DCCEXStaticDispatch::receivedIndividualTrackPower(TrackPower state, int track) {
+  if (_handlerWants(EventIndividualTrackPower))
+    M::_call_receivedIndividualTrackPower(_handler, 0, state, track);
+  if (_delegateWants(EventIndividualTrackPower))
+    _delegate->receivedIndividualTrackPower(state, track);
+}
+
+inline void DCCEXStaticDispatch::receivedTrackType(char track, TrackManagerMode type, int address) {
+  if (_handlerWants(EventTrackType))
+    M::_call_receivedTrackType(_handler, 0, track, type, address);
+  if (_delegateWants(EventTrackType))
+    _delegate->receivedTrackType(track, type, address);
+}
+
+inline void DCCEXStaticDispatch::receivedTurnoutAction(int turnoutId, bool thrown) {
+  if (_handlerWants(EventTurnoutAction))
+    M::_call_receivedTurnoutAction(_handler, 0, turnoutId, thrown);
+  if (_delegateWants(EventTurnoutAction))
+    _delegate->receivedTurnoutAction(turnoutId, thrown);
+}
+
+inline void DCCEXStaticDispatch::receivedTurntableAction(int turntableId, int position, bool moving) {
+  if (_handlerWants(EventTurntableAction))
+    M::_call_receivedTurntableAction(_handler, 0, turntableId, position, moving);
+  if (_delegateWants(EventTurntableAction))
+    _delegate->receivedTurntableAction(turntableId, position, moving);
+}
+
+inline void DCCEXStaticDispatch::receivedReadLoco(int address) {
+  if (_handlerWants(EventReadLoco))
+    M::_call_receivedReadLoco(_handler, 0, address);
+  if (_delegateWants(EventReadLoco))
+    _delegate->receivedReadLoco(address);
+}
+
+inline void DCCEXStaticDispatch::receivedValidateCV(int cv, int value) {
+  if (_handlerWants(EventValidateCV))
+    M::_call_receivedValidateCV(_handler, 0, cv, value);
+  if (_delegateWants(EventValidateCV))
+    _delegate->receivedValidateCV(cv, value);
+}
+
+inline void DCCEXStaticDispatch::receivedValidateCVBit(int cv, int bit, int value) {
+  if (_handlerWants(EventValidateCVBit))
+    M::_call_receivedValidateCVBit(_handler, 0, cv, bit, value);
+  if (_delegateWants(EventValidateCVBit))
+    _delegate->receivedValidateCVBit(cv, bit, value);
+}
+
+inline void DCCEXStaticDispatch::receivedWriteLoco(int address) {
+  if (_handlerWants(EventWriteLoco))
+    M::_call_receivedWriteLoco(_handler, 0, address);
+  if (_delegateWants(EventWriteLoco))
+    _delegate->receivedWriteLoco(address);
+}
+
+inline void DCCEXStaticDispatch::receivedWriteCV(int cv, int value) {
+  if (_handlerWants(EventWriteCV))
+    M::_call_receivedWriteCV(_handler, 0, cv, value);
+  if (_delegateWants(EventWriteCV))
+    _delegate->receivedWriteCV(cv, value);
+}
+
+inline void DCCEXStaticDispatch::receivedScreenUpdate(int screen, int row, const char *message) {
+  if (_handlerWants(EventScreenUpdate))
+    M::_call_receivedScreenUpdate(_handler, 0, screen, row, message);
+  if (_delegateWants(EventScreenUpdate))
+    _delegate->receivedScreenUpdate(screen, row, message);
+}
+
+inline void DCCEXStaticDispatch::receivedCSConsist(int leadLoco, CSConsist *csConsist) {
+  if (_handlerWants(EventCSConsist))
+    M::_call_receivedCSConsist(_handler, 0, leadLoco, csConsist);
+  if (_delegateWants(EventCSConsist))
+    _delegate->receivedCSConsist(leadLoco, csConsist);
+}
+
+inline void DCCEXStaticDispatch::receivedSetFastClock(int minutes, int speedFactor) {
+  if (_handlerWants(EventSetFastClock))
+    M::_call_receivedSetFastClock(_handler, 0, minutes, speedFactor);
+  if (_delegateWants(EventSetFastClock))
+    _delegate->receivedSetFastClock(minutes, speedFactor);
+}
+
+inline void DCCEXStaticDispatch::receivedFastClockTime(int minutes) {
+  if (_handlerWants(EventFastClockTime))
+    M::_call_receivedFastClockTime(_handler, 0, minutes);
+  if (_delegateWants(EventFastClockTime))
+    _delegate->receivedFastClockTime(minutes);
+}
+
+#endif
+
 // DCCEXProtocol class
 // Public methods
 // Protocol and server methods
@@ -54,8 +324,15 @@ DCCEXProtocol::DCCEXProtocol(int maxCmdBuffer, int maxCommandParams, unsigned lo
   _console = &_nullStream;
 
   // Allocate memory for command buffer
+#ifdef DCCEX_STATIC_MEMORY
+  if (maxCmdBuffer > DCCEX_STATIC_COMMAND_BUFFER)
+    maxCmdBuffer = DCCEX_STATIC_COMMAND_BUFFER;
+#else
   _cmdBuffer = new char[maxCmdBuffer];
+#endif
   _maxCmdBuffer = maxCmdBuffer;
+  MemoryStats::addBufferBytes(MemoryParser, _maxCmdBuffer + sizeof(_inputBuffer));
+  MemoryStats::addBufferBytes(MemoryOutbound, sizeof(_outboundCommand));
 
   // Setup command parser
   DCCEXInbound::setup(maxCommandParams);
@@ -70,6 +347,9 @@ DCCEXProtocol::DCCEXProtocol(int maxCmdBuffer, int maxCommandParams, unsigned lo
   _enableHeartbeat = 0;
   _heartbeatDelay = 0;
   _lastHeartbeat = 0;
+
+  // Nothing is known about the tracks yet
+  clearTrackStates();
 }
 
 DCCEXProtocol::~DCCEXProtocol() {
@@ -77,14 +357,54 @@ DCCEXProtocol::~DCCEXProtocol() {
   clearAllLists();
 
   // Free memory for command buffer
+#ifndef DCCEX_STATIC_MEMORY
   delete[] (_cmdBuffer);
+#endif
+  MemoryStats::addBufferBytes(MemoryParser, -(long)(_maxCmdBuffer + sizeof(_inputBuffer)));
+  MemoryStats::addBufferBytes(MemoryOutbound, -(long)sizeof(_outboundCommand));
+
+  // Free the Loco address interest bitmap
+  _releaseLocoInterest();
+
+  // Free any throttle latency entries
+  disableThrottleLatency();
 
   // Cleanup command parser
   DCCEXInbound::cleanup();
+
+  // Ensure no list still refers to our arenas
+  for (int list = 0; list < ARENA_LIST_COUNT; list++) {
+    if (_arenas[list].isEnabled())
+      _registerArena((ArenaList)list, nullptr);
+  }
 }
 
 // Set the delegate instance for callbacks
-void DCCEXProtocol::setDelegate(DCCEXProtocolDelegate *delegate) { this->_delegate = delegate; }
+void DCCEXProtocol::setDelegate(DCCEXProtocolDelegate *delegate) {
+  _observers.setDelegate(delegate);
+  _updateEventMask();
+}
+
+bool DCCEXProtocol::addObserver(DCCEXProtocolDelegate *observer, uint32_t eventMask) {
+  bool added = _observers.add(observer, eventMask);
+  _updateEventMask();
+  return added;
+}
+
+bool DCCEXProtocol::removeObserver(DCCEXProtocolDelegate *observer) {
+  bool removed = _observers.remove(observer);
+  _updateEventMask();
+  return removed;
+}
+
+uint32_t DCCEXProtocol::getSubscribedEventMask() { return _eventMask; }
+
+#ifdef DCCEX_STATIC_HANDLER
+void DCCEXProtocol::setStaticHandler(DCCEX_STATIC_HANDLER *handler) {
+  _delegate.setHandler(handler);
+  _updateEventMask();
+}
+#endif
 
 // Set the Stream used for logging
 void DCCEXProtocol::setLogStream(Stream *console) { this->_console = console; }
@@ -96,14 +416,25 @@ void DCCEXProtocol::enableHeartbeat(unsigned long heartbeatDelay) {
 
 void DCCEXProtocol::connect(Stream *stream) {
   _init();
+  clearTrackStates();
+  _staleCVResponses = 0;
   this->_stream = stream;
+  MemoryStats::resetPeaks();
 }
 
 void DCCEXProtocol::disconnect() { return; }
 
 void DCCEXProtocol::check() {
   if (_stream) {
+#ifdef DCCEX_THREADED
+    // pollStream() frames commands on the I/O thread, so only parse them here
+    while (_threaded && _inboundQueue.pop(_cmdBuffer, _maxCmdBuffer)) {
+      _parseCommandBuffer();
+    }
+    while (!_threaded && _stream->available()) {
+#else
     while (_stream->available()) {
+#endif
       // Read from our stream
       int r = _stream->read();
       if (_bufflen < _maxCmdBuffer - 1) {
@@ -117,19 +448,35 @@ void DCCEXProtocol::check() {
       }
 
       if (r == '>') {
-        if (DCCEXInbound::parse(_cmdBuffer)) {
-          // Process stuff here
-          if (_debug) {
-            _console->print("<== ");
-            _console->println(_cmdBuffer);
-          }
-          _processCommand();
-        }
-        // Clear buffer after use
-        _cmdBuffer[0] = 0;
-        _bufflen = 0;
+        _parseCommandBuffer();
       }
     }
+    if (_coalesceLocoBroadcasts && _coalescedLocoCount > 0 &&
+        millis() - _lastCoalescedDelivery >= _coalesceInterval) {
+      _deliverLocoBroadcasts();
+    }
+
+    if (_cvOperationCount > 0) {
+      _processCVOperations();
+    }
+
+    if (_pomWrites) {
+      _processPOMBatch();
+    }
+
+    if (_currentPolling && millis() - _lastCurrentPoll >= _currentPollPeriod) {
+      _lastCurrentPoll = millis();
+      requestTrackCurrents();
+    }
+
+    if (_fastClockTick && _fastClockKnown) {
+      int minutes = getFastClockMinutes();
+      if (minutes != _fastClockLastTick) {
+        _fastClockLastTick = minutes;
+        _fastClockTick(minutes, _fastClockTickContext);
+      }
+    }
+
     if (_enableHeartbeat) {
       _sendHeartbeat();
     }
@@ -232,9 +579,302 @@ void DCCEXProtocol::refreshAllLists() {
 
 void DCCEXProtocol::setDebug(bool debug) { _debug = debug; }
 
+// Arena methods
+
+bool DCCEXProtocol::enableArena(ArenaList list, size_t capacity) {
+  if (list < 0 || list >= ARENA_LIST_COUNT)
+    return false;
+
+  _refreshArenaList(list);
+  bool enabled = _arenas[list].begin(capacity);
+  _registerArena(list, enabled ? &_arenas[list] : nullptr);
+  return enabled;
+}
+
+bool DCCEXProtocol::enableArena(ArenaList list, void *buffer, size_t size) {
+  if (list < 0 || list >= ARENA_LIST_COUNT)
+    return false;
+
+  _refreshArenaList(list);
+  bool enabled = _arenas[list].begin(buffer, size);
+  _registerArena(list, enabled ? &_arenas[list] : nullptr);
+  return enabled;
+}
+
+void DCCEXProtocol::disableArena(ArenaList list) {
+  if (list < 0 || list >= ARENA_LIST_COUNT)
+    return;
+
+  _refreshArenaList(list);
+  _registerArena(list, nullptr);
+  _arenas[list].end();
+}
+
+size_t DCCEXProtocol::getArenaBytesUsed(ArenaList list) {
+  if (list < 0 || list >= ARENA_LIST_COUNT)
+    return 0;
+
+  return _arenas[list].getBytesUsed();
+}
+
+size_t DCCEXProtocol::getArenaCapacity(ArenaList list) {
+  if (list < 0 || list >= ARENA_LIST_COUNT)
+    return 0;
+
+  return _arenas[list].getCapacity();
+}
+
+int DCCEXProtocol::getArenaOverflowCount(ArenaList list) {
+  if (list < 0 || list >= ARENA_LIST_COUNT)
+    return 0;
+
+  return _arenas[list].getOverflowCount();
+}
+
+// Event queue methods
+
+bool DCCEXProtocol::enableEventQueue(int capacity, uint32_t eventMask) {
+  bool enabled = _eventQueue.begin(capacity);
+  _queueEventMask = eventMask;
+  _updateEventMask();
+  return enabled;
+}
+
+bool DCCEXProtocol::enableEventQueue(DCCEXEvent *buffer, int capacity, uint32_t eventMask) {
+  bool enabled = _eventQueue.begin(buffer, capacity);
+  _queueEventMask = eventMask;
+  _updateEventMask();
+  return enabled;
+}
+
+void DCCEXProtocol::disableEventQueue() {
+  _eventQueue.end();
+  _updateEventMask();
+}
+
+bool DCCEXProtocol::isEventQueueEnabled() { return _eventQueue.isEnabled(); }
+
+bool DCCEXProtocol::getNextEvent(DCCEXEvent &event) { return _eventQueue.pop(event); }
+
+int DCCEXProtocol::processEvents(int maxEvents) {
+  // Only process what is queued now, so a delegate that calls check() cannot keep this running
+  int count = _eventQueue.getCount();
+  if (maxEvents > 0 && maxEvents < count)
+    count = maxEvents;
+
+  DCCEXEvent event;
+  int processed = 0;
+  while (processed < count && _eventQueue.pop(event)) {
+    DCCEXEventRecorder::dispatch(event, &_observers);
+    processed++;
+  }
+  return processed;
+}
+
+int DCCEXProtocol::getEventCount() { return _eventQueue.getCount(); }
+
+int DCCEXProtocol::getPeakEventCount() { return _eventQueue.getPeakCount(); }
+
+unsigned long DCCEXProtocol::getEventOverflowCount() { return _eventQueue.getOverflowCount(); }
+
+#ifdef DCCEX_THREADED
+// Threaded methods
+
+bool DCCEXProtocol::enableThreading(size_t inboundCapacity, size_t outboundCapacity) {
+  disableThreading();
+  if (!_inboundQueue.begin(inboundCapacity) || !_outboundQueue.begin(outboundCapacity)) {
+    disableThreading();
+    return false;
+  }
+  _threaded = true;
+  return true;
+}
+
+bool DCCEXProtocol::enableThreading(char *inboundBuffer, size_t inboundCapacity, char *outboundBuffer,
+                                    size_t outboundCapacity) {
+  disableThreading();
+  if (!_inboundQueue.begin(inboundBuffer, inboundCapacity) || !_outboundQueue.begin(outboundBuffer, outboundCapacity)) {
+    disableThreading();
+    return false;
+  }
+  _threaded = true;
+  return true;
+}
+
+void DCCEXProtocol::disableThreading() {
+  _threaded = false;
+  _inboundQueue.end();
+  _outboundQueue.end();
+  _framedLength = 0;
+}
+
+bool DCCEXProtocol::isThreadingEnabled() { return _threaded; }
+
+void DCCEXProtocol::pollStream() {
+  if (!_threaded || !_stream)
+    return;
+
+  char command[MAX_OUTBOUND_COMMAND_LENGTH];
+  while (_outboundQueue.pop(command, sizeof(command))) {
+    _stream->print(command);
+  }
+
+  // Frame commands straight into the inbound queue, with the same length limit as the command buffer
+  while (_stream->available()) {
+    int r = _stream->read();
+    if (_framedLength < _maxCmdBuffer - 1) {
+      _inboundQueue.append(r);
+      _framedLength++;
+    } else {
+      // Discard the command if too long
+      _inboundQueue.discard();
+      _framedLength = 0;
+    }
+
+    if (r == '>') {
+      _inboundQueue.commit();
+      _framedLength = 0;
+    }
+  }
+}
+
+unsigned long DCCEXProtocol::getInboundOverflowCount() { return _inboundQueue.getOverflowCount(); }
+
+unsigned long DCCEXProtocol::getOutboundOverflowCount() { return _outboundQueue.getOverflowCount(); }
+#endif
+
+// Memory reporting methods
+
+MemoryUsage DCCEXProtocol::getMemoryUsage(MemorySubsystem subsystem) { return MemoryStats::getUsage(subsystem); }
+
+MemoryUsage DCCEXProtocol::getPeakMemoryUsage(MemorySubsystem subsystem) {
+  return MemoryStats::getPeakUsage(subsystem);
+}
+
+size_t DCCEXProtocol::getTotalMemoryBytes() { return MemoryStats::getTotalBytes(); }
+
+size_t DCCEXProtocol::getPeakTotalMemoryBytes() { return MemoryStats::getPeakTotalBytes(); }
+
+void DCCEXProtocol::resetPeakMemoryUsage() { MemoryStats::resetPeaks(); }
+
+#ifdef DCCEX_STATIC_MEMORY
+// Static memory methods
+
+StaticPoolStats DCCEXProtocol::getStaticPoolStats(StaticPoolId pool) {
+  switch (pool) {
+  case StaticPoolLocos:
+    return Loco::getPoolStats();
+  case StaticPoolTurnouts:
+    return Turnout::getPoolStats();
+  case StaticPoolRoutes:
+    return Route::getPoolStats();
+  case StaticPoolTurntables:
+    return Turntable::getPoolStats();
+  case StaticPoolTurntableIndexes:
+    return TurntableIndex::getPoolStats();
+  case StaticPoolCSConsists:
+    return CSConsist::getPoolStats();
+  case StaticPoolCSConsistMembers:
+    return CSConsistMember::getPoolStats();
+  case StaticPoolNames:
+    return ListArena::getNamePoolStats();
+  default:
+    break;
+  }
+  StaticPoolStats stats = {0, 0, 0, 0};
+  return stats;
+}
+
+int DCCEXProtocol::getStaticOverflowCount() {
+  int overflowCount = 0;
+  for (int pool = 0; pool < STATIC_POOL_COUNT; pool++) {
+    overflowCount += getStaticPoolStats((StaticPoolId)pool).overflowCount;
+  }
+  return overflowCount;
+}
+#endif
+
 // Consist/loco methods
 
+bool DCCEXProtocol::addLocoInterest(int address) {
+  if (address < 1 || address > MAX_LOCO_ADDRESS)
+    return false;
+
+  if (_locoInterest == nullptr) {
+#ifdef DCCEX_STATIC_MEMORY
+    return false;
+#else
+    _locoInterest = new uint8_t[LOCO_INTEREST_BYTES];
+    if (_locoInterest == nullptr)
+      return false;
+    _ownsLocoInterest = true;
+    memset(_locoInterest, 0, LOCO_INTEREST_BYTES);
+    MemoryStats::addBufferBytes(MemoryLocoState, LOCO_INTEREST_BYTES);
+#endif
+  }
+  _locoInterest[address >> 3] |= (1 << (address & 7));
+  return true;
+}
+
+bool DCCEXProtocol::setLocoInterestBuffer(uint8_t *buffer, size_t size) {
+  _releaseLocoInterest();
+  if (buffer == nullptr || size < (size_t)LOCO_INTEREST_BYTES)
+    return false;
+
+  _locoInterest = buffer;
+  memset(_locoInterest, 0, LOCO_INTEREST_BYTES);
+  return true;
+}
+
+void DCCEXProtocol::removeLocoInterest(int address) {
+  if (address < 1 || address > MAX_LOCO_ADDRESS || !_locoInterest)
+    return;
+
+  _locoInterest[address >> 3] &= ~(1 << (address & 7));
+}
+
+void DCCEXProtocol::clearLocoInterest() {
+  if (_locoInterest)
+    memset(_locoInterest, 0, LOCO_INTEREST_BYTES);
+}
+
+bool DCCEXProtocol::isLocoInterest(int address) {
+  if (address < 1 || address > MAX_LOCO_ADDRESS || !_locoInterest)
+    return false;
+
+  return _locoInterest[address >> 3] & (1 << (address & 7));
+}
+
+void DCCEXProtocol::setLocoInterestFilter(bool enabled) { _locoInterestFilter = enabled; }
+
+bool DCCEXProtocol::getLocoInterestFilter() { return _locoInterestFilter; }
+
+unsigned long DCCEXProtocol::getFilteredLocoBroadcastCount() { return _filteredLocoBroadcasts; }
+
+void DCCEXProtocol::setLocoBroadcastCoalescing(bool enabled, unsigned long interval) {
+  if (!enabled && _coalescedLocoCount > 0)
+    _deliverLocoBroadcasts();
+  _coalesceLocoBroadcasts = enabled;
+  _coalesceInterval = interval;
+  _lastCoalescedDelivery = millis();
+}
+
+bool DCCEXProtocol::getLocoBroadcastCoalescing() { return _coalesceLocoBroadcasts; }
+
+unsigned long DCCEXProtocol::getMergedLocoBroadcastCount() { return _mergedLocoBroadcasts; }
+
+void DCCEXProtocol::setLocalLocoCacheSize(int size) {
+  _localLocoCacheSize = (size > 0) ? size : 0;
+  if (_localLocoCacheSize > 0)
+    _evictLocalLocos(_localLocoCacheSize);
+}
+
+int DCCEXProtocol::getLocalLocoCacheSize() { return _localLocoCacheSize; }
+
+int DCCEXProtocol::getLocalLocoEvictionCount() { return _localLocoEvictions; }
+
 void DCCEXProtocol::setThrottle(Loco *loco, int speed, Direction direction) {
+  LocoStateTable::markUsed(loco->getStateSlot());
   loco->setUserSpeed(speed);
   loco->setUserDirection(direction);
 }
@@ -253,20 +893,19 @@ void DCCEXProtocol::setThrottle(CSConsist *csConsist, int speed, Direction direc
   if (!csConsist || !csConsist->isValid())
     return;
 
-  int leadLoco = csConsist->getFirstMember()->address;
-  // Attempt to get an existing Loco for lead address
-  Loco *loco = Loco::getByAddress(leadLoco);
-
-  if (loco == nullptr)
-    loco = new Loco(leadLoco, LocoSource::LocoSourceEntry);
+  // Use an existing Loco for the lead address, or create a local one
+  Loco *loco = _getLocalLoco(csConsist->getFirstMember()->address);
 
-  setThrottle(loco, speed, direction);
+  if (loco)
+    setThrottle(loco, speed, direction);
 }
 
 void DCCEXProtocol::functionOn(Loco *loco, int function) {
+  LocoStateTable::markUsed(loco->getStateSlot());
   int address = loco->getAddress();
   if (address >= 0) {
     _sendThreeParams('F', address, function, 1);
+    _updateLocoFunction(address, function, true);
   }
 }
 
@@ -281,21 +920,21 @@ void DCCEXProtocol::functionOn(CSConsist *csConsist, int function) {
     return;
 
   CSConsistMember *first = csConsist->getFirstMember();
-  Loco *loco = Loco::getByAddress(first->address);
-
-  if (loco == nullptr)
-    loco = new Loco(first->address, LocoSource::LocoSourceEntry);
+  _getLocalLoco(first->address);
 
   _sendThreeParams('F', first->address, function, true);
+  _updateLocoFunction(first->address, function, true);
 
   if (csConsist->getReplicateFunctions())
     _setCSConsistMemberFunction(first->next, function, true);
 }
 
 void DCCEXProtocol::functionOff(Loco *loco, int function) {
+  LocoStateTable::markUsed(loco->getStateSlot());
   int address = loco->getAddress();
   if (address >= 0) {
     _sendThreeParams('F', address, function, 0);
+    _updateLocoFunction(address, function, false);
   }
 }
 
@@ -310,12 +949,10 @@ void DCCEXProtocol::functionOff(CSConsist *csConsist, int function) {
     return;
 
   CSConsistMember *first = csConsist->getFirstMember();
-  Loco *loco = Loco::getByAddress(first->address);
-
-  if (loco == nullptr)
-    loco = new Loco(first->address, LocoSource::LocoSourceEntry);
+  _getLocalLoco(first->address);
 
   _sendThreeParams('F', first->address, function, false);
+  _updateLocoFunction(first->address, function, false);
 
   if (csConsist->getReplicateFunctions())
     _setCSConsistMemberFunction(first->next, function, false);
@@ -366,6 +1003,7 @@ void DCCEXProtocol::clearRoster() {
   Loco::clearRoster();
   roster = nullptr;
   _rosterCount = 0;
+  _arenas[ArenaRoster].reset();
 }
 
 void DCCEXProtocol::clearLocalLocos() { Loco::clearLocalLocos(); }
@@ -395,6 +1033,8 @@ CSConsist *DCCEXProtocol::createCSConsist(int leadLoco, bool reversed, bool repl
     return nullptr;
 
   csConsist = new CSConsist(replicateFunctions);
+  if (csConsist == nullptr)
+    return nullptr;
   csConsist->addMember(leadLoco, reversed);
 
   return csConsist;
@@ -576,6 +1216,7 @@ void DCCEXProtocol::clearTurnoutList() {
   Turnout::clearTurnoutList();
   turnouts = nullptr;
   _turnoutCount = 0;
+  _arenas[ArenaTurnouts].reset();
 }
 
 void DCCEXProtocol::refreshTurnoutList() {
@@ -608,6 +1249,7 @@ void DCCEXProtocol::clearRouteList() {
   Route::clearRouteList();
   routes = nullptr;
   _routeCount = 0;
+  _arenas[ArenaRoutes].reset();
 }
 
 void DCCEXProtocol::refreshRouteList() {
@@ -651,6 +1293,9 @@ void DCCEXProtocol::clearTurntableList() {
   Turntable::clearTurntableList();
   turntables = nullptr;
   _turntableCount = 0;
+  _outstandingTurntables = 0;
+  _outstandingTurntableIndexes = 0;
+  _arenas[ArenaTurntables].reset();
 }
 
 void DCCEXProtocol::refreshTurntableList() {
@@ -676,11 +1321,24 @@ void DCCEXProtocol::powerProgOff() { _sendOneParam('0', "PROG"); }
 
 void DCCEXProtocol::joinProg() { _sendOneParam('1', "JOIN"); }
 
-void DCCEXProtocol::powerTrackOn(char track) { _sendOneParam('1', track); }
+void DCCEXProtocol::powerTrackOn(char track) {
+  if (getTrackPower(track) == PowerOn)
+    return;
+  _sendOneParam('1', track);
+}
 
-void DCCEXProtocol::powerTrackOff(char track) { _sendOneParam('0', track); }
+void DCCEXProtocol::powerTrackOff(char track) {
+  if (getTrackPower(track) == PowerOff)
+    return;
+  _sendOneParam('0', track);
+}
 
 void DCCEXProtocol::setTrackType(char track, TrackManagerMode type, int address) {
+  // Skip if the track is already known to be in this mode, with this address if it has one
+  TrackState state = getTrackState(track);
+  if (state.modeKnown && state.mode == type && ((type != DC && type != DCX) || state.address == address))
+    return;
+
   switch (type) {
   case MAIN:
     _sendTwoParams('=', track, "MAIN");
@@ -706,6 +1364,107 @@ void DCCEXProtocol::requestTrackCurrentGauges() { _sendOneParam('J', 'G'); }
 
 void DCCEXProtocol::requestTrackCurrents() { _sendOneParam('J', 'I'); }
 
+void DCCEXProtocol::requestTrackTypes() { _sendOpcode('='); }
+
+TrackState DCCEXProtocol::getTrackState(char track) {
+  if (track < 'A' || track >= 'A' + TRACK_COUNT) {
+    TrackState unknown = {false, NONE, 0, PowerUnknown, -1, -1};
+    return unknown;
+  }
+
+  return _tracks[track - 'A'];
+}
+
+TrackPower DCCEXProtocol::getTrackPower(char track) {
+  if (track < 'A' || track >= 'A' + TRACK_COUNT)
+    return PowerUnknown;
+
+  return _tracks[track - 'A'].power;
+}
+
+uint8_t DCCEXProtocol::getTrackPowerMask() { return _trackPowerMask; }
+
+uint8_t DCCEXProtocol::getTrackModeMask(TrackManagerMode mode) {
+  if (mode < 0 || mode >= TRACK_MODE_COUNT)
+    return 0;
+
+  return _trackModeMasks[mode];
+}
+
+bool DCCEXProtocol::enableTrackCurrentPolling(unsigned long period, int samples) {
+  disableTrackCurrentPolling();
+  for (int track = 0; track < TRACK_COUNT; track++) {
+    if (!_currentHistory[track].begin(samples)) {
+      disableTrackCurrentPolling();
+      return false;
+    }
+  }
+  _currentPollPeriod = period;
+  _currentPolling = true;
+  _lastCurrentPoll = millis();
+  requestTrackCurrentGauges();
+  return true;
+}
+
+bool DCCEXProtocol::enableTrackCurrentPolling(unsigned long period, int samples, int *buffer) {
+  disableTrackCurrentPolling();
+  if (buffer == nullptr || samples <= 0)
+    return false;
+
+  for (int track = 0; track < TRACK_COUNT; track++) {
+    _currentHistory[track].begin(buffer + track * samples, samples);
+  }
+  _currentPollPeriod = period;
+  _currentPolling = true;
+  _lastCurrentPoll = millis();
+  requestTrackCurrentGauges();
+  return true;
+}
+
+void DCCEXProtocol::disableTrackCurrentPolling() {
+  for (int track = 0; track < TRACK_COUNT; track++) {
+    _currentHistory[track].end();
+  }
+  _currentPolling = false;
+  _currentAboveMask = 0;
+}
+
+bool DCCEXProtocol::isTrackCurrentPollingEnabled() { return _currentPolling; }
+
+TrackCurrentStats DCCEXProtocol::getTrackCurrentStats(char track) {
+  TrackCurrentStats stats = {0, -1, -1, -1, -1, -1, -1};
+  if (track < 'A' || track >= 'A' + TRACK_COUNT)
+    return stats;
+
+  DCCEXCurrentHistory &history = _currentHistory[track - 'A'];
+  stats.samples = history.getCount();
+  stats.latest = history.getLatest();
+  stats.min = history.getMin();
+  stats.max = history.getMax();
+  stats.mean = history.getMean();
+  stats.gauge = _tracks[track - 'A'].gauge;
+  if (stats.latest >= 0 && stats.gauge > 0)
+    stats.percentOfGauge = (long)stats.latest * 100 / stats.gauge;
+  return stats;
+}
+
+void DCCEXProtocol::setTrackCurrentThreshold(int percent, TrackCurrentThresholdCallback callback, void *context) {
+  _currentThreshold = percent;
+  _currentThresholdCallback = callback;
+  _currentThresholdContext = context;
+  _currentAboveMask = 0;
+}
+
+void DCCEXProtocol::clearTrackStates() {
+  for (int track = 0; track < TRACK_COUNT; track++) {
+    _tracks[track] = {false, NONE, 0, PowerUnknown, -1, -1};
+  }
+  _trackPowerMask = 0;
+  for (int mode = 0; mode < TRACK_MODE_COUNT; mode++) {
+    _trackModeMasks[mode] = 0;
+  }
+}
+
 // DCC accessory methods
 
 void DCCEXProtocol::activateAccessory(int accessoryAddress, int accessorySubAddr) {
@@ -742,6 +1501,102 @@ void DCCEXProtocol::writeCVBitOnMain(int address, int cv, int bit, int value) {
   _sendFourParams('b', address, cv, bit, value);
 }
 
+// Batched programming on main methods
+
+bool DCCEXProtocol::writeCVsOnMain(const POMWrite *writes, int count, unsigned long interval,
+                                   POMBatchCallback callback, void *context) {
+  if (writes == nullptr || count <= 0 || _pomWrites != nullptr)
+    return false;
+
+  _pomWrites = writes;
+  _pomCount = count;
+  _pomWritten = 0;
+  _pomInterval = interval;
+  _pomCallback = callback;
+  _pomContext = context;
+  // Allow the first write straight away
+  _lastPOMWrite = millis() - interval;
+  return true;
+}
+
+void DCCEXProtocol::cancelPOMBatch() {
+  if (_pomWrites)
+    _endPOMBatch();
+}
+
+bool DCCEXProtocol::isPOMBatchRunning() { return _pomWrites != nullptr; }
+
+int DCCEXProtocol::getPOMBatchWritten() { return _pomWritten; }
+
+// Tracked CV programming methods
+
+int DCCEXProtocol::readLoco(CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpReadLoco, 0, 0, 0, callback, context);
+}
+
+int DCCEXProtocol::readCV(int cv, CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpReadCV, cv, 0, 0, callback, context);
+}
+
+int DCCEXProtocol::readCVFast(int cv, CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpFastReadCV, cv, 0, 0, callback, context);
+}
+
+int DCCEXProtocol::validateCV(int cv, int value, CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpValidateCV, cv, 0, value, callback, context);
+}
+
+int DCCEXProtocol::validateCVBit(int cv, int bit, int value, CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpValidateCVBit, cv, bit, value, callback, context);
+}
+
+int DCCEXProtocol::writeLocoAddress(int address, CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpWriteLocoAddress, address, 0, 0, callback, context);
+}
+
+int DCCEXProtocol::writeCV(int cv, int value, CVOperationCallback callback, void *context) {
+  return _queueCVOperation(CVOpWriteCV, cv, 0, value, callback, context);
+}
+
+void DCCEXProtocol::setCVOperationTimeout(unsigned long timeout, int retries) {
+  _cvOperationTimeout = timeout;
+  _cvOperationRetries = retries < 0 ? 0 : retries;
+}
+
+unsigned long DCCEXProtocol::getCVOperationTimeout() { return _cvOperationTimeout; }
+
+int DCCEXProtocol::getCVOperationRetries() { return _cvOperationRetries; }
+
+int DCCEXProtocol::getPendingCVOperationCount() { return _cvOperationCount; }
+
+int DCCEXProtocol::cancelCVOperations(void *context) {
+  if (context == nullptr)
+    return 0;
+
+  // Close up the ring over the cancelled operations, keeping the rest in order
+  int cancelled = 0;
+  int kept = 0;
+  for (int index = 0; index < _cvOperationCount; index++) {
+    PendingCVOperation &pending = _cvOperations[(_cvOperationHead + index) % MAX_PENDING_CV_OPERATIONS];
+    if (pending.context == context) {
+      cancelled++;
+      pending.callback = nullptr;
+      pending.context = nullptr;
+      if (!pending.sent)
+        continue;
+    }
+    if (kept != index)
+      _cvOperations[(_cvOperationHead + kept) % MAX_PENDING_CV_OPERATIONS] = pending;
+    kept++;
+  }
+  _cvOperationCount = kept;
+  return cancelled;
+}
+
+CVOperationStats DCCEXProtocol::getCVOperationStats() { return _cvOperationStats; }
+
+void DCCEXProtocol::resetCVOperationStats() { _cvOperationStats = {}; }
+
 // Fast clock methods
 
 void DCCEXProtocol::setFastClock(int minutes, int speedFactor) {
@@ -753,6 +1608,98 @@ void DCCEXProtocol::setFastClock(int minutes, int speedFactor) {
 
 void DCCEXProtocol::requestFastClockTime() { _sendOneParam('J', 'C'); }
 
+int DCCEXProtocol::getFastClockMinutes() {
+  if (!_fastClockKnown)
+    return -1;
+
+  // Split whole real minutes from the rest so long runs at high speed factors don't overflow
+  unsigned long elapsed = millis() - _fastClockAnchor;
+  unsigned long advanced = (elapsed / 60000) * _fastClockSpeed + (elapsed % 60000) * _fastClockSpeed / 60000;
+  return (_fastClockMinutes + advanced % 1440) % 1440;
+}
+
+int DCCEXProtocol::getFastClockSpeed() { return _fastClockSpeed; }
+
+int DCCEXProtocol::getFastClockDrift() { return _fastClockDrift; }
+
+void DCCEXProtocol::setFastClockTickCallback(FastClockTickCallback callback, void *context) {
+  _fastClockTick = callback;
+  _fastClockTickContext = context;
+  _fastClockLastTick = -1;
+}
+
+// Throttle latency methods
+
+bool DCCEXProtocol::enableThrottleLatency(int locos) {
+  disableThrottleLatency();
+#ifdef DCCEX_STATIC_MEMORY
+  (void)locos;
+  return false;
+#else
+  if (locos <= 0)
+    return false;
+
+  _latencyEntries = new ThrottleLatencyEntry[locos];
+  if (_latencyEntries == nullptr)
+    return false;
+
+  _latencyEntryCount = locos;
+  _ownsLatencyEntries = true;
+  MemoryStats::addBufferBytes(MemoryTelemetry, sizeof(ThrottleLatencyEntry) * _latencyEntryCount);
+  resetThrottleLatency();
+  return true;
+#endif
+}
+
+bool DCCEXProtocol::enableThrottleLatency(ThrottleLatencyEntry *entries, int count) {
+  disableThrottleLatency();
+  if (entries == nullptr || count <= 0)
+    return false;
+
+  _latencyEntries = entries;
+  _latencyEntryCount = count;
+  _ownsLatencyEntries = false;
+  resetThrottleLatency();
+  return true;
+}
+
+void DCCEXProtocol::disableThrottleLatency() {
+  if (_ownsLatencyEntries && _latencyEntries) {
+    delete[] _latencyEntries;
+    MemoryStats::addBufferBytes(MemoryTelemetry, -(long)(sizeof(ThrottleLatencyEntry) * _latencyEntryCount));
+  }
+  _latencyEntries = nullptr;
+  _latencyEntryCount = 0;
+  _ownsLatencyEntries = false;
+  resetThrottleLatency();
+}
+
+LatencyHistogram *DCCEXProtocol::getThrottleLatency(int address) {
+  if (!_latencyEntries)
+    return nullptr;
+
+  if (address == 0)
+    return &_throttleLatency;
+
+  for (int index = 0; index < _latencyEntryCount; index++) {
+    if (_latencyEntries[index].address == address)
+      return &_latencyEntries[index].histogram;
+  }
+  return nullptr;
+}
+
+unsigned long DCCEXProtocol::getThrottleLatencyUntracked() { return _latencyUntracked; }
+
+void DCCEXProtocol::resetThrottleLatency() {
+  for (int index = 0; index < _latencyEntryCount; index++) {
+    _latencyEntries[index].address = 0;
+    _latencyEntries[index].awaiting = false;
+    _latencyEntries[index].histogram.reset();
+  }
+  _throttleLatency.reset();
+  _latencyUntracked = 0;
+}
+
 // Private methods
 // Protocol and server methods
 
@@ -767,7 +1714,16 @@ void DCCEXProtocol::_init() {
 
 void DCCEXProtocol::_sendCommand() {
   if (_stream) {
+#ifdef DCCEX_THREADED
+    // pollStream() writes the command on the I/O thread
+    if (_threaded) {
+      _outboundQueue.push(_outboundCommand);
+    } else {
+      _stream->print(_outboundCommand);
+    }
+#else
     _stream->print(_outboundCommand);
+#endif
     if (_debug) {
       _console->print("==> ");
       _console->println(_outboundCommand);
@@ -777,6 +1733,20 @@ void DCCEXProtocol::_sendCommand() {
   }
 }
 
+void DCCEXProtocol::_parseCommandBuffer() {
+  if (DCCEXInbound::parse(_cmdBuffer)) {
+    // Process stuff here
+    if (_debug) {
+      _console->print("<== ");
+      _console->println(_cmdBuffer);
+    }
+    _processCommand();
+  }
+  // Clear buffer after use
+  _cmdBuffer[0] = 0;
+  _bufflen = 0;
+}
+
 void DCCEXProtocol::_processCommand() {
   // last Response time
   _lastServerResponseTime = millis();
@@ -821,6 +1791,11 @@ void DCCEXProtocol::_processCommand() {
   case 'l': // Loco/cab broadcast
     if (DCCEXInbound::isTextParameter(0) || DCCEXInbound::getParameterCount() != 4)
       break;
+    // Drop uninteresting addresses before any other work is done
+    if (_locoInterestFilter && !isLocoInterest(DCCEXInbound::getNumber(0))) {
+      _filteredLocoBroadcasts++;
+      break;
+    }
     _processLocoBroadcast();
     break;
 
@@ -960,19 +1935,19 @@ void DCCEXProtocol::_processServerDescription() { //<iDCCEX version / microproce
 
   _receivedVersion = true;
 
-  if (_delegate)
+  if (_wants(EventServerVersion))
     _delegate->receivedServerVersion(_version[0], _version[1], _version[2]);
 }
 
 void DCCEXProtocol::_processMessage() { //<m "message">
-  if (!_delegate)
+  if (!_wants(EventMessage))
     return;
 
   _delegate->receivedMessage(DCCEXInbound::getTextParameter(0));
 }
 
 void DCCEXProtocol::_processScreenUpdate() { //<@ screen row "message">
-  if (!_delegate)
+  if (!_wants(EventScreenUpdate))
     return;
 
   _delegate->receivedScreenUpdate(DCCEXInbound::getNumber(0), DCCEXInbound::getNumber(1),
@@ -986,8 +1961,78 @@ void DCCEXProtocol::_sendHeartbeat() {
   }
 }
 
+// Event dispatch methods
+
+void DCCEXProtocol::_updateEventMask() {
+  // While queueing, events are recorded and dispatched to the delegate and observers when processed
+  if (_eventQueue.isEnabled()) {
+    _delegate = &_eventRecorder;
+    _eventMask = _queueEventMask;
+  } else {
+    _delegate = &_observers;
+    _eventMask = _observers.getMask();
+  }
+#ifdef DCCEX_STATIC_HANDLER
+  // The handler is called directly alongside the delegate, so decoding covers the event types either receives
+  _delegate.setDelegateMask(_eventMask);
+  if (_delegate.hasHandler())
+    _eventMask |= DCCEXStaticDispatch::handlerMask;
+#endif
+}
+
+// Arena methods
+
+void DCCEXProtocol::_registerArena(ArenaList list, ListArena *arena) {
+  switch (list) {
+  case ArenaRoster:
+    Loco::setArena(arena);
+    break;
+  case ArenaTurnouts:
+    Turnout::setArena(arena);
+    break;
+  case ArenaRoutes:
+    Route::setArena(arena);
+    break;
+  case ArenaTurntables:
+    Turntable::setArena(arena);
+    break;
+  default:
+    break;
+  }
+}
+
+void DCCEXProtocol::_refreshArenaList(ArenaList list) {
+  switch (list) {
+  case ArenaRoster:
+    refreshRoster();
+    break;
+  case ArenaTurnouts:
+    refreshTurnoutList();
+    break;
+  case ArenaRoutes:
+    refreshRouteList();
+    break;
+  case ArenaTurntables:
+    refreshTurntableList();
+    break;
+  default:
+    break;
+  }
+}
+
 // Consist/loco methods
 
+void DCCEXProtocol::_releaseLocoInterest() {
+#ifndef DCCEX_STATIC_MEMORY
+  if (_ownsLocoInterest && _locoInterest) {
+    delete[] _locoInterest;
+    MemoryStats::addBufferBytes(MemoryLocoState, -(long)LOCO_INTEREST_BYTES);
+  }
+#endif
+  _locoInterest = nullptr;
+  _ownsLocoInterest = false;
+}
+
 void DCCEXProtocol::_processLocoBroadcast() { //<l cab reg speedByte functMap>
   int address = DCCEXInbound::getNumber(0);
   int speedByte = DCCEXInbound::getNumber(2);
@@ -1000,14 +2045,58 @@ void DCCEXProtocol::_processLocoBroadcast() { //<l cab reg speedByte functMap>
     return;
 
   // Iterate through locos to update the appropriate one, send speedByte to cater for EStop
-  _updateLocos(Loco::getFirst(), address, speedByte, direction, functionMap);
-  _updateLocos(Loco::getFirstLocalLoco(), address, speedByte, direction, functionMap);
+  _updateLocos(address, speedByte, direction, functionMap);
+
+  // Hold the latest state for the next delivery when coalescing
+  if (_coalesceLocoBroadcasts) {
+    _queueLocoBroadcast(address, speed, direction, functionMap);
+    return;
+  }
 
   // Send a broadcast as well in case it's a local Loco not in the roster
-  if (_delegate)
+  if (_wants(EventLocoBroadcast))
     _delegate->receivedLocoBroadcast(address, speed, direction, functionMap);
 }
 
+void DCCEXProtocol::_queueLocoBroadcast(int address, int speed, Direction direction, int functionMap) {
+  int index = 0;
+  while (index < _coalescedLocoCount && _coalescedLocos[index].address != address) {
+    index++;
+  }
+
+  if (index < _coalescedLocoCount) {
+    _mergedLocoBroadcasts++;
+  } else {
+    // Deliver early to make room if every slot is in use
+    if (_coalescedLocoCount == COALESCED_LOCO_SLOTS)
+      _deliverLocoBroadcasts();
+    index = _coalescedLocoCount++;
+    _coalescedLocos[index].address = address;
+    _coalescedLocos[index].mergedCount = 0;
+  }
+
+  CoalescedLocoBroadcast *broadcast = &_coalescedLocos[index];
+  broadcast->speed = speed;
+  broadcast->direction = direction;
+  broadcast->functionMap = functionMap;
+  broadcast->mergedCount++;
+}
+
+void DCCEXProtocol::_deliverLocoBroadcasts() {
+  for (int index = 0; index < _coalescedLocoCount; index++) {
+    CoalescedLocoBroadcast *broadcast = &_coalescedLocos[index];
+    for (int slot = LocoStateTable::findAddress(broadcast->address); _wants(EventLocoUpdate) && slot >= 0;
+         slot = LocoStateTable::findAddress(broadcast->address, slot + 1)) {
+      _delegate->receivedLocoUpdate(LocoStateTable::getLoco(slot));
+    }
+    if (_wants(EventLocoBroadcast))
+      _delegate->receivedCoalescedLocoBroadcast(broadcast->address, broadcast->speed, broadcast->direction,
+                                                broadcast->functionMap, broadcast->mergedCount);
+  }
+  _coalescedLocoCount = 0;
+  _lastCoalescedDelivery = millis();
+}
+
 int DCCEXProtocol::_getValidFunctionMap(int functionMap) {
   // Mask off anything above 29 bits/28 functions
   if (functionMap > 0x1FFFFFFF) {
@@ -1028,51 +2117,108 @@ int DCCEXProtocol::_getSpeedFromSpeedByte(int speedByte) {
 
 Direction DCCEXProtocol::_getDirectionFromSpeedByte(int speedByte) { return (speedByte >= 128) ? Forward : Reverse; }
 
-void DCCEXProtocol::_setLocos(Loco *firstLoco) {
-  for (Loco *loco = firstLoco; loco; loco = loco->getNext()) {
-    if (!loco->getUserChangePending())
-      continue;
-
+void DCCEXProtocol::_setLocos() {
+  // Only the pending flags in the state table are scanned, Loco objects are touched only when a change is sent
+  for (int slot = LocoStateTable::findUserChangePending(); slot >= 0;
+       slot = LocoStateTable::findUserChangePending(slot + 1)) {
+    Loco *loco = LocoStateTable::getLoco(slot);
     loco->resetUserChangePending();
     _sendThreeParams('t', loco->getAddress(), loco->getUserSpeed(), loco->getUserDirection());
+    if (_latencyEntries)
+      _sentThrottleLatency(loco->getAddress(), loco->getUserSpeed(), loco->getUserDirection());
   }
 }
 
-void DCCEXProtocol::_updateLocos(Loco *firstLoco, int address, int speedByte, Direction direction, int functionMap) {
+void DCCEXProtocol::_updateLocos(int address, int speedByte, Direction direction, int functionMap) {
   bool eStop = (speedByte == 1 || speedByte == 129) ? true : false;
   int speed = _getSpeedFromSpeedByte(speedByte);
-  for (Loco *loco = firstLoco; loco; loco = loco->getNext()) {
-    if (loco->getAddress() == address) {
-      loco->setSpeed(speed);
-      loco->setDirection(direction);
-      loco->setFunctionStates(functionMap);
-      if (loco->getUserChangePending()) {
-        if (eStop) {
-          loco->resetUserChangePending();
-          loco->setUserSpeed(speed);
-        } else if (speed == loco->getUserSpeed() && direction == loco->getUserDirection()) {
-          loco->resetUserChangePending();
-        }
+  if (_latencyEntries)
+    _matchThrottleLatency(address, speed, direction, eStop);
+  for (int slot = LocoStateTable::findAddress(address); slot >= 0;
+       slot = LocoStateTable::findAddress(address, slot + 1)) {
+    Loco *loco = LocoStateTable::getLoco(slot);
+    loco->setSpeed(speed);
+    loco->setDirection(direction);
+    loco->setFunctionStates(functionMap);
+    if (loco->getUserChangePending()) {
+      if (eStop) {
+        loco->resetUserChangePending();
+        loco->setUserSpeed(speed);
+      } else if (speed == loco->getUserSpeed() && direction == loco->getUserDirection()) {
+        loco->resetUserChangePending();
       }
-      if (_delegate)
-        _delegate->receivedLocoUpdate(loco);
     }
+    // Coalesced updates are notified when delivered
+    if (_wants(EventLocoUpdate) && !_coalesceLocoBroadcasts)
+      _delegate->receivedLocoUpdate(loco);
   }
 }
 
-void DCCEXProtocol::_processReadResponse() { // <r id> - -1 = error
-  if (!_delegate)
+void DCCEXProtocol::_updateLocoFunction(int address, int function, bool state) {
+  // Functions reported in broadcasts are updated when the broadcast is received
+  if (function < BROADCAST_FUNCTIONS || function >= MAX_FUNCTIONS)
     return;
+  for (int slot = LocoStateTable::findAddress(address); slot >= 0;
+       slot = LocoStateTable::findAddress(address, slot + 1)) {
+    Loco *loco = LocoStateTable::getLoco(slot);
+    loco->setFunctionState(function, state);
+    if (_wants(EventLocoUpdate))
+      _delegate->receivedLocoUpdate(loco);
+  }
+}
 
+void DCCEXProtocol::_processReadResponse() { // <r id> - -1 = error
   int address = DCCEXInbound::getNumber(0);
-  _delegate->receivedReadLoco(address);
+  _matchCVOperation(CVOpReadLoco, 0, 0, address);
+  if (_wants(EventReadLoco))
+    _delegate->receivedReadLoco(address);
 }
 
 void DCCEXProtocol::_processPendingUserChanges() {
   if (millis() - _lastUserChange > _userChangeDelay) {
     _lastUserChange = millis();
-    _setLocos(Loco::getFirst());
-    _setLocos(Loco::getFirstLocalLoco());
+    _setLocos();
+  }
+}
+
+void DCCEXProtocol::_sentThrottleLatency(int address, int speed, Direction direction) {
+  ThrottleLatencyEntry *entry = nullptr;
+  for (int index = 0; index < _latencyEntryCount; index++) {
+    if (_latencyEntries[index].address == address) {
+      entry = &_latencyEntries[index];
+      break;
+    }
+    if (_latencyEntries[index].address == 0 && entry == nullptr)
+      entry = &_latencyEntries[index];
+  }
+  if (entry == nullptr) {
+    _latencyUntracked++;
+    return;
+  }
+
+  // A newer command replaces one still waiting, as only the latest will be confirmed
+  entry->address = address;
+  entry->awaiting = true;
+  entry->speed = speed;
+  entry->direction = direction;
+  entry->sentAt = millis();
+}
+
+void DCCEXProtocol::_matchThrottleLatency(int address, int speed, Direction direction, bool eStop) {
+  for (int index = 0; index < _latencyEntryCount; index++) {
+    ThrottleLatencyEntry *entry = &_latencyEntries[index];
+    if (entry->address != address || !entry->awaiting)
+      continue;
+
+    unsigned long elapsed = millis() - entry->sentAt;
+    if (elapsed > THROTTLE_LATENCY_TIMEOUT) {
+      entry->awaiting = false;
+    } else if (eStop || (speed == entry->speed && direction == entry->direction)) {
+      entry->awaiting = false;
+      entry->histogram.add(elapsed);
+      _throttleLatency.add(elapsed);
+    }
+    return;
   }
 }
 
@@ -1095,9 +2241,11 @@ void DCCEXProtocol::_processCSConsist() { // <^ leadLoco [-]address [-]address>
     csConsist->removeAllMembers();
   } else {
     csConsist = new CSConsist();
+    if (csConsist == nullptr)
+      return;
   }
   _buildCSConsist(csConsist, locoCount);
-  if (_delegate)
+  if (_wants(EventCSConsist))
     _delegate->receivedCSConsist(leadLoco, csConsist);
 }
 
@@ -1141,6 +2289,34 @@ void DCCEXProtocol::_sendDeleteCSConsist(CSConsist *csConsist) {
 void DCCEXProtocol::_setCSConsistMemberFunction(CSConsistMember *member, int function, bool state) {
   for (member = member; member; member = member->next) {
     _sendThreeParams('F', member->address, function, state);
+    _updateLocoFunction(member->address, function, state);
+  }
+}
+
+Loco *DCCEXProtocol::_getLocalLoco(int address) {
+  Loco *loco = Loco::getByAddress(address);
+  if (loco) {
+    LocoStateTable::markUsed(loco->getStateSlot());
+    return loco;
+  }
+
+  // Make room for the new Loco before creating it
+  if (_localLocoCacheSize > 0)
+    _evictLocalLocos(_localLocoCacheSize - 1);
+
+  loco = new Loco(address, LocoSource::LocoSourceEntry);
+  if (loco)
+    LocoStateTable::setCached(loco->getStateSlot(), true);
+  return loco;
+}
+
+void DCCEXProtocol::_evictLocalLocos(int keep) {
+  while (LocoStateTable::getCachedCount() > keep) {
+    int slot = LocoStateTable::findLeastRecentlyUsedCached();
+    if (slot < 0)
+      return;
+    delete LocoStateTable::getLoco(slot);
+    _localLocoEvictions++;
   }
 }
 
@@ -1163,9 +2339,10 @@ void DCCEXProtocol::_processRosterList() {
   }
   for (int i = 1; i < DCCEXInbound::getParameterCount(); i++) {
     int address = DCCEXInbound::getNumber(i);
-    new Loco(address, LocoSourceRoster);
+    ListArena::create<Loco>(Loco::getArena(), address, LocoSourceRoster);
   }
-  _requestRosterEntry(Loco::getFirst()->getAddress());
+  if (Loco::getFirst())
+    _requestRosterEntry(Loco::getFirst()->getAddress());
   _rosterCount = DCCEXInbound::getParameterCount() - 1;
 }
 
@@ -1174,8 +2351,8 @@ void DCCEXProtocol::_requestRosterEntry(int address) { _sendTwoParams('J', 'R',
 void DCCEXProtocol::_processRosterEntry() { //<jR id ""|"desc" ""|"funct1/funct2/funct3/...">
   // find the roster entry to update
   int address = DCCEXInbound::getNumber(1);
-  char *name = DCCEXInbound::copyTextParameter(2);
-  char *funcs = DCCEXInbound::copyTextParameter(3);
+  const char *name = DCCEXInbound::getTextParameter(2);
+  const char *funcs = DCCEXInbound::getTextParameter(3);
   bool missingRosters = false;
 
   Loco *loco = roster->getByAddress(address);
@@ -1190,12 +2367,9 @@ void DCCEXProtocol::_processRosterEntry() { //<jR id ""|"desc" ""|"funct1/funct2
 
   if (!missingRosters) {
     _receivedRoster = true;
-    if (_delegate)
+    if (_wants(EventRosterList))
       _delegate->receivedRosterList();
   }
-
-  free(name);
-  free(funcs);
 }
 
 // Turnout methods
@@ -1218,7 +2392,7 @@ void DCCEXProtocol::_processTurnoutList() {
   }
   for (int i = 1; i < DCCEXInbound::getParameterCount(); i++) {
     auto id = DCCEXInbound::getNumber(i);
-    new Turnout(id, false);
+    ListArena::create<Turnout>(Turnout::getArena(), (int)id, false);
   }
   _requestTurnoutEntry(Turnout::getFirst()->getId());
   _turnoutCount = DCCEXInbound::getParameterCount() - 1;
@@ -1232,7 +2406,7 @@ void DCCEXProtocol::_processTurnoutEntry() {
   // find the turnout entry to update
   int id = DCCEXInbound::getNumber(1);
   bool thrown = (DCCEXInbound::getNumber(2) == 'T');
-  char *name = DCCEXInbound::copyTextParameter(3);
+  const char *name = DCCEXInbound::getTextParameter(3);
   bool missingTurnouts = false;
 
   Turnout *t = Turnout::getById(id);
@@ -1245,19 +2419,14 @@ void DCCEXProtocol::_processTurnoutEntry() {
     }
   }
 
-  free(name);
-
   if (!missingTurnouts) {
     _receivedTurnoutList = true;
-    if (_delegate)
+    if (_wants(EventTurnoutList))
       _delegate->receivedTurnoutList();
   }
 }
 
 void DCCEXProtocol::_processTurnoutBroadcast() { //<H id state>
-  if (!_delegate)
-    return;
-
   if (DCCEXInbound::getParameterCount() != 2)
     return;
   // find the Turnout entry to update
@@ -1266,7 +2435,8 @@ void DCCEXProtocol::_processTurnoutBroadcast() { //<H id state>
   for (auto t = Turnout::getFirst(); t; t = t->getNext()) {
     if (t->getId() == id) {
       t->setThrown(thrown);
-      _delegate->receivedTurnoutAction(id, thrown);
+      if (_wants(EventTurnoutAction))
+        _delegate->receivedTurnoutAction(id, thrown);
     }
   }
 }
@@ -1290,7 +2460,7 @@ void DCCEXProtocol::_processRouteList() {
   }
   for (int i = 1; i < DCCEXInbound::getParameterCount(); i++) {
     int id = DCCEXInbound::getNumber(i);
-    new Route(id);
+    ListArena::create<Route>(Route::getArena(), id);
   }
   _requestRouteEntry(Route::getFirst()->getId());
   _routeCount = DCCEXInbound::getParameterCount() - 1;
@@ -1302,7 +2472,7 @@ void DCCEXProtocol::_processRouteEntry() {
   // find the Route entry to update
   int id = DCCEXInbound::getNumber(1);
   RouteType type = (RouteType)DCCEXInbound::getNumber(2);
-  char *name = DCCEXInbound::copyTextParameter(3);
+  const char *name = DCCEXInbound::getTextParameter(3);
   bool missingRoutes = false;
 
   Route *r = Route::getById(id);
@@ -1315,11 +2485,9 @@ void DCCEXProtocol::_processRouteEntry() {
     }
   }
 
-  free(name);
-
   if (!missingRoutes) {
     _receivedRouteList = true;
-    if (_delegate)
+    if (_wants(EventRouteList))
       _delegate->receivedRouteList();
   }
 }
@@ -1343,10 +2511,12 @@ void DCCEXProtocol::_processTurntableList() { // <jO [id1 id2 id3 ...]>
   }
   for (int i = 1; i < DCCEXInbound::getParameterCount(); i++) {
     int id = DCCEXInbound::getNumber(i);
-    new Turntable(id);
+    ListArena::create<Turntable>(Turntable::getArena(), id);
   }
   _requestTurntableEntry(Turntable::getFirst()->getId());
   _turntableCount = DCCEXInbound::getParameterCount() - 1;
+  _outstandingTurntables = _turntableCount;
+  _outstandingTurntableIndexes = 0;
 }
 
 void DCCEXProtocol::_requestTurntableEntry(int id) { _sendTwoParams('J', 'O', id); }
@@ -1357,10 +2527,16 @@ void DCCEXProtocol::_processTurntableEntry() { // <jO id type position position_
   TurntableType ttType = (TurntableType)DCCEXInbound::getNumber(2);
   int index = DCCEXInbound::getNumber(3);
   int indexCount = DCCEXInbound::getNumber(4);
-  char *name = DCCEXInbound::copyTextParameter(5);
+  const char *name = DCCEXInbound::getTextParameter(5);
 
   Turntable *tt = Turntable::getById(id);
   if (tt) {
+    // First entry for this turntable, expect its indexes and reserve space for them in one block
+    if (tt->getName() == nullptr) {
+      _outstandingTurntables--;
+      _outstandingTurntableIndexes += indexCount;
+      tt->reserveIndexes(indexCount);
+    }
     tt->setType(ttType);
     tt->setIndex(index);
     tt->setNumberOfIndexes(indexCount);
@@ -1370,8 +2546,6 @@ void DCCEXProtocol::_processTurntableEntry() { // <jO id type position position_
       _requestTurntableEntry(tt->getNext()->getId());
     }
   }
-
-  free(name);
 }
 
 void DCCEXProtocol::_requestTurntableIndexEntry(int id) { _sendTwoParams('J', 'P', id); }
@@ -1384,33 +2558,23 @@ void DCCEXProtocol::_processTurntableIndexEntry() { // <jP id index angle "[desc
   int ttId = DCCEXInbound::getNumber(1);
   int index = DCCEXInbound::getNumber(2);
   int angle = DCCEXInbound::getNumber(3);
-  char *parsedName = DCCEXInbound::copyTextParameter(4);
+  const char *parsedName = DCCEXInbound::getTextParameter(4);
   const char *name = (index == 0) ? "Home" : parsedName;
 
   Turntable *tt = getTurntableById(ttId);
   if (tt) {
     if (tt->getNumberOfIndexes() != tt->getIndexCount()) {
-      TurntableIndex *newIndex = new TurntableIndex(ttId, index, angle, name);
-      tt->addIndex(newIndex);
-    }
-
-    bool receivedAll = true;
-
-    for (Turntable *tt = turntables->getFirst(); tt; tt = tt->getNext()) {
-      int numIndexes = tt->getNumberOfIndexes();
-      int indexCount = tt->getIndexCount();
-      if (tt->getName() == nullptr || (numIndexes != indexCount))
-        receivedAll = false;
+      tt->addIndex(index, angle, name);
+      _outstandingTurntableIndexes--;
     }
 
-    if (receivedAll) {
+    // All received once every turntable entry and every expected index has arrived
+    if (_outstandingTurntables <= 0 && _outstandingTurntableIndexes <= 0) {
       _receivedTurntableList = true;
-      if (_delegate)
+      if (_wants(EventTurntableList))
         _delegate->receivedTurntableList();
     }
   }
-
-  free(parsedName);
 }
 
 void DCCEXProtocol::_processTurntableBroadcast() { // <I id position moving>
@@ -1422,16 +2586,13 @@ void DCCEXProtocol::_processTurntableBroadcast() { // <I id position moving>
     tt->setIndex(newIndex);
     tt->setMoving(moving);
   }
-  if (_delegate)
+  if (_wants(EventTurntableAction))
     _delegate->receivedTurntableAction(id, newIndex, moving);
 }
 
 // Track management methods
 
 void DCCEXProtocol::_processTrackPower() {
-  if (!_delegate)
-    return;
-
   TrackPower state = PowerUnknown;
   if (DCCEXInbound::getNumber(0) == PowerOff) {
     state = PowerOff;
@@ -1439,20 +2600,47 @@ void DCCEXProtocol::_processTrackPower() {
     state = PowerOn;
   }
 
+  // Update the cached power of every track this applies to, even with no subscribers. Tracks whose mode is not
+  // known may or may not be included in MAIN, PROG, or JOIN, so their power becomes unknown rather than stale
+  if (DCCEXInbound::getParameterCount() == 2) {
+    int _track = DCCEXInbound::getNumber(1);
+    uint8_t modeUnknown = ~(_trackModeMasks[MAIN] | _trackModeMasks[PROG] | _trackModeMasks[DC] |
+                            _trackModeMasks[DCX] | _trackModeMasks[NONE]);
+    if (_track >= 'A' && _track < 'A' + TRACK_COUNT) {
+      _setTrackPower(1 << (_track - 'A'), state);
+    } else if (_track == 2698315) { // MAIN
+      _setTrackPower(_trackModeMasks[MAIN], state);
+      _setTrackPower(modeUnknown, PowerUnknown);
+    } else if (_track == 2788330) { // PROG
+      _setTrackPower(_trackModeMasks[PROG], state);
+      _setTrackPower(modeUnknown, PowerUnknown);
+    } else if (_track == 2721762) { // JOIN
+      _setTrackPower(_trackModeMasks[MAIN] | _trackModeMasks[PROG], state);
+      _setTrackPower(modeUnknown, PowerUnknown);
+    } else {
+      _setTrackPower(0xFF, PowerUnknown);
+    }
+  } else {
+    _setTrackPower(0xFF, state);
+  }
+
+  if (!_wants(EventTrackPower) && !_wants(EventIndividualTrackPower))
+    return;
+
   if (DCCEXInbound::getParameterCount() == 2) {
     int _track = DCCEXInbound::getNumber(1);
-    _delegate->receivedIndividualTrackPower(state, _track);
+    if (_wants(EventIndividualTrackPower))
+      _delegate->receivedIndividualTrackPower(state, _track);
 
     if (DCCEXInbound::getNumber(1) != 2698315) {
       return;
     } // not equal "MAIN"
   }
-  _delegate->receivedTrackPower(state);
+  if (_wants(EventTrackPower))
+    _delegate->receivedTrackPower(state);
 }
 
 void DCCEXProtocol::_processTrackType() {
-  if (!_delegate)
-    return;
   char _track = DCCEXInbound::getNumber(0);
   int _type = DCCEXInbound::getNumber(1);
   TrackManagerMode _trackType;
@@ -1479,83 +2667,389 @@ void DCCEXProtocol::_processTrackType() {
   if (DCCEXInbound::getParameterCount() > 2)
     _address = DCCEXInbound::getNumber(2);
 
-  _delegate->receivedTrackType(_track, _trackType, _address);
+  if (_track >= 'A' && _track < 'A' + TRACK_COUNT) {
+    int index = _track - 'A';
+    _tracks[index].modeKnown = true;
+    _tracks[index].mode = _trackType;
+    _tracks[index].address = _address;
+    for (int mode = 0; mode < TRACK_MODE_COUNT; mode++) {
+      _trackModeMasks[mode] &= ~(1 << index);
+    }
+    _trackModeMasks[_trackType] |= 1 << index;
+  }
+
+  if (_wants(EventTrackType))
+    _delegate->receivedTrackType(_track, _trackType, _address);
 }
 
 void DCCEXProtocol::_processTrackCurrentGauges() { // <jG a b ...>
-  if (!_delegate)
-    return;
-
   int trackCount = DCCEXInbound::getParameterCount();
   for (int track = 1; track < trackCount; track++) { // First param is G, rest are tracks
-    _delegate->receivedTrackCurrentGauge('A' + track - 1, DCCEXInbound::getNumber(track));
+    if (track <= TRACK_COUNT)
+      _tracks[track - 1].gauge = DCCEXInbound::getNumber(track);
+    if (_wants(EventTrackCurrentGauge))
+      _delegate->receivedTrackCurrentGauge('A' + track - 1, DCCEXInbound::getNumber(track));
   }
 }
 
 void DCCEXProtocol::_processTrackCurrents() { // <jI a b ...>
-  if (!_delegate)
-    return;
-
   int trackCount = DCCEXInbound::getParameterCount();
   for (int track = 1; track < trackCount; track++) { // First param is I, rest are tracks
-    _delegate->receivedTrackCurrent('A' + track - 1, DCCEXInbound::getNumber(track));
+    if (track <= TRACK_COUNT)
+      _addTrackCurrent(track - 1, DCCEXInbound::getNumber(track));
+    if (_wants(EventTrackCurrent))
+      _delegate->receivedTrackCurrent('A' + track - 1, DCCEXInbound::getNumber(track));
   }
 }
 
-// CV programming methods
+void DCCEXProtocol::_addTrackCurrent(int track, int current) {
+  _tracks[track].current = current;
+  if (!_currentPolling)
+    return;
 
-void DCCEXProtocol::_processValidateCVResponse() { // <v cv value>, value -1 = error
-  if (!_delegate)
+  _currentHistory[track].add(current);
+
+  int gauge = _tracks[track].gauge;
+  if (_currentThreshold <= 0 || !_currentThresholdCallback || gauge <= 0)
+    return;
+
+  // Only crossings are reported, so a track sitting above the threshold is reported once
+  int percent = (long)current * 100 / gauge;
+  uint8_t bit = 1 << track;
+  bool above = percent >= _currentThreshold;
+  if (above == ((_currentAboveMask & bit) != 0))
     return;
 
+  if (above) {
+    _currentAboveMask |= bit;
+  } else {
+    _currentAboveMask &= ~bit;
+  }
+  _currentThresholdCallback('A' + track, current, percent, above, _currentThresholdContext);
+}
+
+void DCCEXProtocol::_setTrackPower(uint8_t mask, TrackPower state) {
+  for (int track = 0; track < TRACK_COUNT; track++) {
+    if (mask & (1 << track))
+      _tracks[track].power = state;
+  }
+  if (state == PowerOn) {
+    _trackPowerMask |= mask;
+  } else {
+    _trackPowerMask &= ~mask;
+  }
+}
+
+// CV programming methods
+
+void DCCEXProtocol::_processValidateCVResponse() { // <v cv value>, value -1 = error
   int cv = DCCEXInbound::getNumber(0);
   int value = DCCEXInbound::getNumber(1);
-  _delegate->receivedValidateCV(cv, value);
+  _matchCVOperation(CVOpValidateCV, cv, 0, value);
+  if (_wants(EventValidateCV))
+    _delegate->receivedValidateCV(cv, value);
 }
 
 void DCCEXProtocol::_processValidateCVBitResponse() { // <v cv bit value>, value -1 = error
-  if (!_delegate)
-    return;
-
   int cv = DCCEXInbound::getNumber(0);
   int bit = DCCEXInbound::getNumber(1);
   int value = DCCEXInbound::getNumber(2);
-  _delegate->receivedValidateCVBit(cv, bit, value);
+  _matchCVOperation(CVOpValidateCVBit, cv, bit, value);
+  if (_wants(EventValidateCVBit))
+    _delegate->receivedValidateCVBit(cv, bit, value);
 }
 
 void DCCEXProtocol::_processWriteLocoResponse() { // <w id> - -1 = error
-  if (!_delegate)
-    return;
-
   int value = DCCEXInbound::getNumber(0);
-  _delegate->receivedWriteLoco(value);
+  _matchCVOperation(CVOpWriteLocoAddress, 0, 0, value);
+  if (_wants(EventWriteLoco))
+    _delegate->receivedWriteLoco(value);
 }
 
 void DCCEXProtocol::_processWriteCVResponse() { // <r cv value>, value -1 = error
-  if (!_delegate)
-    return;
-
   int cv = DCCEXInbound::getNumber(0);
   int value = DCCEXInbound::getNumber(1);
-  _delegate->receivedWriteCV(cv, value);
+  _matchCVOperation(CVOpWriteCV, cv, 0, value);
+  if (_wants(EventWriteCV))
+    _delegate->receivedWriteCV(cv, value);
+}
+
+void DCCEXProtocol::_processPOMBatch() {
+  if (millis() - _lastPOMWrite < _pomInterval)
+    return;
+
+  _lastPOMWrite = millis();
+  const POMWrite &write = _pomWrites[_pomWritten++];
+  if (write.bit >= 0) {
+    writeCVBitOnMain(write.address, write.cv, write.bit, write.value);
+  } else {
+    writeCVOnMain(write.address, write.cv, write.value);
+  }
+  if (_pomWritten == _pomCount)
+    _endPOMBatch();
+}
+
+void DCCEXProtocol::_endPOMBatch() {
+  // Clear the batch before the callback, so the callback may start another
+  POMBatchCallback callback = _pomCallback;
+  void *context = _pomContext;
+  _pomWrites = nullptr;
+  _pomCallback = nullptr;
+  _pomContext = nullptr;
+  if (callback)
+    callback(_pomWritten, context);
+}
+
+int DCCEXProtocol::_queueCVOperation(CVOperationType type, int cv, int bit, int value, CVOperationCallback callback,
+                                     void *context) {
+  if (_cvOperationCount == MAX_PENDING_CV_OPERATIONS)
+    return -1;
+
+  int index = (_cvOperationHead + _cvOperationCount) % MAX_PENDING_CV_OPERATIONS;
+  _cvOperationCount++;
+  PendingCVOperation &pending = _cvOperations[index];
+  pending.operation.id = _nextCVOperationId;
+  pending.operation.type = type;
+  pending.operation.cv = cv;
+  pending.operation.bit = bit;
+  pending.operation.value = value;
+  pending.operation.result = CVResultPending;
+  pending.operation.attempts = 0;
+  pending.operation.latency = 0;
+  pending.callback = callback;
+  pending.context = context;
+  pending.sent = false;
+  pending.sentAt = 0;
+  pending.bitsReceived = 0;
+  pending.bits = 0;
+  pending.bitFailed = false;
+
+  // Identifiers stay positive with 16 bit ints so -1 is never returned for a queued operation
+  _nextCVOperationId = (_nextCVOperationId + 1) & 0x7FFF;
+
+  _processCVOperations();
+  return pending.operation.id;
+}
+
+void DCCEXProtocol::_sendCVOperation(PendingCVOperation &pending) {
+  CVOperation &operation = pending.operation;
+  switch (operation.type) {
+  case CVOpReadLoco:
+    readLoco();
+    break;
+  case CVOpReadCV:
+    readCV(operation.cv);
+    break;
+  case CVOpValidateCV:
+    validateCV(operation.cv, operation.value);
+    break;
+  case CVOpValidateCVBit:
+    validateCVBit(operation.cv, operation.bit, operation.value);
+    break;
+  case CVOpWriteLocoAddress:
+    writeLocoAddress(operation.cv);
+    break;
+  case CVOpWriteCV:
+    writeCV(operation.cv, operation.value);
+    break;
+  case CVOpFastReadCV:
+    // Every bit check is sent back to back, their responses identify the bit
+    for (int bit = 0; bit < 8; bit++) {
+      validateCVBit(operation.cv, bit, 0);
+    }
+    pending.bitsReceived = 0;
+    pending.bits = 0;
+    pending.bitFailed = false;
+    break;
+  }
+  operation.attempts++;
+  pending.sent = true;
+  pending.sentAt = millis();
+}
+
+void DCCEXProtocol::_processCVOperations() {
+  if (_cvOperationCount == 0)
+    return;
+
+  PendingCVOperation &pending = _cvOperations[_cvOperationHead];
+  if (!pending.sent) {
+    _sendCVOperation(pending);
+  } else if (millis() - pending.sentAt >= _cvOperationTimeout) {
+    // The command station answers in order, so responses still due to the timed out attempt arrive before any to the
+    // retry or the next operation, and are counted to be ignored
+    _staleCVResponses += _responsesDue(pending);
+    _retryOrCompleteCVOperation(CVResultTimeout, pending.operation.value);
+  }
+}
+
+void DCCEXProtocol::_matchCVOperation(CVOperationType type, int cv, int bit, int value) {
+  if (_staleCVResponses > 0) {
+    _staleCVResponses--;
+    return;
+  }
+  if (_cvOperationCount == 0)
+    return;
+
+  // Only the oldest operation is ever sent, so a response can only be for it
+  PendingCVOperation &pending = _cvOperations[_cvOperationHead];
+  CVOperation &operation = pending.operation;
+  if (!pending.sent)
+    return;
+
+  switch (type) {
+  case CVOpReadLoco:
+  case CVOpWriteLocoAddress:
+    // Responses carry the address rather than anything identifying the request
+    if (operation.type != type)
+      return;
+    break;
+  case CVOpReadCV:
+  case CVOpValidateCV:
+    if (operation.type == CVOpFastReadCV && operation.cv == cv) {
+      if (pending.bitsReceived != 0xFF)
+        return;
+      break;
+    }
+    if ((operation.type != CVOpReadCV && operation.type != CVOpValidateCV) || operation.cv != cv)
+      return;
+    break;
+  case CVOpValidateCVBit:
+    if (operation.type == CVOpFastReadCV && operation.cv == cv && bit >= 0 && bit < 8) {
+      // Any further bit response is ignored once the byte is being confirmed
+      if (pending.bitsReceived == 0xFF)
+        return;
+      pending.bitsReceived |= 1 << bit;
+      if (value == -1) {
+        pending.bitFailed = true;
+      } else if (value) {
+        pending.bits |= 1 << bit;
+      }
+      // Wait for every bit to respond, so a retry never has responses to the previous attempt still in flight
+      if (pending.bitsReceived != 0xFF)
+        return;
+      if (pending.bitFailed) {
+        _retryOrCompleteCVOperation(CVResultFailed, -1);
+        return;
+      }
+      // Confirm the assembled byte once every bit has a response
+      validateCV(operation.cv, pending.bits);
+      return;
+    }
+    if (operation.type != type || operation.cv != cv || operation.bit != bit)
+      return;
+    break;
+  case CVOpWriteCV:
+    if (operation.type != type || operation.cv != cv)
+      return;
+    break;
+  default:
+    return;
+  }
+
+  _retryOrCompleteCVOperation(value == -1 ? CVResultFailed : CVResultSuccess, value);
+}
+
+int DCCEXProtocol::_responsesDue(const PendingCVOperation &pending) {
+  // Every other operation completes or is retried on its one response, so it is still due
+  if (pending.operation.type != CVOpFastReadCV)
+    return 1;
+
+  // Every bit check has responded, so only the confirmation is due, unless a failed bit means it was never sent
+  if (pending.bitsReceived == 0xFF)
+    return pending.bitFailed ? 0 : 1;
+
+  int outstanding = 0;
+  for (int bit = 0; bit < 8; bit++) {
+    if (!(pending.bitsReceived & (1 << bit)))
+      outstanding++;
+  }
+  return outstanding;
+}
+
+void DCCEXProtocol::_retryOrCompleteCVOperation(CVResult result, int value) {
+  PendingCVOperation &pending = _cvOperations[_cvOperationHead];
+  if (result != CVResultSuccess && pending.operation.attempts <= _cvOperationRetries) {
+    _cvOperationStats.retries++;
+    _sendCVOperation(pending);
+    return;
+  }
+
+  // Remove the operation before the callback, so the callback may request further operations
+  CVOperation operation = pending.operation;
+  operation.result = result;
+  if (result == CVResultTimeout) {
+    _cvOperationStats.timedOut++;
+  } else {
+    if (result == CVResultSuccess) {
+      _cvOperationStats.succeeded++;
+    } else {
+      _cvOperationStats.failed++;
+    }
+    operation.value = value;
+    operation.latency = millis() - pending.sentAt;
+    _cvOperationStats.totalLatency += operation.latency;
+    if (operation.latency > _cvOperationStats.maxLatency)
+      _cvOperationStats.maxLatency = operation.latency;
+  }
+  CVOperationCallback callback = pending.callback;
+  void *context = pending.context;
+  _cvOperationHead = (_cvOperationHead + 1) % MAX_PENDING_CV_OPERATIONS;
+  _cvOperationCount--;
+
+  if (callback)
+    callback(operation, context);
+  _processCVOperations();
 }
 
 // Fast clock methods
 
 void DCCEXProtocol::_processSetFastClock() { // <jC minutes speed>
-  if (!_delegate)
+  _anchorFastClock(DCCEXInbound::getNumber(1), DCCEXInbound::getNumber(2));
+
+  if (!_wants(EventSetFastClock))
     return;
 
   _delegate->receivedSetFastClock(DCCEXInbound::getNumber(1), DCCEXInbound::getNumber(2));
 }
 
 void DCCEXProtocol::_processFastClockTime() { // <jC minutes>
-  if (!_delegate)
+  _anchorFastClock(DCCEXInbound::getNumber(1), 0);
+
+  if (!_wants(EventFastClockTime))
     return;
 
   _delegate->receivedFastClockTime(DCCEXInbound::getNumber(1));
 }
 
+void DCCEXProtocol::_anchorFastClock(int minutes, int speedFactor) {
+  if (minutes < 0 || minutes > 1440)
+    return;
+
+  minutes %= 1440;
+  bool speedChanged = speedFactor > 0 && speedFactor != _fastClockSpeed;
+  _fastClockDrift = 0;
+  if (_fastClockKnown) {
+    // Take the shorter way round midnight
+    int drift = minutes - getFastClockMinutes();
+    if (drift > 720) {
+      drift -= 1440;
+    } else if (drift < -720) {
+      drift += 1440;
+    }
+    _fastClockDrift = drift;
+
+    // Keep the anchor, and the position within the minute, while the local clock agrees
+    if (drift == 0 && !speedChanged)
+      return;
+  }
+
+  _fastClockKnown = true;
+  _fastClockMinutes = minutes;
+  _fastClockAnchor = millis();
+  if (speedChanged)
+    _fastClockSpeed = speedFactor;
+}
+
 // Helper methods to build the outbound command
 
 void DCCEXProtocol::_cmdStart(char opcode) {
@@ -38,16 +38,26 @@ Version information: MOVED TO DCCEXProtocolVersion.h
 #ifndef DCCEXPROTOCOL_H
 #define DCCEXPROTOCOL_H
 
+#include "DCCEXArena.h"
 #include "DCCEXCSConsist.h"
+#include "DCCEXCommandQueue.h"
+#include "DCCEXCurrentHistory.h"
+#include "DCCEXEvents.h"
 #include "DCCEXInbound.h"
+#include "DCCEXLatency.h"
 #include "DCCEXLoco.h"
+#include "DCCEXMemory.h"
 #include "DCCEXProtocolVersion.h"
 #include "DCCEXRoutes.h"
 #include "DCCEXTurnouts.h"
 #include "DCCEXTurntables.h"
 #include <Arduino.h>
 
-const int MAX_OUTBOUND_COMMAND_LENGTH = 100; // Max number of bytes for outbound commands
+const int MAX_OUTBOUND_COMMAND_LENGTH = 100;                   // Max number of bytes for outbound commands
+const int MAX_LOCO_ADDRESS = 10239;                             // Highest valid DCC Loco address
+const int LOCO_INTEREST_BYTES = (MAX_LOCO_ADDRESS + 1 + 7) / 8; // Bytes in the Loco address interest bitmap
+const int COALESCED_LOCO_SLOTS = 8;                             // Max Loco addresses held between coalesced deliveries
+const int MAX_PENDING_CV_OPERATIONS = 8;                        // Max tracked CV operations waiting for a response
 
 // Valid track power state values
 enum TrackPower {
@@ -65,12 +75,156 @@ enum TrackManagerMode {
   NONE, // Track is unused
 };
 
+const int TRACK_COUNT = 8;      // Number of TrackManager tracks, A - H
+const int TRACK_MODE_COUNT = 5; // Number of TrackManagerMode values
+
+/// @brief Cached state of one TrackManager track
+struct TrackState {
+  bool modeKnown;        // Flag that the mode has been received
+  TrackManagerMode mode; // Track mode, only valid if modeKnown
+  int address;           // DC address for DC and DCX modes
+  TrackPower power;      // Power state, PowerUnknown until received
+  int current;           // Latest current, -1 until received
+  int gauge;             // Current limit, -1 until received
+};
+
+/// @brief Rolling current statistics for one track, from the samples held in its history
+struct TrackCurrentStats {
+  int samples;        // Number of samples held
+  int latest;         // Most recent current, -1 if no samples
+  int min;            // Smallest current held, -1 if no samples
+  int max;            // Largest current held, -1 if no samples
+  int mean;           // Mean current held, -1 if no samples
+  int gauge;          // Current limit, -1 until received
+  int percentOfGauge; // Latest current as a percentage of the limit, -1 if either is unknown
+};
+
+/// @brief Function called when a track's current crosses the threshold set by setTrackCurrentThreshold()
+typedef void (*TrackCurrentThresholdCallback)(char track, int current, int percentOfGauge, bool above, void *context);
+
+/// @brief Function called from check() when the local fast clock moves to a new minute
+typedef void (*FastClockTickCallback)(int minutes, void *context);
+
+const unsigned long THROTTLE_LATENCY_TIMEOUT = 5000; // Time in ms after which an unacknowledged throttle is not timed
+
+/// @brief Round trip times of throttle commands for one Loco address
+struct ThrottleLatencyEntry {
+  int address;                // DCC address, 0 if the entry is unused
+  bool awaiting;              // Flag that a throttle command has been sent and not yet acknowledged
+  int speed;                  // Speed sent
+  Direction direction;        // Direction sent
+  unsigned long sentAt;       // Time in ms the command was sent
+  LatencyHistogram histogram; // Round trip times for this address
+};
+
 // Valid Momentum algorithms - MUST MATCH lookup table in setMomentumAlgorithm()
 enum MomentumAlgorithm {
   Linear, // Linear acceleration
   Power,  // Speed difference
 };
 
+// Object lists that can be allocated from a ListArena
+enum ArenaList {
+  ArenaRoster,     // Roster Loco objects, names, and function labels
+  ArenaTurnouts,   // Turnout objects and names
+  ArenaRoutes,     // Route objects and names
+  ArenaTurntables, // Turntable and TurntableIndex objects and names
+};
+
+const int ARENA_LIST_COUNT = 4; // Number of lists in ArenaList
+
+/// @brief Latest state from the Loco broadcasts received for one address since the last coalesced delivery
+struct CoalescedLocoBroadcast {
+  int address;         // DCC address of the Loco
+  int speed;           // Latest speed
+  Direction direction; // Latest direction
+  int functionMap;     // Latest function map
+  int mergedCount;     // Number of broadcasts merged into this one
+};
+
+/// @brief Types of tracked CV programming operation, and the response each expects
+enum CVOperationType {
+  CVOpReadLoco,         // readLoco(), response <r address>
+  CVOpReadCV,           // readCV(), response <v cv value>
+  CVOpValidateCV,       // validateCV(), response <v cv value>
+  CVOpValidateCVBit,    // validateCVBit(), response <v cv bit value>
+  CVOpWriteLocoAddress, // writeLocoAddress(), response <w address>
+  CVOpWriteCV,          // writeCV(), response <r cv value>
+  CVOpFastReadCV,       // readCVFast(), responses <v cv bit value> for each bit in any order, then <v cv value>
+};
+
+/// @brief Outcome of a tracked CV programming operation
+enum CVResult {
+  CVResultPending, // Waiting to be sent or for a response
+  CVResultSuccess, // Response received with a value
+  CVResultFailed,  // Response received with value -1 on the last attempt
+  CVResultTimeout, // No response to the last attempt
+};
+
+/// @brief A tracked CV programming operation, as passed to its completion callback
+struct CVOperation {
+  int id;                // Identifier returned when the operation was requested
+  CVOperationType type;  // Type of operation
+  int cv;                // CV number, or the address for CVOpWriteLocoAddress
+  int bit;               // Bit number for CVOpValidateCVBit
+  int value;             // Value requested, replaced by the value received (-1 if failed)
+  CVResult result;       // Outcome of the operation
+  int attempts;          // Number of times the command was sent
+  unsigned long latency; // Time in ms from the last send to the response, 0 if timed out
+};
+
+/// @brief Function called once when a tracked CV programming operation completes
+typedef void (*CVOperationCallback)(const CVOperation &operation, void *context);
+
+/// @brief Counts and response times of tracked CV programming operations
+struct CVOperationStats {
+  unsigned long succeeded;    // Operations completed with a value
+  unsigned long failed;       // Operations completed with value -1
+  unsigned long timedOut;     // Operations completed with no response
+  unsigned long retries;      // Commands sent again after a failure or timeout
+  unsigned long maxLatency;   // Longest time in ms from a send to its response
+  unsigned long totalLatency; // Sum of the times in ms from a send to its response, divide by succeeded + failed
+};
+
+/// @brief Entry in the table of tracked CV programming operations
+struct PendingCVOperation {
+  CVOperation operation;        // Operation details and outcome
+  CVOperationCallback callback; // Function called on completion, may be nullptr
+  void *context;                // Passed to the callback
+  bool sent;                    // Flag that the current attempt has been sent
+  unsigned long sentAt;         // Time in ms the current attempt was sent
+  uint8_t bitsReceived;         // For CVOpFastReadCV, mask of the bits with a response
+  uint8_t bits;                 // For CVOpFastReadCV, value assembled from the bit responses
+  bool bitFailed;               // For CVOpFastReadCV, flag that a bit response had value -1
+};
+
+/// @brief One programming on main write in a batch
+struct POMWrite {
+  int address; // DCC address of the Loco
+  int cv;      // CV number to write to
+  int bit;     // Bit of the CV to write (0 - 7), or -1 to write the whole CV
+  int value;   // Value to write, 0 or 1 when writing a bit
+};
+
+/// @brief Function called once when a batch of programming on main writes ends
+typedef void (*POMBatchCallback)(int written, void *context);
+
+#ifdef DCCEX_STATIC_MEMORY
+/// @brief Static pools objects and names are allocated from with DCCEX_STATIC_MEMORY defined
+enum StaticPoolId {
+  StaticPoolLocos,            // Loco objects
+  StaticPoolTurnouts,         // Turnout objects
+  StaticPoolRoutes,           // Route objects
+  StaticPoolTurntables,       // Turntable objects
+  StaticPoolTurntableIndexes, // TurntableIndex objects
+  StaticPoolCSConsists,       // CSConsist objects
+  StaticPoolCSConsistMembers, // CSConsistMember objects
+  StaticPoolNames,            // Names and function labels, in bytes
+};
+
+const int STATIC_POOL_COUNT = 8; // Number of pools in StaticPoolId
+#endif
+
 /// @brief Nullstream class for initial DCCEXProtocol instantiation to direct streams to nothing
 class NullStream : public Stream {
 public:
@@ -140,6 +294,20 @@ public:
   /// @param functionMap Function map
   virtual void receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) {}
 
+  /**
+   * @brief Notify when the latest of one or more Loco broadcasts is delivered with broadcast coalescing enabled
+   * @details The default implementation calls receivedLocoBroadcast() so existing delegates work unchanged.
+   * @param address DCC address of the loco
+   * @param speed Latest speed as derived from the speed byte
+   * @param direction Latest direction as derived from the speed byte
+   * @param functionMap Latest function map
+   * @param mergedCount Number of broadcasts received for this address since the last delivery (1 or more)
+   */
+  virtual void receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap,
+                                              int mergedCount) {
+    receivedLocoBroadcast(address, speed, direction, functionMap);
+  }
+
   /// @brief Notify when the global track power state change is received
   /// @param state Power state received (PowerOff|PowerOn|PowerUnknown)
   virtual void receivedTrackPower(TrackPower state) {}
@@ -234,6 +402,230 @@ public:
   virtual ~DCCEXProtocolDelegate() = default;
 };
 
+/**
+ * @brief Delegate that records every callback as an event in a DCCEXEventQueue instead of handling it
+ * @details Used by DCCEXProtocol when the event queue is enabled, dispatch() later replays a recorded event to any
+ * delegate.
+ */
+class DCCEXEventRecorder : public DCCEXProtocolDelegate {
+public:
+  /**
+   * @brief Construct a new DCCEXEventRecorder object
+   * @param queue Queue to record events in
+   */
+  DCCEXEventRecorder(DCCEXEventQueue *queue);
+
+  void receivedServerVersion(int major, int minor, int patch) override;
+  void receivedMessage(const char *message) override;
+  void receivedRosterList() override;
+  void receivedTurnoutList() override;
+  void receivedRouteList() override;
+  void receivedTurntableList() override;
+  void receivedLocoUpdate(Loco *loco) override;
+  void receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) override;
+  void receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap,
+                                      int mergedCount) override;
+  void receivedTrackPower(TrackPower state) override;
+  void receivedTrackCurrentGauge(char track, int limit) override;
+  void receivedTrackCurrent(char track, int current) override;
+  void receivedIndividualTrackPower(TrackPower state, int track) override;
+  void receivedTrackType(char track, TrackManagerMode type, int address) override;
+  void receivedTurnoutAction(int turnoutId, bool thrown) override;
+  void receivedTurntableAction(int turntableId, int position, bool moving) override;
+  void receivedReadLoco(int address) override;
+  void receivedValidateCV(int cv, int value) override;
+  void receivedValidateCVBit(int cv, int bit, int value) override;
+  void receivedWriteLoco(int address) override;
+  void receivedWriteCV(int cv, int value) override;
+  void receivedScreenUpdate(int screen, int row, const char *message) override;
+  void receivedCSConsist(int leadLoco, CSConsist *csConsist) override;
+  void receivedSetFastClock(int minutes, int speedFactor) override;
+  void receivedFastClockTime(int minutes) override;
+
+  /**
+   * @brief Call the delegate method an event was recorded from
+   * @details A Loco update for a Loco deleted since it was recorded is skipped, and the CSConsist for a CSConsist
+   * event is looked up by its lead Loco again (nullptr if it has since been deleted).
+   * @param event Event to replay
+   * @param delegate Delegate to call, nothing is called if nullptr
+   */
+  static void dispatch(const DCCEXEvent &event, DCCEXProtocolDelegate *delegate);
+
+private:
+  DCCEXEventQueue *_queue;
+
+  DCCEXEvent *_record(DCCEXEventType type, int value0 = 0, int value1 = 0, int value2 = 0, int value3 = 0);
+  static Loco *_findLoco(int address, void *object);
+};
+
+/**
+ * @brief Delegate that passes each callback on to the delegate and every observer subscribed to its event type
+ * @details Observers subscribe with a mask of event types, (1UL << EventTurnoutAction) for example, while the delegate
+ * set with setDelegate() always receives every event.
+ */
+class DCCEXObserverList : public DCCEXProtocolDelegate {
+public:
+  /**
+   * @brief Construct a new, empty DCCEXObserverList object
+   */
+  DCCEXObserverList();
+
+  /**
+   * @brief Set the delegate that receives every event
+   * @param delegate Pointer to the delegate, nullptr to remove it
+   */
+  void setDelegate(DCCEXProtocolDelegate *delegate);
+
+  /**
+   * @brief Add an observer, or change the event types it is subscribed to if already added
+   * @param observer Pointer to the observer
+   * @param eventMask Bitmask of DCCEXEventType values to receive
+   * @return true If added or updated
+   * @return false If observer is nullptr or MAX_OBSERVERS have already been added
+   */
+  bool add(DCCEXProtocolDelegate *observer, uint32_t eventMask);
+
+  /**
+   * @brief Remove an observer
+   * @param observer Pointer to the observer
+   * @return true If removed
+   * @return false If the observer was not added
+   */
+  bool remove(DCCEXProtocolDelegate *observer);
+
+  /**
+   * @brief Get the event types the delegate or any observer is subscribed to
+   * @return uint32_t Bitmask of DCCEXEventType values
+   */
+  uint32_t getMask();
+
+  void receivedServerVersion(int major, int minor, int patch) override;
+  void receivedMessage(const char *message) override;
+  void receivedRosterList() override;
+  void receivedTurnoutList() override;
+  void receivedRouteList() override;
+  void receivedTurntableList() override;
+  void receivedLocoUpdate(Loco *loco) override;
+  void receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) override;
+  void receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap,
+                                      int mergedCount) override;
+  void receivedTrackPower(TrackPower state) override;
+  void receivedTrackCurrentGauge(char track, int limit) override;
+  void receivedTrackCurrent(char track, int current) override;
+  void receivedIndividualTrackPower(TrackPower state, int track) override;
+  void receivedTrackType(char track, TrackManagerMode type, int address) override;
+  void receivedTurnoutAction(int turnoutId, bool thrown) override;
+  void receivedTurntableAction(int turntableId, int position, bool moving) override;
+  void receivedReadLoco(int address) override;
+  void receivedValidateCV(int cv, int value) override;
+  void receivedValidateCVBit(int cv, int bit, int value) override;
+  void receivedWriteLoco(int address) override;
+  void receivedWriteCV(int cv, int value) override;
+  void receivedScreenUpdate(int screen, int row, const char *message) override;
+  void receivedCSConsist(int leadLoco, CSConsist *csConsist) override;
+  void receivedSetFastClock(int minutes, int speedFactor) override;
+  void receivedFastClockTime(int minutes) override;
+
+private:
+  // Entry 0 is the delegate, the rest are observers, unused entries are nullptr
+  DCCEXProtocolDelegate *_observers[MAX_OBSERVERS + 1];
+  uint32_t _masks[MAX_OBSERVERS + 1];
+
+  DCCEXProtocolDelegate *_next(DCCEXEventType type, int &index);
+};
+
+#ifdef DCCEX_STATIC_HANDLER
+/*
+ * Build with -DDCCEX_STATIC_HANDLER=<class> to have the parser call the methods of that handler class directly, with no
+ * virtual calls. The class is declared in DCCEXStaticHandler.h, which the application provides on the include path,
+ * and only needs the DCCEXProtocolDelegate methods it wants, with the same names and arguments but no base class.
+ */
+class DCCEX_STATIC_HANDLER;
+
+/**
+ * @brief Used in place of the delegate pointer when DCCEX_STATIC_HANDLER is defined
+ * @details Calls the static handler directly, then the delegate and observers (or the event recorder) through the
+ * pointer it holds if they subscribe to the event type. The methods are defined in DCCEXProtocol.cpp alongside the
+ * parser so the handler calls can be inlined, and handler methods that do not exist generate no code.
+ */
+class DCCEXStaticDispatch final {
+public:
+  /// @brief Event types the handler has methods for
+  static const uint32_t handlerMask;
+
+  /**
+   * @brief Construct a new DCCEXStaticDispatch object with no handler set
+   * @param delegate Pointer to the delegate notifications are also sent to
+   */
+  DCCEXStaticDispatch(DCCEXProtocolDelegate *delegate) : _handler(nullptr), _delegate(delegate), _delegateMask(0) {}
+
+  /**
+   * @brief Change the delegate notifications are also sent to
+   * @param delegate Pointer to the delegate
+   * @return DCCEXStaticDispatch& This object
+   */
+  DCCEXStaticDispatch &operator=(DCCEXProtocolDelegate *delegate) {
+    _delegate = delegate;
+    return *this;
+  }
+
+  /// @brief Allow call sites written for the delegate pointer to call this object instead
+  DCCEXStaticDispatch *operator->() { return this; }
+
+  /**
+   * @brief Set the handler called directly
+   * @param handler Pointer to the handler, nullptr to remove it
+   */
+  void setHandler(DCCEX_STATIC_HANDLER *handler) { _handler = handler; }
+
+  /**
+   * @brief Check if a handler is set
+   * @return true If set
+   */
+  bool hasHandler() { return _handler != nullptr; }
+
+  /**
+   * @brief Set the event types the delegate receives
+   * @param mask Bitmask of DCCEXEventType values
+   */
+  void setDelegateMask(uint32_t mask) { _delegateMask = mask; }
+
+  void receivedServerVersion(int major, int minor, int patch);
+  void receivedMessage(const char *message);
+  void receivedRosterList();
+  void receivedTurnoutList();
+  void receivedRouteList();
+  void receivedTurntableList();
+  void receivedLocoUpdate(Loco *loco);
+  void receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap);
+  void receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap, int mergedCount);
+  void receivedTrackPower(TrackPower state);
+  void receivedTrackCurrentGauge(char track, int limit);
+  void receivedTrackCurrent(char track, int current);
+  void receivedIndividualTrackPower(TrackPower state, int track);
+  void receivedTrackType(char track, TrackManagerMode type, int address);
+  void receivedTurnoutAction(int turnoutId, bool thrown);
+  void receivedTurntableAction(int turntableId, int position, bool moving);
+  void receivedReadLoco(int address);
+  void receivedValidateCV(int cv, int value);
+  void receivedValidateCVBit(int cv, int bit, int value);
+  void receivedWriteLoco(int address);
+  void receivedWriteCV(int cv, int value);
+  void receivedScreenUpdate(int screen, int row, const char *message);
+  void receivedCSConsist(int leadLoco, CSConsist *csConsist);
+  void receivedSetFastClock(int minutes, int speedFactor);
+  void receivedFastClockTime(int minutes);
+
+private:
+  DCCEX_STATIC_HANDLER *_handler;   // Handler called directly
+  DCCEXProtocolDelegate *_delegate; // Delegate and observers, or the event recorder
+  uint32_t _delegateMask;           // Event types the delegate receives
+
+  bool _handlerWants(DCCEXEventType type) { return _handler && (handlerMask & (1UL << type)); }
+  bool _delegateWants(DCCEXEventType type) { return _delegateMask & (1UL << type); }
+};
+#endif
+
 /// @brief Main class for the DCCEXProtocol library
 class DCCEXProtocol {
 public:
@@ -252,6 +644,43 @@ public:
   /// @param delegate
   void setDelegate(DCCEXProtocolDelegate *delegate);
 
+  /**
+   * @brief Add an observer that receives callbacks for the event types it subscribes to, alongside the delegate
+   * @details Up to MAX_OBSERVERS can be added. Adding an observer already added changes its subscription. Commands
+   * for event types that neither the delegate nor any observer receives are not decoded any further than needed to
+   * keep the library's own objects up to date.
+   * @param observer Pointer to the observer
+   * @param eventMask Bitmask of DCCEXEventType values, eg. (1UL << EventTurnoutAction) | (1UL << EventTrackPower)
+   * @return true If added or updated
+   * @return false If observer is nullptr or there is no room
+   */
+  bool addObserver(DCCEXProtocolDelegate *observer, uint32_t eventMask = EVENT_MASK_ALL);
+
+  /**
+   * @brief Remove an observer
+   * @param observer Pointer to the observer
+   * @return true If removed
+   * @return false If the observer was not added
+   */
+  bool removeObserver(DCCEXProtocolDelegate *observer);
+
+  /**
+   * @brief Get the event types currently dispatched, to the delegate and observers or recorded in the event queue
+   * @return uint32_t Bitmask of DCCEXEventType values
+   */
+  uint32_t getSubscribedEventMask();
+
+#ifdef DCCEX_STATIC_HANDLER
+  /**
+   * @brief Set the handler whose methods are called directly while parsing, only available when built with
+   * DCCEX_STATIC_HANDLER
+   * @details The handler receives the event types it has methods for alongside the delegate and observers. It is
+   * always called while parsing, including when the event queue is enabled.
+   * @param handler Pointer to the handler, nullptr to remove it
+   */
+  void setStaticHandler(DCCEX_STATIC_HANDLER *handler);
+#endif
+
   /// @brief Set the stream object for console output
   /// @param console
   void setLogStream(Stream *console);
@@ -269,6 +698,7 @@ public:
   void disconnect();
 
   /// @brief Check for incoming DCC-EX broadcasts/responses and parse them
+  /// @details When threading is enabled, parses the commands framed by pollStream() instead of reading the stream.
   void check();
 
   /// @brief allows sending of an arbitray command
@@ -328,8 +758,349 @@ public:
    */
   void setDebug(bool debug);
 
+  // Arena methods
+
+  /**
+   * @brief Allocate the specified object list from a single heap block rather than individual allocations
+   * @details The list is cleared first and will be requested again by getLists(). When the list is cleared, the
+   * whole block is reused in one step. If the block fills up, further objects fall back to the heap.
+   * @param list List to allocate from the arena (ArenaRoster|ArenaTurnouts|ArenaRoutes|ArenaTurntables)
+   * @param capacity Size of the block in bytes
+   * @return true If the block was allocated
+   * @return false If allocation failed, the list will use the heap
+   */
+  bool enableArena(ArenaList list, size_t capacity);
+
+  /**
+   * @brief Allocate the specified object list from a caller-provided buffer rather than individual allocations
+   * @details As for enableArena(ArenaList list, size_t capacity), but the buffer must outlive this instance or be
+   * released with disableArena() first.
+   * @param list List to allocate from the arena (ArenaRoster|ArenaTurnouts|ArenaRoutes|ArenaTurntables)
+   * @param buffer Pointer to the buffer
+   * @param size Size of the buffer in bytes
+   * @return true If the buffer is usable
+   * @return false If the buffer is invalid, the list will use the heap
+   */
+  bool enableArena(ArenaList list, void *buffer, size_t size);
+
+  /**
+   * @brief Return the specified object list to individual heap allocations
+   * @details The list is cleared first and will be requested again by getLists().
+   * @param list List to return to the heap (ArenaRoster|ArenaTurnouts|ArenaRoutes|ArenaTurntables)
+   */
+  void disableArena(ArenaList list);
+
+  /**
+   * @brief Get the bytes currently used in the arena for the specified list
+   * @param list List to check (ArenaRoster|ArenaTurnouts|ArenaRoutes|ArenaTurntables)
+   * @return size_t Bytes used, 0 if no arena is enabled
+   */
+  size_t getArenaBytesUsed(ArenaList list);
+
+  /**
+   * @brief Get the capacity of the arena for the specified list
+   * @param list List to check (ArenaRoster|ArenaTurnouts|ArenaRoutes|ArenaTurntables)
+   * @return size_t Capacity in bytes, 0 if no arena is enabled
+   */
+  size_t getArenaCapacity(ArenaList list);
+
+  /**
+   * @brief Get the number of objects/names that did not fit in the arena for the specified list and used the heap
+   * @param list List to check (ArenaRoster|ArenaTurnouts|ArenaRoutes|ArenaTurntables)
+   * @return int Count of overflowed allocations since the list was last cleared
+   */
+  int getArenaOverflowCount(ArenaList list);
+
+  // Event queue methods
+
+  /**
+   * @brief Record events in a queue allocated from the heap instead of calling the delegate as commands are parsed
+   * @details Each event holds its own copy of its arguments, including text, so it remains valid after further
+   * commands are parsed. Drain the queue with getNextEvent() or processEvents(). Any events already queued are
+   * discarded. With DCCEX_STATIC_MEMORY defined this always fails, use enableEventQueue(buffer, capacity) instead.
+   * @param capacity Number of events the queue can hold
+   * @param eventMask Bitmask of DCCEXEventType values to record, others are dropped while parsing
+   * @return true If the queue was allocated
+   * @return false If allocation failed, the delegate is still called directly
+   */
+  bool enableEventQueue(int capacity, uint32_t eventMask = EVENT_MASK_ALL);
+
+  /**
+   * @brief Record events in a queue using a caller-provided array instead of calling the delegate while parsing
+   * @param buffer Array of events, must outlive the queue
+   * @param capacity Number of events in the array
+   * @param eventMask Bitmask of DCCEXEventType values to record, others are dropped while parsing
+   * @return true If the array is usable
+   * @return false If the array is nullptr or empty, the delegate is still called directly
+   */
+  bool enableEventQueue(DCCEXEvent *buffer, int capacity, uint32_t eventMask = EVENT_MASK_ALL);
+
+  /**
+   * @brief Stop recording events, discard any still queued, and call the delegate directly again
+   */
+  void disableEventQueue();
+
+  /**
+   * @brief Check if events are being recorded in the queue
+   * @return true If queued
+   * @return false If the delegate is called directly
+   */
+  bool isEventQueueEnabled();
+
+  /**
+   * @brief Remove the oldest event from the queue
+   * @param event Event to copy the oldest event into
+   * @return true If an event was removed
+   * @return false If the queue is empty or disabled
+   */
+  bool getNextEvent(DCCEXEvent &event);
+
+  /**
+   * @brief Remove events from the queue and call the delegate and subscribed observer methods for each, oldest first
+   * @param maxEvents Maximum number of events to process, 0 (default) for every queued event
+   * @return int Number of events processed
+   */
+  int processEvents(int maxEvents = 0);
+
+  /**
+   * @brief Get the number of events waiting in the queue
+   * @return int Count of queued events
+   */
+  int getEventCount();
+
+  /**
+   * @brief Get the most events held in the queue at once since it was enabled
+   * @return int Peak count of queued events
+   */
+  int getPeakEventCount();
+
+  /**
+   * @brief Get the number of events dropped because the queue was full
+   * @return unsigned long Count of dropped events
+   */
+  unsigned long getEventOverflowCount();
+
+#ifdef DCCEX_THREADED
+  // Threaded methods
+
+  /**
+   * @brief Split stream I/O onto its own thread, using queues allocated from the heap
+   * @details Once enabled, an I/O thread calls pollStream() to write outbound commands and frame inbound ones, while
+   * the application thread calls check() and every other method. Commands pass between the two threads through
+   * lock-free single producer, single consumer queues. Call this, and connect(), before starting the I/O thread. With
+   * DCCEX_STATIC_MEMORY defined this always fails, use enableThreading(buffers) instead.
+   * @param inboundCapacity Bytes for commands waiting to be parsed, including a terminator per command
+   * @param outboundCapacity Bytes for commands waiting to be sent, including a terminator per command
+   * @return true If the queues were allocated
+   * @return false If allocation failed, check() still reads the stream directly
+   */
+  bool enableThreading(size_t inboundCapacity = 1024, size_t outboundCapacity = 512);
+
+  /**
+   * @brief Split stream I/O onto its own thread, using caller-provided buffers for the queues
+   * @param inboundBuffer Buffer for commands waiting to be parsed, must outlive the queue
+   * @param inboundCapacity Bytes in the inbound buffer
+   * @param outboundBuffer Buffer for commands waiting to be sent, must outlive the queue
+   * @param outboundCapacity Bytes in the outbound buffer
+   * @return true If the buffers are usable
+   * @return false If either buffer is nullptr or too small, check() still reads the stream directly
+   */
+  bool enableThreading(char *inboundBuffer, size_t inboundCapacity, char *outboundBuffer, size_t outboundCapacity);
+
+  /**
+   * @brief Return stream I/O to check(), discarding any queued commands
+   * @details Stop the I/O thread calling pollStream() first.
+   */
+  void disableThreading();
+
+  /**
+   * @brief Check if stream I/O is done by pollStream()
+   * @return true If threaded
+   * @return false If check() reads the stream directly
+   */
+  bool isThreadingEnabled();
+
+  /**
+   * @brief I/O thread only - write queued outbound commands to the stream, and frame inbound commands for check()
+   * @details Does nothing unless threading is enabled.
+   */
+  void pollStream();
+
+  /**
+   * @brief Get the number of inbound commands dropped because check() was not keeping up
+   * @return unsigned long Count of dropped inbound commands
+   */
+  unsigned long getInboundOverflowCount();
+
+  /**
+   * @brief Get the number of outbound commands dropped because pollStream() was not keeping up
+   * @return unsigned long Count of dropped outbound commands
+   */
+  unsigned long getOutboundOverflowCount();
+#endif
+
+  // Memory reporting methods
+
+  /**
+   * @brief Get the bytes and objects currently used by a subsystem
+   * @param subsystem Subsystem to check
+   * @return MemoryUsage Current usage, all zero if the subsystem is invalid
+   */
+  MemoryUsage getMemoryUsage(MemorySubsystem subsystem);
+
+  /**
+   * @brief Get the peak bytes and objects used by a subsystem since connect() or resetPeakMemoryUsage()
+   * @details Each field holds its own peak, so the fields may have peaked at different times.
+   * @param subsystem Subsystem to check
+   * @return MemoryUsage Peak usage, all zero if the subsystem is invalid
+   */
+  MemoryUsage getPeakMemoryUsage(MemorySubsystem subsystem);
+
+  /**
+   * @brief Get the total bytes currently used across all subsystems
+   * @details Arena blocks are not included, their capacity is available from getArenaCapacity().
+   * @return size_t Total bytes
+   */
+  size_t getTotalMemoryBytes();
+
+  /**
+   * @brief Get the peak total bytes used across all subsystems since connect() or resetPeakMemoryUsage()
+   * @return size_t Peak total bytes
+   */
+  size_t getPeakTotalMemoryBytes();
+
+  /**
+   * @brief Reset every peak to the current usage
+   */
+  void resetPeakMemoryUsage();
+
+#ifdef DCCEX_STATIC_MEMORY
+  // Static memory methods
+
+  /**
+   * @brief Get the usage of one of the static pools
+   * @param pool Pool to check
+   * @return StaticPoolStats Pool usage, all zero if the pool is invalid
+   */
+  StaticPoolStats getStaticPoolStats(StaticPoolId pool);
+
+  /**
+   * @brief Get the number of objects and names that were not created because their static pool was full
+   * @return int Count of refused allocations across all pools
+   */
+  int getStaticOverflowCount();
+#endif
+
   // Consist/Loco methods
 
+  /**
+   * @brief Add a Loco address to the set of addresses this throttle is interested in
+   * @details Unless setLocoInterestBuffer() has provided one, the first address added allocates the address interest
+   * bitmap (LOCO_INTEREST_BYTES) from the heap. With DCCEX_STATIC_MEMORY defined this fails until
+   * setLocoInterestBuffer() is called.
+   * @param address DCC address (1 - 10239)
+   * @return true If added
+   * @return false If the address is invalid or there is no bitmap
+   */
+  bool addLocoInterest(int address);
+
+  /**
+   * @brief Use a caller-provided bitmap for the set of addresses this throttle is interested in
+   * @details Any addresses already added are discarded, and a bitmap allocated by addLocoInterest() is freed.
+   * @param buffer Bitmap of at least LOCO_INTEREST_BYTES, must outlive this object
+   * @param size Bytes in the bitmap
+   * @return true If the bitmap is usable
+   * @return false If buffer is nullptr or smaller than LOCO_INTEREST_BYTES
+   */
+  bool setLocoInterestBuffer(uint8_t *buffer, size_t size);
+
+  /**
+   * @brief Remove a Loco address from the set of addresses this throttle is interested in
+   * @param address DCC address (1 - 10239)
+   */
+  void removeLocoInterest(int address);
+
+  /**
+   * @brief Remove every Loco address from the set of addresses this throttle is interested in
+   */
+  void clearLocoInterest();
+
+  /**
+   * @brief Check if a Loco address is in the set of addresses this throttle is interested in
+   * @param address DCC address (1 - 10239)
+   * @return true If interested
+   * @return false If not, or the address is invalid
+   */
+  bool isLocoInterest(int address);
+
+  /**
+   * @brief Enable or disable filtering of Loco broadcasts by address interest
+   * @details When enabled, broadcasts for addresses not added with addLocoInterest() are dropped straight after
+   * parsing, so no Loco is updated and receivedLocoBroadcast() is not called. Disabled by default.
+   * @param enabled True to only process broadcasts for addresses of interest
+   */
+  void setLocoInterestFilter(bool enabled);
+
+  /**
+   * @brief Check if Loco broadcasts are filtered by address interest
+   * @return true If filtering
+   * @return false If every broadcast is processed
+   */
+  bool getLocoInterestFilter();
+
+  /**
+   * @brief Get the number of Loco broadcasts dropped by the address interest filter
+   * @return unsigned long Count of dropped broadcasts
+   */
+  unsigned long getFilteredLocoBroadcastCount();
+
+  /**
+   * @brief Enable or disable coalescing of Loco broadcasts
+   * @details Loco state is still updated for every broadcast received, but receivedLocoUpdate() and
+   * receivedCoalescedLocoBroadcast() are called at most once per Loco per delivery with the latest state. Deliveries
+   * happen at the end of check(), or no more often than the interval if one is provided. Up to COALESCED_LOCO_SLOTS
+   * addresses are held between deliveries, a broadcast for another address delivers those held early. Disabling
+   * delivers anything held straight away.
+   * @param enabled True to coalesce Loco broadcasts
+   * @param interval Minimum time in ms between deliveries, 0 (default) to deliver at the end of every check()
+   */
+  void setLocoBroadcastCoalescing(bool enabled, unsigned long interval = 0);
+
+  /**
+   * @brief Check if Loco broadcasts are coalesced
+   * @return true If coalescing
+   * @return false If every broadcast is delivered as it is received
+   */
+  bool getLocoBroadcastCoalescing();
+
+  /**
+   * @brief Get the number of Loco broadcasts merged into a later one rather than delivered
+   * @return unsigned long Count of merged broadcasts
+   */
+  unsigned long getMergedLocoBroadcastCount();
+
+  /**
+   * @brief Limit the number of Locos the library creates itself to control CSConsist lead Locos
+   * @details When a CSConsist lead address has no roster or local Loco, the library creates a local Loco for it. With a
+   * limit set, creating another one beyond the limit first deletes the least recently used library created Loco that
+   * has no user change pending. Locos created by the application are never evicted. Any pointer to an evicted Loco
+   * obtained via Loco::getByAddress() is invalid once it is evicted. Reducing the limit evicts immediately.
+   * @param size Maximum number of library created Locos, 0 (default) for no limit
+   */
+  void setLocalLocoCacheSize(int size);
+
+  /**
+   * @brief Get the limit on library created Locos
+   * @return int Maximum number of library created Locos, 0 if there is no limit
+   */
+  int getLocalLocoCacheSize();
+
+  /**
+   * @brief Get the number of library created Locos evicted to keep within the limit
+   * @return int Count of evicted Locos
+   */
+  int getLocalLocoEvictionCount();
+
   /// @brief Set the provided loco to the specified speed and direction
   /// @param loco Pointer to a Loco object
   /// @param speed Speed (0 - 126)
@@ -354,58 +1125,60 @@ public:
   void setThrottle(CSConsist *csConsist, int speed, Direction direction);
 
   /// @brief Turn the specified function on for the provided loco
+  /// @details Functions from F29 upwards are not reported in Loco broadcasts, so their state is updated locally
   /// @param loco Pointer to a loco object
-  /// @param function Function number (0 - 27)
+  /// @param function Function number (0 to MAX_FUNCTIONS - 1)
   void functionOn(Loco *loco, int function);
 
   /// @brief DEPRECATED Turn the specified function on for the provided consist
   /// @details Will be removed in 2.0.0, use functionOn(CSConsist *csConsist, int function)
   /// @param consist Pointer to a consist object
-  /// @param function Function number (0 - 27)
+  /// @param function Function number (0 to MAX_FUNCTIONS - 1)
   void functionOn(Consist *consist, int function);
 
   /**
    * @brief Turn the specified function on for the provided CSConsist
    * @param csConsist Pointer to the CSConsist object
-   * @param function Function number (0 - 27)
+   * @param function Function number (0 to MAX_FUNCTIONS - 1)
    */
   void functionOn(CSConsist *csConsist, int function);
 
   /// @brief Turn the specified function off for the provided loco
+  /// @details Functions from F29 upwards are not reported in Loco broadcasts, so their state is updated locally
   /// @param loco Pointer to a loco object
-  /// @param function Function number (0 - 27)
+  /// @param function Function number (0 to MAX_FUNCTIONS - 1)
   void functionOff(Loco *loco, int function);
 
   /// @brief DEPRECATED Turn the specified function off for the provided consist
   /// @details Will be removed in 2.0.0, use functionOff(CSConsist *csConsist, int function)
   /// @param consist Pointer to a consist object
-  /// @param function Function number (0 - 27)
+  /// @param function Function number (0 to MAX_FUNCTIONS - 1)
   void functionOff(Consist *consist, int function);
 
   /**
    * @brief Turn the specified function off for the provided CSConsist
    * @param csConsist Pointer to the CSConsist object
-   * @param function Function number (0 - 27)
+   * @param function Function number (0 to MAX_FUNCTIONS - 1)
    */
   void functionOff(CSConsist *csConsist, int function);
 
   /// @brief Test if the specified function for the provided loco is on
   /// @param loco Pointer to a loco object
-  /// @param function Function number to test (0 - 27)
+  /// @param function Function number to test (0 to MAX_FUNCTIONS - 1)
   /// @return true = on, false = off
   bool isFunctionOn(Loco *loco, int function);
 
   /// @brief DEPRECATED Test if the specified function for the provided consist is on (Checks first loco)
   /// @details Will be removed in 2.0.0, use isFunctionOn(CSConsist *csConsist, int function)
   /// @param consist Pointer to a consist object
-  /// @param function Function number to test (0 - 27)
+  /// @param function Function number to test (0 to MAX_FUNCTIONS - 1)
   /// @return true = on, false = off
   bool isFunctionOn(Consist *consist, int function);
 
   /**
    * @brief Test if the specified function for the provided CSConsist is on (checks first Loco)
    * @param csConsist Pointer to the CSConsist object
-   * @param function Function number to test (0 - 27)
+   * @param function Function number to test (0 to MAX_FUNCTIONS - 1)
    * @return true Function on
    * @return false Function off, or CSConsist object is invalid
    */
@@ -709,6 +1482,97 @@ public:
    */
   void requestTrackCurrents();
 
+  /**
+   * @brief Request the type of every track, which also updates the cached track state
+   */
+  void requestTrackTypes();
+
+  /**
+   * @brief Get the cached state of a track
+   * @details The cache is updated from power, track type, current gauge, and current responses and broadcasts.
+   * powerTrackOn(), powerTrackOff(), and setTrackType() are not sent if the cached state already matches.
+   * @param track Track name (A - H)
+   * @return TrackState Cached state, all unknown if the track is invalid
+   */
+  TrackState getTrackState(char track);
+
+  /**
+   * @brief Get the cached power state of a track
+   * @param track Track name (A - H)
+   * @return TrackPower Power state, PowerUnknown if not received or the track is invalid
+   */
+  TrackPower getTrackPower(char track);
+
+  /**
+   * @brief Get the tracks known to be powered on
+   * @return uint8_t Bitmask with bit 0 for track A through bit 7 for track H
+   */
+  uint8_t getTrackPowerMask();
+
+  /**
+   * @brief Get the tracks known to be in a mode
+   * @param mode Track mode
+   * @return uint8_t Bitmask with bit 0 for track A through bit 7 for track H
+   */
+  uint8_t getTrackModeMask(TrackManagerMode mode);
+
+  /**
+   * @brief Forget the cached state of every track, so the next commands are always sent
+   */
+  void clearTrackStates();
+
+  /**
+   * @brief Poll track currents from check(), keeping a history for each track allocated from the heap
+   * @details Every period check() sends requestTrackCurrents(), and each track's current is added to its history,
+   * whether it was polled or requested by the application. The current limits are requested once when enabled, so
+   * percentages of them are available. With DCCEX_STATIC_MEMORY defined this always fails, use
+   * enableTrackCurrentPolling(period, samples, buffer) instead.
+   * @param period Time in ms between polls
+   * @param samples Number of samples kept for each track
+   * @return true If the histories were allocated
+   * @return false If allocation failed, nothing is polled
+   */
+  bool enableTrackCurrentPolling(unsigned long period = 1000, int samples = 16);
+
+  /**
+   * @brief Poll track currents from check(), keeping a history for each track in a caller-provided buffer
+   * @param period Time in ms between polls
+   * @param samples Number of samples kept for each track
+   * @param buffer Buffer for TRACK_COUNT * samples values, must outlive polling
+   * @return true If the buffer is usable
+   * @return false If the buffer is nullptr or samples is not positive, nothing is polled
+   */
+  bool enableTrackCurrentPolling(unsigned long period, int samples, int *buffer);
+
+  /**
+   * @brief Stop polling track currents and discard the histories
+   */
+  void disableTrackCurrentPolling();
+
+  /**
+   * @brief Check if track currents are being polled
+   * @return true If polling
+   * @return false If not
+   */
+  bool isTrackCurrentPollingEnabled();
+
+  /**
+   * @brief Get the rolling current statistics for a track
+   * @param track Track name (A - H)
+   * @return TrackCurrentStats Statistics, with no samples if not polling or the track is invalid
+   */
+  TrackCurrentStats getTrackCurrentStats(char track);
+
+  /**
+   * @brief Call a function when any track's current crosses a percentage of its current limit
+   * @details The function is called once when the current rises to or above the threshold, and once when it falls back
+   * below it. Tracks with no known current limit are ignored.
+   * @param percent Threshold as a percentage of the current limit, 0 to disable
+   * @param callback Function to call
+   * @param context Passed to the function unchanged
+   */
+  void setTrackCurrentThreshold(int percent, TrackCurrentThresholdCallback callback, void *context = nullptr);
+
   // DCC accessory methods
 
   /// @brief Activate DCC accessory at the specified address and subaddress
@@ -779,6 +1643,161 @@ public:
   /// @param value Value to write (0|1)
   void writeCVBitOnMain(int address, int cv, int bit, int value);
 
+  // Batched programming on main methods
+
+  /**
+   * @brief Send a list of programming on main writes, paced so the command station is not overrun
+   * @details One write is sent by check() every interval, so throttle and other commands are still sent between them.
+   * Only one batch runs at a time.
+   * @param writes Array of writes, must remain valid until the batch ends
+   * @param count Number of writes in the array
+   * @param interval Optional - minimum time in ms between writes (default 50)
+   * @param callback Optional - function called once with the number of writes sent when the batch ends
+   * @param context Optional - passed to the callback
+   * @return true If the batch started
+   * @return false If the array is nullptr or empty, or a batch is already running
+   */
+  bool writeCVsOnMain(const POMWrite *writes, int count, unsigned long interval = 50,
+                      POMBatchCallback callback = nullptr, void *context = nullptr);
+
+  /**
+   * @brief Stop sending the current batch of programming on main writes, its callback is called with the number sent
+   */
+  void cancelPOMBatch();
+
+  /**
+   * @brief Check if a batch of programming on main writes is being sent
+   * @return true If running
+   * @return false If not
+   */
+  bool isPOMBatchRunning();
+
+  /**
+   * @brief Get the number of writes sent from the current or last batch
+   * @return int Count of writes sent
+   */
+  int getPOMBatchWritten();
+
+  // Tracked CV programming methods
+
+  /**
+   * @brief Read the Loco address from the programming track, tracking the response
+   * @details Tracked operations are sent one at a time in the order requested, each once the previous one completes,
+   * so every response is matched to its request. Avoid untracked CV programming while any are pending. Delegate
+   * methods are still called for each response.
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int readLoco(CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Read the value of the provided CV from the Loco on the programming track, tracking the response
+   * @param cv CV number to read the value of
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int readCV(int cv, CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Read the value of the provided CV by checking each of its bits, tracking the responses
+   * @details All eight bit checks are sent at once, rather than waiting for each response, and the byte assembled
+   * from their responses is then confirmed with one validateCV(). If any bit check fails, the whole read is retried
+   * once all eight have responded. The completed operation holds the confirmed value. Whether this is faster than
+   * readCV() depends on the decoder and command station.
+   * @param cv CV number to read the value of
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int readCVFast(int cv, CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Validate the provided value is stored in the provided CV, tracking the response
+   * @param cv CV number to validate the value of
+   * @param value Value to validate
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int validateCV(int cv, int value, CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Validate the provided bit is set to the specified value for the provided CV, tracking the response
+   * @param cv CV number to validate the bit of
+   * @param bit Bit for the CV to validate
+   * @param value Value to validate (0|1)
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int validateCVBit(int cv, int bit, int value, CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Write Loco address to the Loco on the programming track, tracking the response
+   * @param address DCC address to write
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int writeLocoAddress(int address, CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Write the provided value to the specified CV on the programming track, tracking the response
+   * @param cv CV number to write to
+   * @param value Value to write to the CV
+   * @param callback Function called once when the operation completes, may be nullptr
+   * @param context Optional - passed to the callback
+   * @return int Operation identifier, or -1 if MAX_PENDING_CV_OPERATIONS are already pending
+   */
+  int writeCV(int cv, int value, CVOperationCallback callback, void *context = nullptr);
+
+  /**
+   * @brief Set how long tracked operations wait for a response, and how often they are retried
+   * @param timeout Time in ms to wait for each response (default 5000)
+   * @param retries Optional - times to send a command again after a timeout or a -1 response (default 0)
+   */
+  void setCVOperationTimeout(unsigned long timeout, int retries = 0);
+
+  /**
+   * @brief Get the time tracked operations wait for each response
+   * @return unsigned long Timeout in ms
+   */
+  unsigned long getCVOperationTimeout();
+
+  /**
+   * @brief Get the number of times tracked operations are retried
+   * @return int Count of retries
+   */
+  int getCVOperationRetries();
+
+  /**
+   * @brief Get the number of tracked operations waiting to be sent or for a response
+   * @return int Count of pending operations
+   */
+  int getPendingCVOperationCount();
+
+  /**
+   * @brief Cancel the tracked operations requested with the provided context, without calling their callbacks
+   * @details An operation already sent stays pending without its callback until its response arrives or it times out,
+   * so that response is not matched to the next operation. Call this before the context is destroyed.
+   * @param context Context passed when the operations were requested, nothing is cancelled for nullptr
+   * @return int Number of operations cancelled
+   */
+  int cancelCVOperations(void *context);
+
+  /**
+   * @brief Get the counts and response times of completed tracked operations
+   * @return CVOperationStats Statistics since resetCVOperationStats() was last called
+   */
+  CVOperationStats getCVOperationStats();
+
+  /**
+   * @brief Reset the counts and response times of completed tracked operations
+   */
+  void resetCVOperationStats();
+
   // Fast clock methods
 
   /**
@@ -793,6 +1812,81 @@ public:
    */
   void requestFastClockTime();
 
+  /**
+   * @brief Get the fast clock time, kept locally without asking the command station
+   * @details The clock is anchored against millis() each time the command station sends the time, and advanced at the
+   * speed factor it last sent. If a new time differs from the local clock, the clock is moved to it.
+   * @return int Time from midnight in minutes, -1 if no time has been received
+   */
+  int getFastClockMinutes();
+
+  /**
+   * @brief Get the fast clock speed factor last sent by the command station
+   * @return int Speed factor, 0 if not received and the local clock does not advance
+   */
+  int getFastClockSpeed();
+
+  /**
+   * @brief Get how far the local fast clock was from the last time received
+   * @return int Minutes the received time was ahead of the local clock, negative if behind
+   */
+  int getFastClockDrift();
+
+  /**
+   * @brief Call a function from check() each time the local fast clock moves to a new minute
+   * @details If check() is not called for more than a fast minute, the function is called once with the latest minute.
+   * @param callback Function to call, nullptr to stop
+   * @param context Passed to the function unchanged
+   */
+  void setFastClockTickCallback(FastClockTickCallback callback, void *context = nullptr);
+
+  // Throttle latency methods
+
+  /**
+   * @brief Time how long each throttle command takes to be acknowledged, using entries allocated from the heap
+   * @details Each speed or direction change sent with <t> is timed until a Loco broadcast confirms it, or an
+   * emergency stop overrides it. Times are kept in a histogram for each address and one for all of them. An address
+   * takes an entry when its first command is sent, and once all entries are in use further addresses are counted by
+   * getThrottleLatencyUntracked() but not timed. With DCCEX_STATIC_MEMORY defined this always fails, use
+   * enableThrottleLatency(entries, count) instead.
+   * @param locos Number of Loco addresses to time
+   * @return true If the entries were allocated
+   * @return false If allocation failed, nothing is timed
+   */
+  bool enableThrottleLatency(int locos = 4);
+
+  /**
+   * @brief Time how long each throttle command takes to be acknowledged, using caller-provided entries
+   * @param entries Array of entries, must outlive timing
+   * @param count Number of entries in the array
+   * @return true If the entries are usable
+   * @return false If entries is nullptr or count is not positive, nothing is timed
+   */
+  bool enableThrottleLatency(ThrottleLatencyEntry *entries, int count);
+
+  /**
+   * @brief Stop timing throttle commands and discard all times
+   */
+  void disableThrottleLatency();
+
+  /**
+   * @brief Get the round trip times of throttle commands
+   * @param address DCC address of the Loco, or 0 for all addresses
+   * @return LatencyHistogram* Pointer to the histogram, nullptr if not timing or the address has no entry
+   */
+  LatencyHistogram *getThrottleLatency(int address = 0);
+
+  /**
+   * @brief Get the number of throttle commands not timed because every entry was in use
+   * @return unsigned long Count of commands
+   */
+  unsigned long getThrottleLatencyUntracked();
+
+  /**
+   * @brief Discard all times and free every entry for new addresses
+   */
+  void resetThrottleLatency();
+
   // Attributes
 
   /// @brief Linked list of Loco objects to form the roster, call roster->getFirst()
@@ -818,26 +1912,43 @@ private:
   // Protocol and server methods
   void _init();
   void _sendCommand();
+  void _parseCommandBuffer();
   void _processCommand();
   void _processServerDescription();
   void _processMessage();
   void _processScreenUpdate();
   void _sendHeartbeat();
 
+  // Event dispatch methods
+  void _updateEventMask();
+  bool _wants(DCCEXEventType type) { return _eventMask & (1UL << type); }
+
+  // Arena methods
+  void _registerArena(ArenaList list, ListArena *arena);
+  void _refreshArenaList(ArenaList list);
+
   // Consist/loco methods
+  void _releaseLocoInterest();
   void _processLocoBroadcast();
+  void _queueLocoBroadcast(int address, int speed, Direction direction, int functionMap);
+  void _deliverLocoBroadcasts();
   int _getValidFunctionMap(int functionMap);
   int _getSpeedFromSpeedByte(int speedByte);
   Direction _getDirectionFromSpeedByte(int speedByte);
-  void _setLocos(Loco *firstLoco);
-  void _updateLocos(Loco *firstLoco, int address, int speedByte, Direction direction, int functionMap);
+  void _setLocos();
+  void _updateLocos(int address, int speedByte, Direction direction, int functionMap);
+  void _updateLocoFunction(int address, int function, bool state);
   void _processReadResponse();
   void _processPendingUserChanges();
+  void _sentThrottleLatency(int address, int speed, Direction direction);
+  void _matchThrottleLatency(int address, int speed, Direction direction, bool eStop);
   void _processCSConsist();
   void _buildCSConsist(CSConsist *csConsist, int memberCount);
   void _sendCreateCSConsist(CSConsist *csConsist);
   void _sendDeleteCSConsist(CSConsist *csConsist);
   void _setCSConsistMemberFunction(CSConsistMember *member, int function, bool state);
+  Loco *_getLocalLoco(int address);
+  void _evictLocalLocos(int keep);
 
   // Roster methods
   void _getRoster();
@@ -875,6 +1986,8 @@ private:
   void _processTrackPower();
   void _processTrackType();
   void _processTrackCurrentGauges();
+  void _setTrackPower(uint8_t mask, TrackPower state);
+  void _addTrackCurrent(int track, int current);
   void _processTrackCurrents();
 
   // CV programming methods
@@ -882,25 +1995,110 @@ private:
   void _processValidateCVBitResponse();
   void _processWriteLocoResponse();
   void _processWriteCVResponse();
+  void _processPOMBatch();
+  void _endPOMBatch();
+  int _queueCVOperation(CVOperationType type, int cv, int bit, int value, CVOperationCallback callback,
+                        void *context);
+  void _sendCVOperation(PendingCVOperation &pending);
+  void _processCVOperations();
+  void _matchCVOperation(CVOperationType type, int cv, int bit, int value);
+  void _retryOrCompleteCVOperation(CVResult result, int value);
+  static int _responsesDue(const PendingCVOperation &pending);
 
   // Fast clock methods
   void _processSetFastClock();
   void _processFastClockTime();
+  void _anchorFastClock(int minutes, int speedFactor);
 
   // Attributes
   int _rosterCount = 0;                               // Count of roster items received
   int _turnoutCount = 0;                              // Count of turnout objects received
   int _routeCount = 0;                                // Count of route objects received
   int _turntableCount = 0;                            // Count of turntable objects received
+  int _outstandingTurntables = 0;                     // Count of turntable entries not yet received
+  int _outstandingTurntableIndexes = 0;               // Count of turntable index entries not yet received
   int _version[3] = {};                               // EX-CommandStation version x.y.z
+  int _localLocoCacheSize = 0;                        // Max library created Locos, 0 for no limit
+  int _localLocoEvictions = 0;                        // Count of library created Locos evicted
+  uint8_t *_locoInterest = nullptr;                   // Bitmap of Loco addresses of interest
+  bool _ownsLocoInterest = false;                     // Flag that the bitmap was allocated from the heap
+  bool _locoInterestFilter = false;                   // Flag to drop broadcasts for addresses not of interest
+  unsigned long _filteredLocoBroadcasts = 0;          // Count of broadcasts dropped by the interest filter
+  bool _coalesceLocoBroadcasts = false;               // Flag to coalesce Loco broadcasts between deliveries
+  unsigned long _coalesceInterval = 0;                // Minimum time in ms between coalesced deliveries
+  unsigned long _lastCoalescedDelivery = 0;           // Time in ms of the last coalesced delivery
+  unsigned long _mergedLocoBroadcasts = 0;            // Count of broadcasts merged into a later one
+  int _coalescedLocoCount = 0;                        // Count of addresses held for the next delivery
+  // Latest state of each address held for the next coalesced delivery
+  CoalescedLocoBroadcast _coalescedLocos[COALESCED_LOCO_SLOTS];
+  const POMWrite *_pomWrites = nullptr;               // Batch of programming on main writes being sent
+  int _pomCount = 0;                                  // Number of writes in the batch
+  int _pomWritten = 0;                                // Number of writes sent from the batch
+  unsigned long _pomInterval = 0;                     // Minimum time in ms between writes
+  unsigned long _lastPOMWrite = 0;                    // Time in ms of the last write
+  POMBatchCallback _pomCallback = nullptr;            // Function called when the batch ends
+  void *_pomContext = nullptr;                        // Passed to the batch callback
+  TrackState _tracks[TRACK_COUNT];                    // Cached state of each track
+  uint8_t _trackPowerMask = 0;                        // Tracks known to be powered on, bit 0 for A
+  uint8_t _trackModeMasks[TRACK_MODE_COUNT] = {};     // Tracks known to be in each mode, bit 0 for A
+  DCCEXCurrentHistory _currentHistory[TRACK_COUNT];   // Recent current samples of each track when polling
+  bool _currentPolling = false;                       // Flag that check() polls track currents
+  unsigned long _currentPollPeriod = 0;               // Time in ms between polls
+  unsigned long _lastCurrentPoll = 0;                 // Time in ms of the last poll
+  int _currentThreshold = 0;                          // Threshold as a percentage of the limit, 0 if disabled
+  uint8_t _currentAboveMask = 0;                      // Tracks at or above the threshold, bit 0 for A
+  ThrottleLatencyEntry *_latencyEntries = nullptr;    // Round trip times for each address, nullptr if not timing
+  int _latencyEntryCount = 0;                         // Number of entries
+  bool _ownsLatencyEntries = false;                   // Flag that the entries were allocated from the heap
+  LatencyHistogram _throttleLatency;                  // Round trip times for all addresses
+  unsigned long _latencyUntracked = 0;                // Commands not timed because every entry was in use
+  bool _fastClockKnown = false;                       // Flag that a fast clock time has been received
+  int _fastClockMinutes = 0;                          // Fast clock time in minutes at the anchor
+  int _fastClockSpeed = 0;                            // Fast clock speed factor, 0 if not received
+  unsigned long _fastClockAnchor = 0;                 // Time in ms the fast clock was anchored
+  int _fastClockDrift = 0;                            // Minutes the last time received was ahead of the local clock
+  int _fastClockLastTick = -1;                        // Minute last passed to the tick function
+  FastClockTickCallback _fastClockTick = nullptr;     // Function called on each new fast minute
+  void *_fastClockTickContext = nullptr;              // Passed to the tick function unchanged
+  // Function called when a track crosses the current threshold, and the context passed to it
+  TrackCurrentThresholdCallback _currentThresholdCallback = nullptr;
+  void *_currentThresholdContext = nullptr;
+  // Ring of tracked CV operations, only the oldest is sent at a time
+  PendingCVOperation _cvOperations[MAX_PENDING_CV_OPERATIONS];
+  int _cvOperationHead = 0;                           // Index of the oldest tracked CV operation
+  int _cvOperationCount = 0;                          // Count of tracked CV operations pending
+  int _nextCVOperationId = 0;                         // Identifier for the next tracked CV operation
+  unsigned long _cvOperationTimeout = 5000;           // Time in ms to wait for each tracked CV response
+  int _cvOperationRetries = 0;                        // Times to send a tracked CV command again
+  CVOperationStats _cvOperationStats = {};            // Counts and response times of tracked CV operations
+  int _staleCVResponses = 0;                          // Responses to timed out CV attempts still to arrive
   Stream *_stream;                                    // Stream object where commands are sent/received
   Stream *_console;                                   // Stream object for console output
   NullStream _nullStream;                             // Send streams to null if no object provided
   int _bufflen;                                       // Used to ensure command buffer size not exceeded
   int _maxCmdBuffer;                                  // Max size for the command buffer
+#ifdef DCCEX_STATIC_MEMORY
+  char _cmdBuffer[DCCEX_STATIC_COMMAND_BUFFER];       // Char array for inbound command buffer
+#else
   char *_cmdBuffer;                                   // Char array for inbound command buffer
+#endif
   char _outboundCommand[MAX_OUTBOUND_COMMAND_LENGTH]; // Char array for outbound commands
-  DCCEXProtocolDelegate *_delegate = nullptr;         // Pointer to the delegate for notifications
+#ifdef DCCEX_STATIC_HANDLER
+  DCCEXStaticDispatch _delegate = &_observers;        // Static handler, and the delegate notifications are sent to
+#else
+  DCCEXProtocolDelegate *_delegate = &_observers;     // Pointer to the delegate notifications are sent to
+#endif
+  uint32_t _eventMask = 0;                            // Event types notifications are sent for
+  uint32_t _queueEventMask = 0;                       // Event types recorded when the event queue is enabled
+  DCCEXObserverList _observers;                       // Application delegate and observers
+  DCCEXEventQueue _eventQueue;                        // Events recorded when the event queue is enabled
+  DCCEXEventRecorder _eventRecorder{&_eventQueue};    // Delegate recording events into the queue
+#ifdef DCCEX_THREADED
+  DCCEXCommandQueue _inboundQueue{MemoryParser};      // Commands framed by pollStream() for check() to parse
+  DCCEXCommandQueue _outboundQueue{MemoryOutbound};   // Commands sent by the application for pollStream() to write
+  bool _threaded = false;                             // Flag that pollStream() does the stream I/O
+  int _framedLength = 0;                              // Length of the command pollStream() is framing
+#endif
   unsigned long _lastServerResponseTime;              // Records the timestamp of the last server response
   char _inputBuffer[512];                             // Char array for input buffer
   int _nextChar;                                      // where the next character to be read goes in the buffer
@@ -921,6 +2119,7 @@ private:
   unsigned long _userChangeDelay;                     // Delay in ms between sending throttle commands
   unsigned long _lastUserChange;                      // Time in ms of the last throttle command
   bool _debug = false;                                // Enable output of send/receive commands to console
+  ListArena _arenas[ARENA_LIST_COUNT];                // Optional arenas for each object list
 
   // Helper methods to build the outbound command
   /**
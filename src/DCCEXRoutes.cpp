@@ -31,33 +31,27 @@
 
 // Public methods
 
-Route *Route::_first = nullptr;
+Route::List Route::_list;
+ListArena *Route::_arena = nullptr;
 
 Route::Route(int id) {
   _id = id;
   _name = nullptr;
   _next = nullptr;
-  if (!_first) {
-    _first = this;
-  } else {
-    Route *current = _first;
-    while (current->_next != nullptr) {
-      current = current->_next;
-    }
-    current->_next = this;
-  }
+  _list.append(this);
+  MemoryStats::addObject(MemoryRoutes, sizeof(Route));
 }
 
 int Route::getId() { return _id; }
 
 void Route::setName(const char *name) {
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryRoutes, _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
-  int nameLength = strlen(name);
-  _name = new char[nameLength + 1];
-  strcpy(_name, name);
+  _name = ListArena::copyString(_arena, this, name);
+  MemoryStats::addName(MemoryRoutes, _name, true);
 }
 
 const char *Route::getName() { return _name; }
@@ -66,9 +60,9 @@ void Route::setType(RouteType type) { _type = type; }
 
 RouteType Route::getType() { return (RouteType)_type; }
 
-Route *Route::getFirst() { return _first; }
+Route *Route::getFirst() { return _list.getFirst(); }
 
-void Route::setNext(Route *route) { _next = route; }
+void Route::setNext(Route *route) { _list.relink(this, route); }
 
 Route *Route::getNext() { return _next; }
 
@@ -82,61 +76,44 @@ Route *Route::getById(int id) {
 }
 
 void Route::clearRouteList() {
-  // Count Routes in list
-  int routeCount = 0;
-  Route *currentRoute = Route::getFirst();
-  while (currentRoute != nullptr) {
-    routeCount++;
-    currentRoute = currentRoute->getNext();
+  // Each Route removes itself from the head of the list when deleted
+  while (_list.getFirst() != nullptr) {
+    delete _list.getFirst();
   }
+}
 
-  // Store Route pointers in an array for clean up
-  Route **deleteRoutes = new Route *[routeCount];
-  currentRoute = Route::getFirst();
-  for (int i = 0; i < routeCount; i++) {
-    deleteRoutes[i] = currentRoute;
-    currentRoute = currentRoute->getNext();
-  }
+const Route::List &Route::getList() { return _list; }
 
-  // Delete each Route
-  for (int i = 0; i < routeCount; i++) {
-    delete deleteRoutes[i];
-  }
+void Route::setArena(ListArena *arena) { _arena = arena; }
 
-  // Clean up the array of pointers
-  delete[] deleteRoutes;
+ListArena *Route::getArena() { return _arena; }
 
-  // Reset first pointer
-  Route::_first = nullptr;
+#ifdef DCCEX_STATIC_MEMORY
+static StaticPool<sizeof(Route), DCCEX_STATIC_ROUTES> routePool;
+
+void *Route::operator new(size_t size) noexcept {
+  (void)size;
+  return routePool.allocate();
 }
 
+void Route::operator delete(void *ptr) { routePool.release(ptr); }
+
+StaticPoolStats Route::getPoolStats() { return routePool.getStats(); }
+#else
+void *Route::operator new(size_t size) noexcept { return ::operator new(size, std::nothrow); }
+
+void Route::operator delete(void *ptr) { ListArena::release(_arena, ptr); }
+#endif
+
 Route::~Route() {
-  _removeFromList(this);
+  _list.remove(this);
 
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryRoutes, _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
 
   _next = nullptr;
-}
-
-// Private methods
-
-void Route::_removeFromList(Route *route) {
-  if (!route) {
-    return;
-  }
-
-  if (getFirst() == route) {
-    _first = route->getNext();
-  } else {
-    Route *currentRoute = _first;
-    while (currentRoute && currentRoute->getNext() != route) {
-      currentRoute = currentRoute->getNext();
-    }
-    if (currentRoute) {
-      currentRoute->setNext(route->getNext());
-    }
-  }
+  MemoryStats::addObject(MemoryRoutes, -(long)sizeof(Route));
 }
@@ -29,6 +29,9 @@
 #ifndef DCCEXROUTES_H
 #define DCCEXROUTES_H
 
+#include "DCCEXArena.h"
+#include "DCCEXList.h"
+#include "DCCEXMemory.h"
 #include <Arduino.h>
 
 enum RouteType {
@@ -67,8 +70,11 @@ public:
   /// @return Pointer to the first Route object
   static Route *getFirst();
 
-  /// @brief Set the next route in the list
-  /// @param route Pointer to the next route
+  /**
+   * @brief DEPRECATED Set the next route in the list, this will be REMOVED in 2.0.0 as the library keeps the list
+   * @details Routes that followed this one are dropped from the list but not deleted. Ignored if it would make a loop.
+   * @param route Pointer to the next route, or nullptr to end the list here
+   */
   void setNext(Route *route);
 
   /// @brief Get next Route object
@@ -82,6 +88,41 @@ public:
   /// @brief Clear the list of routes
   static void clearRouteList();
 
+  /**
+   * @brief Set the arena Route objects and their names are allocated from
+   * @param arena Pointer to the ListArena, or nullptr to use the heap
+   */
+  static void setArena(ListArena *arena);
+
+  /**
+   * @brief Get the arena Route objects and their names are allocated from
+   * @return ListArena* Pointer to the ListArena, or nullptr if not in use
+   */
+  static ListArena *getArena();
+
+  /**
+   * @brief Allocate a Route on the heap, use ListArena::create() to allocate from an arena
+   * @details With DCCEX_STATIC_MEMORY defined, this allocates from a static pool of DCCEX_STATIC_ROUTES objects
+   * instead.
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Free a Route, arena allocated objects are reclaimed when the arena is reset
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Get the usage of the static pool Route objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+
   /// @brief Destructor for a route
   ~Route();
 
@@ -89,12 +130,21 @@ private:
   int _id;
   char *_name;
   char _type;
-  static Route *_first;
+  static ListArena *_arena;
   Route *_next;
 
-  /// @brief Remove the route from the list
-  /// @param route Pointer to the route to remove
-  void _removeFromList(Route *route);
+public:
+  /// @brief List of Route objects, linked by their next pointer
+  typedef IntrusiveList<Route, &Route::_next> List;
+
+  /**
+   * @brief Get the list of Route objects, which can be used in range-based for loops
+   * @return const List& Reference to the Route list
+   */
+  static const List &getList();
+
+private:
+  static List _list;
 };
 
 #endif
\ No newline at end of file
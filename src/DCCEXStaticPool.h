@@ -0,0 +1,334 @@
+/* -*- c++ -*-
+ *
+ * DCCEXProtocol
+ *
+ * This package implements a DCCEX native protocol connection,
+ * allow a device to communicate with a DCC-EX EX-CommandStation.
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXSTATICPOOL_H
+#define DCCEXSTATICPOOL_H
+
+#include <Arduino.h>
+
+/*
+ * Define DCCEX_STATIC_MEMORY as a build flag to use the fixed capacity, heap free build profile. In this profile every
+ * object, name, and buffer is held in a static array sized by the capacities below, which may also be overridden as
+ * build flags. Once a capacity is reached, further objects are not created and the overflow is counted.
+ */
+#ifdef DCCEX_STATIC_MEMORY
+
+#ifndef DCCEX_STATIC_LOCOS
+#define DCCEX_STATIC_LOCOS 50 // Roster and local Loco objects
+#endif
+
+#ifndef DCCEX_STATIC_TURNOUTS
+#define DCCEX_STATIC_TURNOUTS 50 // Turnout objects
+#endif
+
+#ifndef DCCEX_STATIC_ROUTES
+#define DCCEX_STATIC_ROUTES 32 // Route objects
+#endif
+
+#ifndef DCCEX_STATIC_TURNTABLES
+#define DCCEX_STATIC_TURNTABLES 4 // Turntable objects
+#endif
+
+#ifndef DCCEX_STATIC_TURNTABLE_INDEXES
+#define DCCEX_STATIC_TURNTABLE_INDEXES 48 // TurntableIndex objects across all turntables
+#endif
+
+#ifndef DCCEX_STATIC_CSCONSISTS
+#define DCCEX_STATIC_CSCONSISTS 8 // CSConsist objects
+#endif
+
+#ifndef DCCEX_STATIC_CSCONSIST_MEMBERS
+#define DCCEX_STATIC_CSCONSIST_MEMBERS 32 // CSConsistMember objects across all CSConsists
+#endif
+
+#ifndef DCCEX_STATIC_NAME_BYTES
+#define DCCEX_STATIC_NAME_BYTES 4096 // Bytes for all names and function labels
+#endif
+
+#ifndef DCCEX_STATIC_COMMAND_PARAMS
+#define DCCEX_STATIC_COMMAND_PARAMS 50 // Maximum parameters in a received command
+#endif
+
+#ifndef DCCEX_STATIC_COMMAND_BUFFER
+#define DCCEX_STATIC_COMMAND_BUFFER 500 // Size of the received command buffer
+#endif
+
+#endif // DCCEX_STATIC_MEMORY
+
+const size_t STATIC_POOL_ALIGNMENT = 8; // Alignment of every object slot in a StaticPool
+
+/// @brief Usage of a single static pool
+struct StaticPoolStats {
+  int used;          // Number of objects (or bytes for names) currently allocated
+  int capacity;      // Maximum number of objects (or bytes for names)
+  int overflowCount; // Number of allocations refused because the pool was full
+  size_t bytes;      // Size of the pool's storage in bytes
+};
+
+/**
+ * @brief Fixed number of fixed size object slots held in static storage
+ * @details Slots are handed out in order until each has been used once, after which released slots are reused from a
+ * free list. The pool has no constructor and relies on zero initialisation, so it must only be declared with static
+ * storage duration, and is then ready before any other static initialisation that may allocate from it.
+ * @tparam Size Size of each object
+ * @tparam Count Number of objects
+ */
+template <size_t Size, int Count> class StaticPool {
+public:
+  /**
+   * @brief Allocate one object slot
+   * @return void* Pointer to the slot, or nullptr if the pool is full
+   */
+  void *allocate() {
+    void *slot = nullptr;
+    if (_freeList) {
+      slot = _freeList;
+      _freeList = *(void **)slot;
+    } else if (_untouched < Count) {
+      slot = &_storage[_untouched * SLOT_SIZE];
+      _untouched++;
+    } else {
+      _overflowCount++;
+      return nullptr;
+    }
+    _used++;
+    return slot;
+  }
+
+  /**
+   * @brief Release a slot so it can be reused
+   * @param ptr Pointer to the slot, ignored if not from this pool
+   */
+  void release(void *ptr) {
+    if (!owns(ptr))
+      return;
+    *(void **)ptr = _freeList;
+    _freeList = ptr;
+    _used--;
+  }
+
+  /**
+   * @brief Check if the provided pointer is a slot in this pool
+   * @param ptr Pointer to check
+   * @return true If it is
+   * @return false If not
+   */
+  bool owns(const void *ptr) const {
+    const uint8_t *p = (const uint8_t *)ptr;
+    return (p >= _storage && p < _storage + sizeof(_storage));
+  }
+
+  /**
+   * @brief Get the current usage of the pool
+   * @return StaticPoolStats Pool usage
+   */
+  StaticPoolStats getStats() const {
+    StaticPoolStats stats = {_used, Count, _overflowCount, sizeof(_storage)};
+    return stats;
+  }
+
+private:
+  static const size_t SLOT_SIZE =
+      ((Size > sizeof(void *) ? Size : sizeof(void *)) + STATIC_POOL_ALIGNMENT - 1) & ~(STATIC_POOL_ALIGNMENT - 1);
+
+  alignas(STATIC_POOL_ALIGNMENT) uint8_t _storage[SLOT_SIZE * Count];
+  void *_freeList;
+  int _untouched;
+  int _used;
+  int _overflowCount;
+};
+
+/**
+ * @brief Fixed number of bytes held in static storage for variable length strings
+ * @details Each string is held in a block with a size_t header in front. Released blocks are kept in a free list in
+ * address order, merged with any free neighbours, and reused first fit before new blocks are carved from the top, so
+ * releasing any string always makes its bytes available again, whatever else is still held. As for StaticPool, this
+ * must only be declared with static storage duration.
+ * @tparam Size Number of bytes
+ */
+template <size_t Size> class StaticStringPool {
+public:
+  /**
+   * @brief Get the bytes a string of the provided length takes from the pool, including its header
+   * @param length Length of the string including its terminator and any reserved bytes
+   * @return size_t Block size in bytes
+   */
+  static size_t blockSize(size_t length) {
+    size_t size = HEADER_SIZE + length;
+    return size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size;
+  }
+
+  /**
+   * @brief Copy a string into the pool
+   * @param source String to copy
+   * @param reserve Optional - bytes to reserve in front of the copy
+   * @return char* Pointer to the start of the block, with the copy reserve bytes in, or nullptr if source is nullptr or
+   * the pool is full
+   */
+  char *copy(const char *source, size_t reserve = 0) {
+    if (source == nullptr)
+      return nullptr;
+    size_t length = reserve + strlen(source) + 1;
+    size_t block = _allocate(blockSize(length));
+    if (block == NO_BLOCK) {
+      _overflowCount++;
+      return nullptr;
+    }
+    char *string = &_storage[block + HEADER_SIZE];
+    memcpy(string + reserve, source, length - reserve);
+    return string;
+  }
+
+  /**
+   * @brief Release a string, ignored if not from this pool
+   * @param string String to release
+   */
+  void release(char *string) {
+    if (!owns(string))
+      return;
+    size_t block = string - _storage - HEADER_SIZE;
+    size_t size = _read(block);
+    _used -= size;
+
+    // Find the free blocks either side of this one
+    size_t beforePrevious = NO_BLOCK;
+    size_t previous = NO_BLOCK;
+    size_t next = _decode(_freeList);
+    while (next != NO_BLOCK && next < block) {
+      beforePrevious = previous;
+      previous = next;
+      next = _nextFree(next);
+    }
+
+    // Merge with free neighbours, so free blocks are never adjacent
+    if (next != NO_BLOCK && block + size == next) {
+      size += _read(next);
+      next = _nextFree(next);
+    }
+    if (previous != NO_BLOCK && previous + _read(previous) == block) {
+      size += _read(previous);
+      block = previous;
+      previous = beforePrevious;
+    }
+
+    // A free block at the top is handed straight back to the top
+    if (block + size == _top) {
+      _top = block;
+      _link(previous, NO_BLOCK);
+      return;
+    }
+    _write(block, size);
+    _setNextFree(block, next);
+    _link(previous, block);
+  }
+
+  /**
+   * @brief Check if the provided pointer is in this pool
+   * @param ptr Pointer to check
+   * @return true If it is
+   * @return false If not
+   */
+  bool owns(const void *ptr) const {
+    const char *p = (const char *)ptr;
+    return (p >= _storage && p < _storage + Size);
+  }
+
+  /**
+   * @brief Get the current usage of the pool in bytes, including block headers
+   * @return StaticPoolStats Pool usage
+   */
+  StaticPoolStats getStats() const {
+    StaticPoolStats stats = {(int)_used, (int)Size, _overflowCount, Size};
+    return stats;
+  }
+
+private:
+  static const size_t HEADER_SIZE = sizeof(size_t);         // Block size in front of every block
+  static const size_t MIN_BLOCK_SIZE = 2 * sizeof(size_t);  // Room for the header and free list link
+  static const size_t NO_BLOCK = Size;                      // Offset meaning no block
+
+  // Free list links are stored as offset + 1, so the zero initialised list is empty
+  static size_t _decode(size_t link) { return link ? link - 1 : NO_BLOCK; }
+  static size_t _encode(size_t block) { return block == NO_BLOCK ? 0 : block + 1; }
+
+  // Headers and links are copied, as blocks have no particular alignment
+  size_t _read(size_t offset) const {
+    size_t value;
+    memcpy(&value, &_storage[offset], sizeof(value));
+    return value;
+  }
+  void _write(size_t offset, size_t value) { memcpy(&_storage[offset], &value, sizeof(value)); }
+
+  size_t _nextFree(size_t block) const { return _decode(_read(block + HEADER_SIZE)); }
+  void _setNextFree(size_t block, size_t next) { _write(block + HEADER_SIZE, _encode(next)); }
+
+  void _link(size_t previous, size_t block) {
+    if (previous == NO_BLOCK) {
+      _freeList = _encode(block);
+    } else {
+      _setNextFree(previous, block);
+    }
+  }
+
+  size_t _allocate(size_t size) {
+    size_t previous = NO_BLOCK;
+    for (size_t block = _decode(_freeList); block != NO_BLOCK; previous = block, block = _nextFree(block)) {
+      size_t free = _read(block);
+      if (free < size)
+        continue;
+      if (free - size >= MIN_BLOCK_SIZE) {
+        // Split, leaving the remainder in the free list in place of this block
+        size_t remainder = block + size;
+        _write(remainder, free - size);
+        _setNextFree(remainder, _nextFree(block));
+        _link(previous, remainder);
+      } else {
+        _link(previous, _nextFree(block));
+        size = free;
+      }
+      _write(block, size);
+      _used += size;
+      return block;
+    }
+
+    if (size > Size - _top)
+      return NO_BLOCK;
+    size_t block = _top;
+    _top += size;
+    _write(block, size);
+    _used += size;
+    return block;
+  }
+
+  char _storage[Size];
+  size_t _freeList; // First free block below the top, as offset + 1
+  size_t _top;      // Offset of the first byte never carved, or handed back
+  size_t _used;     // Bytes in blocks currently held
+  int _overflowCount;
+};
+
+#endif // DCCEXSTATICPOOL_H
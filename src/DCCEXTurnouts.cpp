@@ -29,34 +29,28 @@
 #include "DCCEXTurnouts.h"
 #include <Arduino.h>
 
-Turnout *Turnout::_first = nullptr;
+Turnout::List Turnout::_list;
+ListArena *Turnout::_arena = nullptr;
 
 Turnout::Turnout(int id, bool thrown) {
   _id = id;
   _thrown = thrown;
   _name = nullptr;
   _next = nullptr;
-  if (!_first) {
-    _first = this;
-  } else {
-    Turnout *current = _first;
-    while (current->_next != nullptr) {
-      current = current->_next;
-    }
-    current->_next = this;
-  }
+  _list.append(this);
+  MemoryStats::addObject(MemoryTurnouts, sizeof(Turnout));
 }
 
 void Turnout::setThrown(bool thrown) { _thrown = thrown; }
 
 void Turnout::setName(const char *name) {
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryTurnouts, _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
-  int nameLength = strlen(name);
-  _name = new char[nameLength + 1];
-  strcpy(_name, name);
+  _name = ListArena::copyString(_arena, this, name);
+  MemoryStats::addName(MemoryTurnouts, _name, true);
 }
 
 int Turnout::getId() { return _id; }
@@ -65,9 +59,9 @@ const char *Turnout::getName() { return _name; }
 
 bool Turnout::getThrown() { return _thrown; }
 
-Turnout *Turnout::getFirst() { return _first; }
+Turnout *Turnout::getFirst() { return _list.getFirst(); }
 
-void Turnout::setNext(Turnout *turnout) { _next = turnout; }
+void Turnout::setNext(Turnout *turnout) { _list.relink(this, turnout); }
 
 Turnout *Turnout::getNext() { return _next; }
 
@@ -81,61 +75,44 @@ Turnout *Turnout::getById(int id) {
 }
 
 void Turnout::clearTurnoutList() {
-  // Count Turnouts in list
-  int turnoutCount = 0;
-  Turnout *currentTurnout = Turnout::getFirst();
-  while (currentTurnout != nullptr) {
-    turnoutCount++;
-    currentTurnout = currentTurnout->getNext();
+  // Each Turnout removes itself from the head of the list when deleted
+  while (_list.getFirst() != nullptr) {
+    delete _list.getFirst();
   }
+}
 
-  // Store Turnout pointers in an array for clean up
-  Turnout **deleteTurnouts = new Turnout *[turnoutCount];
-  currentTurnout = Turnout::getFirst();
-  for (int i = 0; i < turnoutCount; i++) {
-    deleteTurnouts[i] = currentTurnout;
-    currentTurnout = currentTurnout->getNext();
-  }
+const Turnout::List &Turnout::getList() { return _list; }
 
-  // Delete each Turnout
-  for (int i = 0; i < turnoutCount; i++) {
-    delete deleteTurnouts[i];
-  }
+void Turnout::setArena(ListArena *arena) { _arena = arena; }
 
-  // Clean up the array of pointers
-  delete[] deleteTurnouts;
+ListArena *Turnout::getArena() { return _arena; }
 
-  // Reset first pointer
-  Turnout::_first = nullptr;
+#ifdef DCCEX_STATIC_MEMORY
+static StaticPool<sizeof(Turnout), DCCEX_STATIC_TURNOUTS> turnoutPool;
+
+void *Turnout::operator new(size_t size) noexcept {
+  (void)size;
+  return turnoutPool.allocate();
 }
 
+void Turnout::operator delete(void *ptr) { turnoutPool.release(ptr); }
+
+StaticPoolStats Turnout::getPoolStats() { return turnoutPool.getStats(); }
+#else
+void *Turnout::operator new(size_t size) noexcept { return ::operator new(size, std::nothrow); }
+
+void Turnout::operator delete(void *ptr) { ListArena::release(_arena, ptr); }
+#endif
+
 Turnout::~Turnout() {
-  _removeFromList(this);
+  _list.remove(this);
 
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryTurnouts, _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
 
   _next = nullptr;
-}
-
-// Private methods
-
-void Turnout::_removeFromList(Turnout *turnout) {
-  if (!turnout) {
-    return;
-  }
-
-  if (getFirst() == turnout) {
-    _first = turnout->getNext();
-  } else {
-    Turnout *currentTurnout = _first;
-    while (currentTurnout && currentTurnout->getNext() != turnout) {
-      currentTurnout = currentTurnout->getNext();
-    }
-    if (currentTurnout) {
-      currentTurnout->setNext(turnout->getNext());
-    }
-  }
+  MemoryStats::addObject(MemoryTurnouts, -(long)sizeof(Turnout));
 }
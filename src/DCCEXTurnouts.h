@@ -29,6 +29,9 @@
 #ifndef DCCEXTURNOUTS_H
 #define DCCEXTURNOUTS_H
 
+#include "DCCEXArena.h"
+#include "DCCEXList.h"
+#include "DCCEXMemory.h"
 #include <Arduino.h>
 
 /// @brief Class to contain and maintain the various Turnout/Point attributes and methods
@@ -63,8 +66,12 @@ public:
   /// @return Pointer to the first Turnout object
   static Turnout *getFirst();
 
-  /// @brief Set the next turnout in the list
-  /// @param turnout Pointer to the next Turnout
+  /**
+   * @brief DEPRECATED Set the next turnout in the list, this will be REMOVED in 2.0.0 as the library keeps the list
+   * @details Turnouts that followed this one are dropped from the list but not deleted. Ignored if it would
+   * make a loop.
+   * @param turnout Pointer to the next Turnout, or nullptr to end the list here
+   */
   void setNext(Turnout *turnout);
 
   /// @brief Get next turnout object
@@ -79,19 +86,63 @@ public:
   /// @brief Clear the list of turnouts
   static void clearTurnoutList();
 
+  /**
+   * @brief Set the arena Turnout objects and their names are allocated from
+   * @param arena Pointer to the ListArena, or nullptr to use the heap
+   */
+  static void setArena(ListArena *arena);
+
+  /**
+   * @brief Get the arena Turnout objects and their names are allocated from
+   * @return ListArena* Pointer to the ListArena, or nullptr if not in use
+   */
+  static ListArena *getArena();
+
+  /**
+   * @brief Allocate a Turnout on the heap, use ListArena::create() to allocate from an arena
+   * @details With DCCEX_STATIC_MEMORY defined, this allocates from a static pool of DCCEX_STATIC_TURNOUTS objects
+   * instead.
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Free a Turnout, arena allocated objects are reclaimed when the arena is reset
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Get the usage of the static pool Turnout objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+
   /// @brief Destructor for a Turnout
   ~Turnout();
 
 private:
-  static Turnout *_first;
+  static ListArena *_arena;
   Turnout *_next;
   int _id;
   char *_name;
   bool _thrown;
 
-  /// @brief Remove the turnout from the list
-  /// @param turnout Pointer to the turnout to remove
-  void _removeFromList(Turnout *turnout);
+public:
+  /// @brief List of Turnout objects, linked by their next pointer
+  typedef IntrusiveList<Turnout, &Turnout::_next> List;
+
+  /**
+   * @brief Get the list of Turnout objects, which can be used in range-based for loops
+   * @return const List& Reference to the Turnout list
+   */
+  static const List &getList();
+
+private:
+  static List _list;
 };
 
 #endif
\ No newline at end of file
@@ -35,14 +35,10 @@ TurntableIndex::TurntableIndex(int ttId, int id, int angle, const char *name) {
   _ttId = ttId;
   _id = id;
   _angle = angle;
-  if (name) {
-    int nameLength = strlen(name);
-    _name = new char[nameLength + 1];
-    strcpy(_name, name);
-  } else {
-    _name = nullptr;
-  }
+  _name = ListArena::copyString(Turntable::_arena, this, name);
+  MemoryStats::addName(MemoryTurntableIndexes, _name, true);
   _nextIndex = nullptr;
+  MemoryStats::addObject(MemoryTurntableIndexes, sizeof(TurntableIndex));
 }
 
 int TurntableIndex::getTTId() { return _ttId; }
@@ -55,17 +51,37 @@ const char *TurntableIndex::getName() { return _name; }
 
 TurntableIndex *TurntableIndex::getNextIndex() { return _nextIndex; }
 
+#ifdef DCCEX_STATIC_MEMORY
+static StaticPool<sizeof(TurntableIndex), DCCEX_STATIC_TURNTABLE_INDEXES> turntableIndexPool;
+
+void *TurntableIndex::operator new(size_t size) noexcept {
+  (void)size;
+  return turntableIndexPool.allocate();
+}
+
+void TurntableIndex::operator delete(void *ptr) { turntableIndexPool.release(ptr); }
+
+StaticPoolStats TurntableIndex::getPoolStats() { return turntableIndexPool.getStats(); }
+#else
+void *TurntableIndex::operator new(size_t size) noexcept { return ::operator new(size, std::nothrow); }
+
+void TurntableIndex::operator delete(void *ptr) { ListArena::release(Turntable::_arena, ptr); }
+#endif
+
 TurntableIndex::~TurntableIndex() {
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryTurntableIndexes, _name, false);
+    ListArena::freeString(Turntable::_arena, _name);
     _name = nullptr;
   }
   _nextIndex = nullptr;
+  MemoryStats::addObject(MemoryTurntableIndexes, -(long)sizeof(TurntableIndex));
 }
 
 // class Turntable
 
-Turntable *Turntable::_first = nullptr;
+Turntable::List Turntable::_list;
+ListArena *Turntable::_arena = nullptr;
 
 Turntable::Turntable(int id) {
   _id = id;
@@ -74,18 +90,12 @@ Turntable::Turntable(int id) {
   _numberOfIndexes = 0;
   _name = nullptr;
   _isMoving = false;
-  _firstIndex = nullptr;
-  _indexCount = 0;
   _next = nullptr;
-  if (!_first) {
-    _first = this;
-  } else {
-    Turntable *current = _first;
-    while (current->_next != nullptr) {
-      current = current->_next;
-    }
-    current->_next = this;
-  }
+  _indexStorage = nullptr;
+  _indexCapacity = 0;
+  _indexStorageUsed = 0;
+  _list.append(this);
+  MemoryStats::addObject(MemoryTurntables, sizeof(Turntable));
 }
 
 int Turntable::getId() { return _id; }
@@ -104,12 +114,12 @@ int Turntable::getNumberOfIndexes() { return _numberOfIndexes; }
 
 void Turntable::setName(const char *name) {
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryTurntables, _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
-  int nameLength = strlen(name);
-  _name = new char[nameLength + 1];
-  strcpy(_name, name);
+  _name = ListArena::copyString(_arena, this, name);
+  MemoryStats::addName(MemoryTurntables, _name, true);
 }
 
 const char *Turntable::getName() { return _name; }
@@ -118,28 +128,61 @@ void Turntable::setMoving(bool moving) { _isMoving = moving; }
 
 bool Turntable::isMoving() { return _isMoving; }
 
-int Turntable::getIndexCount() { return _indexCount; }
+int Turntable::getIndexCount() { return _indexes.getCount(); }
 
-Turntable *Turntable::getFirst() { return _first; }
+Turntable *Turntable::getFirst() { return _list.getFirst(); }
 
-void Turntable::setNext(Turntable *turntable) { _next = turntable; }
+void Turntable::setNext(Turntable *turntable) { _list.relink(this, turntable); }
 
 Turntable *Turntable::getNext() { return _next; }
 
-void Turntable::addIndex(TurntableIndex *index) {
-  if (this->_firstIndex == nullptr) {
-    this->_firstIndex = index;
+void Turntable::addIndex(TurntableIndex *index) { _indexes.append(index); }
+
+TurntableIndex *Turntable::getFirstIndex() { return _indexes.getFirst(); }
+
+bool Turntable::reserveIndexes(int count) {
+  if (count <= 0 || _indexStorageUsed > 0)
+    return false;
+
+  if (_indexStorage) {
+    MemoryStats::addBufferBytes(MemoryTurntableIndexes, -(long)(_indexCapacity * sizeof(TurntableIndex)));
+    ListArena::release(_arena, _indexStorage);
+    _indexStorage = nullptr;
+    _indexCapacity = 0;
+  }
+
+  // Keep the block with the turntable, so arena allocated turntables reserve from the arena
+  size_t size = count * sizeof(TurntableIndex);
+  void *memory = (_arena && _arena->owns(this)) ? _arena->allocate(size) : nullptr;
+#ifndef DCCEX_STATIC_MEMORY
+  if (memory == nullptr)
+    memory = ::operator new(size, std::nothrow);
+#endif
+  if (memory == nullptr)
+    return false;
+
+  _indexStorage = (TurntableIndex *)memory;
+  _indexCapacity = count;
+  MemoryStats::addBufferBytes(MemoryTurntableIndexes, size);
+  return true;
+}
+
+TurntableIndex *Turntable::addIndex(int id, int angle, const char *name) {
+  TurntableIndex *index;
+  if (_indexStorageUsed < _indexCapacity) {
+    // Stored indexes count as objects, so move their bytes out of the unused block
+    MemoryStats::addBufferBytes(MemoryTurntableIndexes, -(long)sizeof(TurntableIndex));
+    index = ::new (&_indexStorage[_indexStorageUsed]) TurntableIndex(_id, id, angle, name);
+    _indexStorageUsed++;
   } else {
-    TurntableIndex *current = this->_firstIndex;
-    while (current->_nextIndex != nullptr) {
-      current = current->_nextIndex;
-    }
-    current->_nextIndex = index;
+    index = ListArena::create<TurntableIndex>(_arena, _id, id, angle, name);
   }
-  _indexCount++;
+  if (index)
+    _indexes.append(index);
+  return index;
 }
 
-TurntableIndex *Turntable::getFirstIndex() { return _firstIndex; }
+const Turntable::IndexList &Turntable::getIndexList() { return _indexes; }
 
 Turntable *Turntable::getById(int id) {
   for (Turntable *tt = Turntable::getFirst(); tt; tt = tt->getNext()) {
@@ -160,74 +203,70 @@ TurntableIndex *Turntable::getIndexById(int id) {
 }
 
 void Turntable::clearTurntableList() {
-  // Count Turntables in list
-  int turntableCount = 0;
-  Turntable *currentTurntable = Turntable::getFirst();
-  while (currentTurntable != nullptr) {
-    turntableCount++;
-    currentTurntable = currentTurntable->getNext();
+  // Each Turntable removes itself from the head of the list when deleted
+  while (_list.getFirst() != nullptr) {
+    delete _list.getFirst();
   }
+}
 
-  // Store Turntable pointers in an array for clean up
-  Turntable **deleteTurntables = new Turntable *[turntableCount];
-  currentTurntable = Turntable::getFirst();
-  for (int i = 0; i < turntableCount; i++) {
-    deleteTurntables[i] = currentTurntable;
-    currentTurntable = currentTurntable->getNext();
-  }
+const Turntable::List &Turntable::getList() { return _list; }
 
-  // Delete each Turntable
-  for (int i = 0; i < turntableCount; i++) {
-    delete deleteTurntables[i];
-  }
+void Turntable::setArena(ListArena *arena) { _arena = arena; }
 
-  // Clean up the array of pointers
-  delete[] deleteTurntables;
+ListArena *Turntable::getArena() { return _arena; }
 
-  // Reset first pointer
-  Turntable::_first = nullptr;
+#ifdef DCCEX_STATIC_MEMORY
+static StaticPool<sizeof(Turntable), DCCEX_STATIC_TURNTABLES> turntablePool;
+
+void *Turntable::operator new(size_t size) noexcept {
+  (void)size;
+  return turntablePool.allocate();
 }
 
+void Turntable::operator delete(void *ptr) { turntablePool.release(ptr); }
+
+StaticPoolStats Turntable::getPoolStats() { return turntablePool.getStats(); }
+#else
+void *Turntable::operator new(size_t size) noexcept { return ::operator new(size, std::nothrow); }
+
+void Turntable::operator delete(void *ptr) { ListArena::release(_arena, ptr); }
+#endif
+
 Turntable::~Turntable() {
-  _removeFromList(this);
+  _list.remove(this);
 
   if (_name) {
-    delete[] _name;
+    MemoryStats::addName(MemoryTurntables, _name, false);
+    ListArena::freeString(_arena, _name);
     _name = nullptr;
   }
 
-  if (_firstIndex) {
-    // Clean up index list
-    TurntableIndex *currentIndex = _firstIndex;
-    while (currentIndex != nullptr) {
-      // Capture next index
-      TurntableIndex *nextIndex = currentIndex->getNextIndex();
-      // Delete current index
-      delete currentIndex;
-      // Move to the next
-      currentIndex = nextIndex;
-    }
-    // Set first to nullptr
-    _firstIndex = nullptr;
-  }
+  _clearIndexes();
 
   _next = nullptr;
+  MemoryStats::addObject(MemoryTurntables, -(long)sizeof(Turntable));
 }
 
-void Turntable::_removeFromList(Turntable *turntable) {
-  if (!turntable) {
-    return;
-  }
+bool Turntable::_isStoredIndex(TurntableIndex *index) {
+  return _indexStorage && index >= _indexStorage && index < _indexStorage + _indexCapacity;
+}
 
-  if (getFirst() == turntable) {
-    _first = turntable->getNext();
-  } else {
-    Turntable *currentTurntable = _first;
-    while (currentTurntable && currentTurntable->getNext() != turntable) {
-      currentTurntable = currentTurntable->getNext();
-    }
-    if (currentTurntable) {
-      currentTurntable->setNext(turntable->getNext());
+void Turntable::_clearIndexes() {
+  while (TurntableIndex *index = _indexes.getFirst()) {
+    _indexes.remove(index);
+    if (_isStoredIndex(index)) {
+      index->~TurntableIndex();
+    } else {
+      delete index;
     }
   }
+
+  if (_indexStorage) {
+    MemoryStats::addBufferBytes(MemoryTurntableIndexes,
+                                -(long)((_indexCapacity - _indexStorageUsed) * sizeof(TurntableIndex)));
+    ListArena::release(_arena, _indexStorage);
+    _indexStorage = nullptr;
+  }
+  _indexCapacity = 0;
+  _indexStorageUsed = 0;
 }
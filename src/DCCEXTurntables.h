@@ -29,6 +29,9 @@
 #ifndef DCCEXTURNTABLES_H
 #define DCCEXTURNTABLES_H
 
+#include "DCCEXArena.h"
+#include "DCCEXList.h"
+#include "DCCEXMemory.h"
 #include <Arduino.h>
 
 enum TurntableType {
@@ -67,6 +70,29 @@ public:
   /// @return Pointer to the next TurntableIndex object
   TurntableIndex *getNextIndex();
 
+  /**
+   * @brief Allocate a TurntableIndex on the heap, use ListArena::create() to allocate from an arena
+   * @details With DCCEX_STATIC_MEMORY defined, this allocates from a static pool of DCCEX_STATIC_TURNTABLE_INDEXES
+   * objects instead.
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Free a TurntableIndex, arena allocated objects are reclaimed when the arena is reset
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Get the usage of the static pool TurntableIndex objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+
   /// @brief Destructor for an index
   ~TurntableIndex();
 
@@ -139,8 +165,12 @@ public:
   /// @return Pointer to the first Turntable object
   static Turntable *getFirst();
 
-  /// @brief Set the next turntable in the list
-  /// @param turntable Pointer to the next turntable
+  /**
+   * @brief DEPRECATED Set the next turntable in the list, this will be REMOVED in 2.0.0 as the library keeps the list
+   * @details Turntables that followed this one are dropped from the list but not deleted. Ignored if it would
+   * make a loop.
+   * @param turntable Pointer to the next turntable, or nullptr to end the list here
+   */
   void setNext(Turntable *turntable);
 
   /// @brief Get the next turntable object
@@ -151,6 +181,27 @@ public:
   /// @param index TurntableIndex object to add
   void addIndex(TurntableIndex *index);
 
+  /**
+   * @brief Allocate a single block to hold the expected number of indexes for this turntable
+   * @details Once reserved, indexes added with addIndex(id, angle, name) are constructed in this block rather than as
+   * separate allocations. The block can only be reserved while no indexes have been stored in it.
+   * @param count Number of indexes to reserve space for, including home
+   * @return true If space was reserved
+   * @return false If count is invalid, indexes are already stored, or allocation failed
+   */
+  bool reserveIndexes(int count);
+
+  /**
+   * @brief Create a new index and add it to the index list for this turntable
+   * @details The index is constructed in the space reserved by reserveIndexes() if there is room, otherwise it is
+   * allocated individually.
+   * @param id ID of the index
+   * @param angle Angle from home for this index (0 - 3600)
+   * @param name Name of the index
+   * @return TurntableIndex* Pointer to the new index, or nullptr if it could not be allocated
+   */
+  TurntableIndex *addIndex(int id, int angle, const char *name);
+
   /// @brief Get the first associated turntable index
   /// @return Pointer to the first associated TurntableIndex object
   TurntableIndex *getFirstIndex();
@@ -168,6 +219,41 @@ public:
   /// @brief Clear the list of turntables
   static void clearTurntableList();
 
+  /**
+   * @brief Set the arena Turntable objects, their indexes, and their names are allocated from
+   * @param arena Pointer to the ListArena, or nullptr to use the heap
+   */
+  static void setArena(ListArena *arena);
+
+  /**
+   * @brief Get the arena Turntable objects, their indexes, and their names are allocated from
+   * @return ListArena* Pointer to the ListArena, or nullptr if not in use
+   */
+  static ListArena *getArena();
+
+  /**
+   * @brief Allocate a Turntable on the heap, use ListArena::create() to allocate from an arena
+   * @details With DCCEX_STATIC_MEMORY defined, this allocates from a static pool of DCCEX_STATIC_TURNTABLES objects
+   * instead.
+   * @param size Size of the object
+   * @return void* Pointer to the allocated memory, or nullptr if none is available
+   */
+  static void *operator new(size_t size) noexcept;
+
+  /**
+   * @brief Free a Turntable, arena allocated objects are reclaimed when the arena is reset
+   * @param ptr Pointer to the memory to free
+   */
+  static void operator delete(void *ptr);
+
+#ifdef DCCEX_STATIC_MEMORY
+  /**
+   * @brief Get the usage of the static pool Turntable objects are allocated from
+   * @return StaticPoolStats Pool usage
+   */
+  static StaticPoolStats getPoolStats();
+#endif
+
   /// @brief Destructor for a turntable
   ~Turntable();
 
@@ -178,14 +264,49 @@ private:
   int _numberOfIndexes;
   char *_name;
   bool _isMoving;
-  int _indexCount;
-  static Turntable *_first;
+  static ListArena *_arena;
   Turntable *_next;
-  TurntableIndex *_firstIndex;
+  TurntableIndex *_indexStorage; // Block reserved for indexes, or nullptr
+  int _indexCapacity;            // Number of indexes the block can hold
+  int _indexStorageUsed;         // Number of indexes constructed in the block
+
+  /**
+   * @brief Check if an index was constructed in the block reserved for this turntable
+   * @param index Pointer to the index
+   * @return true If it is in the reserved block
+   * @return false If it was allocated individually
+   */
+  bool _isStoredIndex(TurntableIndex *index);
+
+  /**
+   * @brief Destroy all indexes and release the reserved block
+   */
+  void _clearIndexes();
+
+  friend class TurntableIndex;
 
-  /// @brief Remove the turntable from the list
-  /// @param turntable Pointer to the turntable to remove
-  void _removeFromList(Turntable *turntable);
+public:
+  /// @brief List of Turntable objects, linked by their next pointer
+  typedef IntrusiveList<Turntable, &Turntable::_next> List;
+
+  /// @brief List of TurntableIndex objects, linked by their next index pointer
+  typedef IntrusiveList<TurntableIndex, &TurntableIndex::_nextIndex> IndexList;
+
+  /**
+   * @brief Get the list of indexes for this turntable, which can be used in range-based for loops
+   * @return const IndexList& Reference to the index list
+   */
+  const IndexList &getIndexList();
+
+  /**
+   * @brief Get the list of Turntable objects, which can be used in range-based for loops
+   * @return const List& Reference to the Turntable list
+   */
+  static const List &getList();
+
+private:
+  static List _list;
+  IndexList _indexes;
 };
 
 #endif
\ No newline at end of file
@@ -27,6 +27,10 @@ public:
   // Notify when a Loco broadcast is received
   MOCK_METHOD(void, receivedLocoBroadcast, (int address, int speed, Direction direction, int functionMap), (override));
 
+  // Notify when coalesced Loco broadcasts are delivered
+  MOCK_METHOD(void, receivedCoalescedLocoBroadcast,
+              (int address, int speed, Direction direction, int functionMap, int mergedCount), (override));
+
   // Notify when a track power state change is received
   MOCK_METHOD(void, receivedTrackPower, (TrackPower), (override));
 
@@ -0,0 +1,62 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#ifndef DCCEXSTATICHANDLER_H
+#define DCCEXSTATICHANDLER_H
+
+#include <DCCEXProtocol.h>
+
+/**
+ * @brief Handler called directly by the parser in the native_test_static_handler environment
+ * @details Has no receivedLocoBroadcast() so that every Loco broadcast arrives at receivedCoalescedLocoBroadcast(),
+ * and no methods for other event types so they are not decoded when there is no delegate.
+ */
+class TestStaticHandler {
+public:
+  void receivedTrackPower(TrackPower state) {
+    trackPower = state;
+    trackPowerCount++;
+  }
+
+  void receivedTurnoutAction(int turnoutId, bool thrown) {
+    lastTurnoutId = turnoutId;
+    lastTurnoutThrown = thrown;
+  }
+
+  void receivedCoalescedLocoBroadcast(int address, int speed, Direction direction, int functionMap, int mergedCount) {
+    lastLocoAddress = address;
+    lastLocoSpeed = speed;
+    lastLocoDirection = direction;
+    lastLocoMergedCount = mergedCount;
+  }
+
+  TrackPower trackPower = PowerUnknown;
+  int trackPowerCount = 0;
+  int lastTurnoutId = 0;
+  bool lastTurnoutThrown = false;
+  int lastLocoAddress = 0;
+  int lastLocoSpeed = 0;
+  Direction lastLocoDirection = Forward;
+  int lastLocoMergedCount = 0;
+};
+
+#endif // DCCEXSTATICHANDLER_H
@@ -58,6 +58,7 @@ protected:
     _dccexProtocol.clearAllLists();
     CSConsist::clearCSConsists();
     CSConsist::setAlwaysReplicateFunctions(false);
+    Loco::setLazyFunctionLabels(false);
   }
 
   DCCEXProtocol _dccexProtocol;
@@ -360,6 +360,66 @@ TEST_F(CSConsistTests, TestGetMemberWithUnknownFails) {
   ASSERT_EQ(CSConsist::getMemberCSConsist(memberLoco), nullptr);
 }
 
+/**
+ * @brief Test the member index stays correct across many CSConsists as members are added and removed
+ */
+TEST_F(CSConsistTests, TestMemberIndexManyCSConsists) {
+  // 100 CSConsists of 3 members forces the index to grow several times
+  for (int i = 0; i < 100; i++) {
+    CSConsist *csConsist = new CSConsist();
+    csConsist->addMember(i * 10 + 1, false);
+    csConsist->addMember(i * 10 + 2, true);
+    csConsist->addMember(i * 10 + 3, false);
+  }
+
+  int index = 0;
+  for (CSConsist *csConsist = CSConsist::getFirst(); csConsist; csConsist = csConsist->getNext(), index++) {
+    EXPECT_EQ(CSConsist::getMemberCSConsist(index * 10 + 1), csConsist);
+    EXPECT_EQ(CSConsist::getMemberCSConsist(index * 10 + 3), csConsist);
+    EXPECT_EQ(CSConsist::getLeadLocoCSConsist(index * 10 + 1), csConsist);
+    EXPECT_EQ(CSConsist::getLeadLocoCSConsist(index * 10 + 2), nullptr);
+    EXPECT_EQ(CSConsist::getMemberCSConsist(index * 10 + 4), nullptr);
+  }
+
+  // Removing members and deleting CSConsists removes them from the index, leaving others reachable
+  CSConsist *csConsist50 = CSConsist::getMemberCSConsist(501);
+  ASSERT_NE(csConsist50, nullptr);
+  csConsist50->removeMember(502);
+  EXPECT_EQ(CSConsist::getMemberCSConsist(502), nullptr);
+  EXPECT_EQ(CSConsist::getMemberCSConsist(503), csConsist50);
+  delete csConsist50;
+  EXPECT_EQ(CSConsist::getMemberCSConsist(501), nullptr);
+  EXPECT_EQ(CSConsist::getLeadLocoCSConsist(501), nullptr);
+  for (int i = 0; i < 100; i++) {
+    if (i == 50)
+      continue;
+    CSConsist *csConsist = CSConsist::getMemberCSConsist(i * 10 + 2);
+    ASSERT_NE(csConsist, nullptr);
+    EXPECT_EQ(csConsist->getFirstMember()->address, i * 10 + 1);
+  }
+
+  CSConsist::clearCSConsists();
+  EXPECT_EQ(CSConsist::getMemberCSConsist(11), nullptr);
+}
+
+/**
+ * @brief Test an address added to more than one CSConsist is still indexed once removed from the first
+ */
+TEST_F(CSConsistTests, TestMemberIndexSharedAddress) {
+  CSConsist *csConsist1 = new CSConsist();
+  csConsist1->addMember(3, false);
+  csConsist1->addMember(5, false);
+  CSConsist *csConsist2 = new CSConsist();
+  csConsist2->addMember(13, false);
+  csConsist2->addMember(5, false);
+
+  EXPECT_EQ(CSConsist::getMemberCSConsist(5), csConsist1);
+  csConsist1->removeMember(5);
+  EXPECT_EQ(CSConsist::getMemberCSConsist(5), csConsist2);
+  csConsist2->removeMember(5);
+  EXPECT_EQ(CSConsist::getMemberCSConsist(5), nullptr);
+}
+
 /**
  * @brief Test removing all CSConsistMember objects clears list and doesn't crash
  */
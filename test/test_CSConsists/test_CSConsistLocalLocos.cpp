@@ -0,0 +1,95 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/CSConsistTests.h"
+
+/**
+ * @brief Test lead Locos created by the library are unlimited by default
+ */
+TEST_F(CSConsistTests, TestLocalLocoCacheUnlimitedByDefault) {
+  EXPECT_EQ(_dccexProtocol.getLocalLocoCacheSize(), 0);
+  for (int address = 3; address < 13; address++) {
+    CSConsist *csConsist = _dccexProtocol.createCSConsist(address, false);
+    csConsist->addMember(address + 100, true);
+    _dccexProtocol.functionOn(csConsist, 0);
+  }
+  EXPECT_EQ(LocoStateTable::getCachedCount(), 10);
+  EXPECT_EQ(_dccexProtocol.getLocalLocoEvictionCount(), 0);
+}
+
+/**
+ * @brief Test the least recently used library created Loco is evicted when the limit is reached
+ */
+TEST_F(CSConsistTests, TestLocalLocoCacheEvictsLeastRecentlyUsed) {
+  _dccexProtocol.setLocalLocoCacheSize(2);
+  CSConsist *first = _dccexProtocol.createCSConsist(3, false);
+  first->addMember(4, true);
+  CSConsist *second = _dccexProtocol.createCSConsist(5, false);
+  second->addMember(6, true);
+  CSConsist *third = _dccexProtocol.createCSConsist(7, false);
+  third->addMember(8, true);
+
+  _dccexProtocol.functionOn(first, 0);
+  _dccexProtocol.functionOn(second, 0);
+  // Use the first again so the second is the least recently used
+  _dccexProtocol.functionOff(first, 0);
+  _dccexProtocol.functionOn(third, 0);
+
+  EXPECT_EQ(LocoStateTable::getCachedCount(), 2);
+  EXPECT_EQ(_dccexProtocol.getLocalLocoEvictionCount(), 1);
+  EXPECT_NE(Loco::getByAddress(3), nullptr);
+  EXPECT_EQ(Loco::getByAddress(5), nullptr);
+  EXPECT_NE(Loco::getByAddress(7), nullptr);
+
+  // Reducing the limit evicts immediately
+  _dccexProtocol.setLocalLocoCacheSize(1);
+  EXPECT_EQ(Loco::getByAddress(3), nullptr);
+  EXPECT_NE(Loco::getByAddress(7), nullptr);
+  EXPECT_EQ(_dccexProtocol.getLocalLocoEvictionCount(), 2);
+}
+
+/**
+ * @brief Test application created Locos and Locos with pending changes are never evicted
+ */
+TEST_F(CSConsistTests, TestLocalLocoCacheKeepsApplicationAndPendingLocos) {
+  Loco *appLoco = new Loco(3, LocoSource::LocoSourceEntry);
+  _dccexProtocol.setLocalLocoCacheSize(1);
+  CSConsist *first = _dccexProtocol.createCSConsist(3, false);
+  first->addMember(4, true);
+  CSConsist *second = _dccexProtocol.createCSConsist(5, false);
+  second->addMember(6, true);
+  CSConsist *third = _dccexProtocol.createCSConsist(7, false);
+  third->addMember(8, true);
+
+  // Application Loco is used but not cached
+  _dccexProtocol.functionOn(first, 0);
+  EXPECT_FALSE(LocoStateTable::isCached(appLoco->getStateSlot()));
+  EXPECT_EQ(LocoStateTable::getCachedCount(), 0);
+
+  // Pending throttle change keeps the cached Loco, so the cache is allowed to exceed its limit
+  _dccexProtocol.setThrottle(second, 10, Forward);
+  _dccexProtocol.functionOn(third, 0);
+  EXPECT_EQ(Loco::getByAddress(3), appLoco);
+  EXPECT_NE(Loco::getByAddress(5), nullptr);
+  EXPECT_NE(Loco::getByAddress(7), nullptr);
+  EXPECT_EQ(_dccexProtocol.getLocalLocoEvictionCount(), 0);
+}
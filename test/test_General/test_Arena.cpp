@@ -0,0 +1,194 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+/**
+ * @brief Test the basic ListArena allocation, ownership, and reset behaviour
+ */
+TEST_F(DCCEXProtocolTests, TestListArenaBasics) {
+  ListArena arena;
+  EXPECT_FALSE(arena.isEnabled());
+  EXPECT_EQ(arena.allocate(8), nullptr);
+
+  ASSERT_TRUE(arena.begin(64));
+  EXPECT_EQ(arena.getCapacity(), 64);
+  EXPECT_EQ(arena.getBytesUsed(), 0);
+
+  // Single byte allocation followed by an aligned one should pad
+  void *first = arena.allocate(1, 1);
+  void *second = arena.allocate(8);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ((uintptr_t)second % ARENA_ALIGNMENT, 0);
+  EXPECT_TRUE(arena.owns(first));
+  EXPECT_TRUE(arena.owns(second));
+  EXPECT_GE(arena.getBytesUsed(), 9);
+
+  // Too large an allocation fails and is counted
+  EXPECT_EQ(arena.allocate(100), nullptr);
+  EXPECT_EQ(arena.getOverflowCount(), 1);
+
+  // Reset frees everything in one step
+  arena.reset();
+  EXPECT_EQ(arena.getBytesUsed(), 0);
+  EXPECT_EQ(arena.getOverflowCount(), 0);
+
+  // Heap pointers are not owned
+  int *heap = new int;
+  EXPECT_FALSE(arena.owns(heap));
+  delete heap;
+}
+
+/**
+ * @brief Test a caller-provided buffer is used as the arena
+ */
+TEST_F(DCCEXProtocolTests, TestListArenaCallerBuffer) {
+  uint8_t buffer[32];
+  ListArena arena;
+  ASSERT_TRUE(arena.begin(buffer, sizeof(buffer)));
+  char *copy = ListArena::copyString(&arena, buffer, "Test");
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(arena.owns(copy));
+  EXPECT_STREQ(copy, "Test");
+
+  // Strings for owners outside the arena use the heap
+  int owner;
+  char *heapCopy = ListArena::copyString(&arena, &owner, "Heap");
+  EXPECT_FALSE(arena.owns(heapCopy));
+  EXPECT_STREQ(heapCopy, "Heap");
+  ListArena::freeString(&arena, heapCopy);
+  ListArena::freeString(&arena, copy);
+
+  EXPECT_FALSE(arena.begin(nullptr, 10));
+  EXPECT_FALSE(arena.isEnabled());
+}
+
+/**
+ * @brief Test the roster is allocated from the arena and freed in one step when cleared
+ */
+TEST_F(DCCEXProtocolTests, TestRosterArena) {
+  ASSERT_TRUE(_dccexProtocol.enableArena(ArenaRoster, 4096));
+  EXPECT_EQ(_dccexProtocol.getArenaCapacity(ArenaRoster), 4096);
+  EXPECT_EQ(_dccexProtocol.getArenaBytesUsed(ArenaRoster), 0);
+
+  _dccexProtocol.getLists(true, false, false, false);
+  _stream << "<jR 42 9>";
+  _dccexProtocol.check();
+  _stream << R"(<jR 42 "Loco42" "Lights/*Horn">)";
+  _dccexProtocol.check();
+  _stream << R"(<jR 9 "Loco9" "Lights/Bell">)";
+  EXPECT_CALL(_delegate, receivedRosterList()).Times(Exactly(1));
+  _dccexProtocol.check();
+
+  // Objects, names, and labels all live in the arena
+  Loco *loco42 = _dccexProtocol.findLocoInRoster(42);
+  ASSERT_NE(loco42, nullptr);
+  ListArena *arena = Loco::getArena();
+  ASSERT_NE(arena, nullptr);
+  EXPECT_TRUE(arena->owns(loco42));
+  EXPECT_TRUE(arena->owns(loco42->getName()));
+  EXPECT_TRUE(arena->owns(loco42->getFunctionName(1)));
+  EXPECT_STREQ(loco42->getName(), "Loco42");
+  EXPECT_STREQ(loco42->getFunctionName(1), "Horn");
+  EXPECT_TRUE(loco42->isFunctionMomentary(1));
+  EXPECT_GT(_dccexProtocol.getArenaBytesUsed(ArenaRoster), 2 * sizeof(Loco));
+
+  // Local locos are never carved from the roster arena
+  Loco *localLoco = new Loco(3, LocoSourceEntry);
+  localLoco->setName("Local");
+  EXPECT_FALSE(arena->owns(localLoco));
+  EXPECT_FALSE(arena->owns(localLoco->getName()));
+
+  // Clearing frees the whole arena
+  _dccexProtocol.clearRoster();
+  EXPECT_EQ(_dccexProtocol.getArenaBytesUsed(ArenaRoster), 0);
+  EXPECT_EQ(Loco::getFirstLocalLoco(), localLoco);
+
+  // Disabling returns to the heap
+  _dccexProtocol.disableArena(ArenaRoster);
+  EXPECT_EQ(Loco::getArena(), nullptr);
+  EXPECT_EQ(_dccexProtocol.getArenaCapacity(ArenaRoster), 0);
+}
+
+/**
+ * @brief Test objects fall back to the heap when the arena is full
+ */
+TEST_F(DCCEXProtocolTests, TestArenaOverflowFallsBackToHeap) {
+  ASSERT_TRUE(_dccexProtocol.enableArena(ArenaTurnouts, sizeof(Turnout)));
+
+  _dccexProtocol.getLists(false, true, false, false);
+  _stream << "<jT 100 101>";
+  _dccexProtocol.check();
+  _stream << R"(<jT 100 C "Turnout 100">)";
+  _dccexProtocol.check();
+  _stream << R"(<jT 101 T "Turnout 101">)";
+  EXPECT_CALL(_delegate, receivedTurnoutList()).Times(Exactly(1));
+  _dccexProtocol.check();
+
+  EXPECT_EQ(_dccexProtocol.getTurnoutCount(), 2);
+  EXPECT_GT(_dccexProtocol.getArenaOverflowCount(ArenaTurnouts), 0);
+  Turnout *turnout100 = _dccexProtocol.getTurnoutById(100);
+  Turnout *turnout101 = _dccexProtocol.getTurnoutById(101);
+  ASSERT_NE(turnout100, nullptr);
+  ASSERT_NE(turnout101, nullptr);
+  EXPECT_TRUE(Turnout::getArena()->owns(turnout100));
+  EXPECT_FALSE(Turnout::getArena()->owns(turnout101));
+  EXPECT_STREQ(turnout100->getName(), "Turnout 100");
+  EXPECT_STREQ(turnout101->getName(), "Turnout 101");
+
+  // Mixed arena/heap lists clean up correctly
+  _dccexProtocol.clearTurnoutList();
+  EXPECT_EQ(_dccexProtocol.getArenaBytesUsed(ArenaTurnouts), 0);
+}
+
+/**
+ * @brief Test turntables and their indexes are allocated from a caller-provided arena
+ */
+TEST_F(DCCEXProtocolTests, TestTurntableArenaCallerBuffer) {
+  static uint8_t buffer[1024];
+  ASSERT_TRUE(_dccexProtocol.enableArena(ArenaTurntables, buffer, sizeof(buffer)));
+
+  _dccexProtocol.getLists(false, false, false, true);
+  _stream << "<jO 1>";
+  _dccexProtocol.check();
+  _stream << R"(<jO 1 1 0 2 "EX-Turntable">)";
+  _dccexProtocol.check();
+  _stream << R"(<jP 1 0 900 "Home">)";
+  _dccexProtocol.check();
+  _stream << R"(<jP 1 1 450 "Position 1">)";
+  EXPECT_CALL(_delegate, receivedTurntableList()).Times(Exactly(1));
+  _dccexProtocol.check();
+
+  Turntable *turntable = _dccexProtocol.getTurntableById(1);
+  ASSERT_NE(turntable, nullptr);
+  TurntableIndex *index = turntable->getIndexById(1);
+  ASSERT_NE(index, nullptr);
+  EXPECT_TRUE(Turntable::getArena()->owns(turntable));
+  EXPECT_TRUE(Turntable::getArena()->owns(index));
+  EXPECT_TRUE(Turntable::getArena()->owns(index->getName()));
+  EXPECT_STREQ(index->getName(), "Position 1");
+
+  _dccexProtocol.disableArena(ArenaTurntables);
+  EXPECT_EQ(_dccexProtocol.getTurntableCount(), 0);
+  EXPECT_EQ(Turntable::getArena(), nullptr);
+}
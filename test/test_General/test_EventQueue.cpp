@@ -0,0 +1,113 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+/**
+ * @brief Test events are queued instead of calling the delegate, and replayed with their own copy of any text
+ */
+TEST_F(DCCEXProtocolTests, TestEventQueueRecordsAndProcesses) {
+  ASSERT_TRUE(_dccexProtocol.enableEventQueue(8));
+  EXPECT_TRUE(_dccexProtocol.isEventQueueEnabled());
+
+  // Nothing is called while parsing
+  EXPECT_CALL(_delegate, receivedMessage(_)).Times(0);
+  EXPECT_CALL(_delegate, receivedTrackPower(_)).Times(0);
+  _stream << R"(<m "Hello World"><p1><m "Second">)";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getEventCount(), 3);
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  // Events are replayed in order, up to the maximum requested
+  {
+    InSequence sequence;
+    EXPECT_CALL(_delegate, receivedMessage(StrEq("Hello World"))).Times(Exactly(1));
+    EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOn)).Times(Exactly(1));
+  }
+  EXPECT_EQ(_dccexProtocol.processEvents(2), 2);
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  EXPECT_CALL(_delegate, receivedMessage(StrEq("Second"))).Times(Exactly(1));
+  EXPECT_EQ(_dccexProtocol.processEvents(), 1);
+  EXPECT_EQ(_dccexProtocol.getEventCount(), 0);
+  EXPECT_EQ(_dccexProtocol.getPeakEventCount(), 3);
+
+  // Disabling calls the delegate directly again
+  _dccexProtocol.disableEventQueue();
+  EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOff)).Times(Exactly(1));
+  _stream << "<p0>";
+  _dccexProtocol.check();
+}
+
+/**
+ * @brief Test events can be drained directly from a caller-provided queue, and overflow is counted
+ */
+TEST_F(DCCEXProtocolTests, TestEventQueueCallerBufferOverflow) {
+  static DCCEXEvent events[2];
+  for (int id = 100; id <= 102; id++) {
+    new Turnout(id, false);
+  }
+  ASSERT_TRUE(_dccexProtocol.enableEventQueue(events, 2));
+
+  _stream << R"(<H 100 1><H 101 0><H 102 1>)";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getEventCount(), 2);
+  EXPECT_EQ(_dccexProtocol.getEventOverflowCount(), 1);
+
+  DCCEXEvent event;
+  ASSERT_TRUE(_dccexProtocol.getNextEvent(event));
+  EXPECT_EQ(event.type, EventTurnoutAction);
+  EXPECT_EQ(event.values[0], 100);
+  EXPECT_EQ(event.values[1], 1);
+  ASSERT_TRUE(_dccexProtocol.getNextEvent(event));
+  EXPECT_EQ(event.values[0], 101);
+  EXPECT_EQ(event.values[1], 0);
+  EXPECT_FALSE(_dccexProtocol.getNextEvent(event));
+
+  // The ring wraps around once drained
+  _stream << R"(<m "A message longer than the event text is truncated to fit in the event without overflowing">)";
+  _dccexProtocol.check();
+  ASSERT_TRUE(_dccexProtocol.getNextEvent(event));
+  EXPECT_EQ(event.type, EventMessage);
+  EXPECT_EQ(strlen(event.text), DCCEX_EVENT_TEXT_LENGTH - 1);
+  EXPECT_EQ(strncmp(event.text, "A message longer", 16), 0);
+}
+
+/**
+ * @brief Test a queued Loco update is skipped if the Loco is deleted before it is processed
+ */
+TEST_F(DCCEXProtocolTests, TestEventQueueSkipsDeletedLoco) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  Loco *loco120 = new Loco(120, LocoSource::LocoSourceEntry);
+  ASSERT_TRUE(_dccexProtocol.enableEventQueue(8));
+
+  _stream << "<l 42 0 150 1><l 120 0 12 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getEventCount(), 4);
+  delete loco42;
+
+  EXPECT_CALL(_delegate, receivedLocoUpdate(_)).Times(0);
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco120)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(42, 21, Direction::Forward, 1)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(120, 11, Direction::Reverse, 0)).Times(Exactly(1));
+  EXPECT_EQ(_dccexProtocol.processEvents(), 4);
+}
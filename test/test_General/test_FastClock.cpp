@@ -67,3 +67,92 @@ TEST_F(DCCEXProtocolTests, TestInvalidFastClockTimeAndSpeed) {
   _dccexProtocol.setFastClock(2000, 4);
   EXPECT_EQ(_stream.getOutput(), "");
 }
+
+static void recordTick(int minutes, void *context) {
+  std::vector<int> *ticks = static_cast<std::vector<int> *>(context);
+  ticks->push_back(minutes);
+}
+
+/**
+ * @brief Test the fast clock is interpolated locally from the last time received
+ */
+TEST_F(DCCEXProtocolTests, TestFastClockInterpolation) {
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), -1);
+
+  // 1am at 4 times speed, a fast minute every 15 seconds
+  EXPECT_CALL(_delegate, receivedSetFastClock(60, 4));
+  _stream << "<jC 60 4>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 60);
+  EXPECT_EQ(_dccexProtocol.getFastClockSpeed(), 4);
+
+  advanceMillis(14999);
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 60);
+  advanceMillis(1);
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 61);
+
+  // Wraps at midnight
+  advanceMillis(15000UL * 1439);
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 60);
+
+  // Nothing was requested from the command station
+  EXPECT_EQ(_stream.getOutput(), "");
+}
+
+/**
+ * @brief Test a received time different to the local clock corrects it
+ */
+TEST_F(DCCEXProtocolTests, TestFastClockDriftCorrection) {
+  EXPECT_CALL(_delegate, receivedSetFastClock(60, 4));
+  EXPECT_CALL(_delegate, receivedFastClockTime(_)).Times(3);
+  _stream << "<jC 60 4>";
+  _dccexProtocol.check();
+
+  // Agreeing time keeps the anchor, so the next minute is still 15 seconds after the first
+  advanceMillis(7500);
+  _stream << "<jC 60>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getFastClockDrift(), 0);
+  advanceMillis(7500);
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 61);
+
+  // Command station is ahead
+  _stream << "<jC 63>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getFastClockDrift(), 2);
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 63);
+
+  // Behind, across midnight
+  _stream << "<jC 1439>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getFastClockDrift(), -64);
+  EXPECT_EQ(_dccexProtocol.getFastClockMinutes(), 1439);
+}
+
+/**
+ * @brief Test the tick function is called once per new fast minute
+ */
+TEST_F(DCCEXProtocolTests, TestFastClockTicks) {
+  std::vector<int> ticks;
+  _dccexProtocol.setFastClockTickCallback(recordTick, &ticks);
+
+  // No time yet, no ticks
+  _dccexProtocol.check();
+  EXPECT_TRUE(ticks.empty());
+
+  EXPECT_CALL(_delegate, receivedSetFastClock(600, 60));
+  _stream << "<jC 600 60>";
+  _dccexProtocol.check();
+  _dccexProtocol.check();
+
+  // A fast minute every second, with several missed minutes reported once
+  advanceMillis(1000);
+  _dccexProtocol.check();
+  advanceMillis(500);
+  _dccexProtocol.check();
+  advanceMillis(3500);
+  _dccexProtocol.check();
+
+  std::vector<int> expected = {600, 601, 605};
+  EXPECT_EQ(ticks, expected);
+}
@@ -0,0 +1,138 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+/**
+ * @brief Test appending and removing keeps head, tail, and count correct
+ */
+TEST_F(DCCEXProtocolTests, TestIntrusiveListAppendRemove) {
+  Turnout::clearTurnoutList();
+  const Turnout::List &list = Turnout::getList();
+  EXPECT_EQ(list.getFirst(), nullptr);
+  EXPECT_EQ(list.getLast(), nullptr);
+  EXPECT_EQ(list.getCount(), 0);
+
+  Turnout *turnout1 = new Turnout(1, false);
+  Turnout *turnout2 = new Turnout(2, false);
+  Turnout *turnout3 = new Turnout(3, false);
+  EXPECT_EQ(list.getFirst(), turnout1);
+  EXPECT_EQ(list.getLast(), turnout3);
+  EXPECT_EQ(list.getCount(), 3);
+
+  // Removing the tail moves it back
+  delete turnout3;
+  EXPECT_EQ(list.getLast(), turnout2);
+  EXPECT_EQ(turnout2->getNext(), nullptr);
+  EXPECT_EQ(list.getCount(), 2);
+
+  // Appending after removing the tail links correctly
+  Turnout *turnout4 = new Turnout(4, false);
+  EXPECT_EQ(turnout2->getNext(), turnout4);
+  EXPECT_EQ(list.getLast(), turnout4);
+
+  // Removing the head and a middle entry
+  delete turnout1;
+  EXPECT_EQ(list.getFirst(), turnout2);
+  delete turnout2;
+  EXPECT_EQ(list.getFirst(), turnout4);
+  EXPECT_EQ(list.getLast(), turnout4);
+  EXPECT_EQ(list.getCount(), 1);
+
+  delete turnout4;
+  EXPECT_EQ(list.getFirst(), nullptr);
+  EXPECT_EQ(list.getLast(), nullptr);
+  EXPECT_EQ(list.getCount(), 0);
+}
+
+/**
+ * @brief Test range-based for loops over object lists
+ */
+TEST_F(DCCEXProtocolTests, TestIntrusiveListRangeFor) {
+  Route *route1 = new Route(10);
+  Route *route2 = new Route(20);
+  Route *route3 = new Route(30);
+
+  int ids[3] = {0, 0, 0};
+  int count = 0;
+  for (Route *route : Route::getList()) {
+    ids[count++] = route->getId();
+  }
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(ids[0], 10);
+  EXPECT_EQ(ids[1], 20);
+  EXPECT_EQ(ids[2], 30);
+
+  // Deleting a middle object relinks its neighbours
+  delete route2;
+  count = 0;
+  for (Route *route : Route::getList()) {
+    EXPECT_NE(route, route2);
+    count++;
+  }
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(route1->getNext(), route3);
+
+  // Empty lists do not iterate
+  Route::clearRouteList();
+  for (Route *route : Route::getList()) {
+    ADD_FAILURE() << "Unexpected route " << route->getId();
+  }
+}
+
+/**
+ * @brief Test the deprecated setNext() relinks through the list, keeping the tail and count correct
+ */
+TEST_F(DCCEXProtocolTests, TestIntrusiveListDeprecatedSetNext) {
+  Turnout::clearTurnoutList();
+  const Turnout::List &list = Turnout::getList();
+  Turnout *turnout1 = new Turnout(1, false);
+  Turnout *turnout2 = new Turnout(2, false);
+  Turnout *turnout3 = new Turnout(3, false);
+  Turnout *turnout4 = new Turnout(4, false);
+
+  // Skipping an object drops it from the list
+  turnout1->setNext(turnout3);
+  EXPECT_EQ(turnout1->getNext(), turnout3);
+  EXPECT_EQ(list.getLast(), turnout4);
+  EXPECT_EQ(list.getCount(), 3);
+
+  // A loop is refused
+  turnout3->setNext(turnout1);
+  turnout3->setNext(turnout3);
+  EXPECT_EQ(turnout3->getNext(), turnout4);
+  EXPECT_EQ(list.getCount(), 3);
+
+  // Ending the list moves the tail back, and appending still links at the end
+  turnout3->setNext(nullptr);
+  EXPECT_EQ(list.getLast(), turnout3);
+  EXPECT_EQ(list.getCount(), 2);
+  Turnout *turnout5 = new Turnout(5, false);
+  EXPECT_EQ(turnout3->getNext(), turnout5);
+  EXPECT_EQ(list.getCount(), 3);
+
+  // Dropped objects are not in the list, so are deleted separately
+  delete turnout2;
+  delete turnout4;
+  EXPECT_EQ(list.getCount(), 3);
+  Turnout::clearTurnoutList();
+}
@@ -0,0 +1,135 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+/**
+ * @brief Test roster objects, names, and labels are reported separately from local Locos
+ */
+TEST_F(DCCEXProtocolTests, TestRosterMemoryUsage) {
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryRoster).totalBytes, 0);
+
+  _dccexProtocol.getLists(true, false, false, false);
+  _stream << "<jR 42 9>";
+  _dccexProtocol.check();
+  _stream << R"(<jR 42 "Loco42" "Lights/*Horn">)";
+  _dccexProtocol.check();
+  _stream << R"(<jR 9 "Loco9" "Lights/Bell">)";
+  EXPECT_CALL(_delegate, receivedRosterList()).Times(Exactly(1));
+  _dccexProtocol.check();
+
+  MemoryUsage roster = _dccexProtocol.getMemoryUsage(MemoryRoster);
+  EXPECT_EQ(roster.objectCount, 2);
+  EXPECT_EQ(roster.objectBytes, 2 * sizeof(Loco));
+  EXPECT_EQ(roster.nameBytes, strlen("Loco42") + 1 + strlen("Loco9") + 1);
+  // Each label list also holds an offset for each of its two labels
+  EXPECT_EQ(roster.labelBytes, strlen("Lights/*Horn") + 1 + strlen("Lights/Bell") + 1 + 4 * sizeof(uint16_t));
+  EXPECT_EQ(roster.totalBytes, roster.objectBytes + roster.nameBytes + roster.labelBytes);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryLocoState).bufferBytes, LocoStateTable::getBytesAllocated());
+
+  Loco *localLoco = new Loco(3, LocoSource::LocoSourceEntry);
+  localLoco->setName("Local");
+  MemoryUsage local = _dccexProtocol.getMemoryUsage(MemoryLocalLocos);
+  EXPECT_EQ(local.objectCount, 1);
+  EXPECT_EQ(local.nameBytes, strlen("Local") + 1);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryRoster).objectCount, 2);
+
+  // Clearing releases everything, but the peak remains
+  _dccexProtocol.clearRoster();
+  _dccexProtocol.clearLocalLocos();
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryRoster).totalBytes, 0);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryLocalLocos).totalBytes, 0);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryLocoState).totalBytes, 0);
+  MemoryUsage peak = _dccexProtocol.getPeakMemoryUsage(MemoryRoster);
+  EXPECT_EQ(peak.objectCount, 2);
+  EXPECT_EQ(peak.totalBytes, roster.totalBytes);
+
+  // Reconnecting resets the peaks to current usage
+  _dccexProtocol.connect(&_stream);
+  EXPECT_EQ(_dccexProtocol.getPeakMemoryUsage(MemoryRoster).totalBytes, 0);
+  EXPECT_EQ(_dccexProtocol.getPeakTotalMemoryBytes(), _dccexProtocol.getTotalMemoryBytes());
+}
+
+/**
+ * @brief Test turntable indexes stored in a reserved block are reported once, and unused space as a buffer
+ */
+TEST_F(DCCEXProtocolTests, TestTurntableMemoryUsage) {
+  _dccexProtocol.getLists(false, false, false, true);
+  _stream << "<jO 1>";
+  _dccexProtocol.check();
+  _stream << R"(<jO 1 1 0 2 "EX-Turntable">)";
+  _dccexProtocol.check();
+
+  MemoryUsage turntables = _dccexProtocol.getMemoryUsage(MemoryTurntables);
+  EXPECT_EQ(turntables.objectCount, 1);
+  EXPECT_EQ(turntables.nameBytes, strlen("EX-Turntable") + 1);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryTurntableIndexes).bufferBytes, 2 * sizeof(TurntableIndex));
+
+  _stream << R"(<jP 1 0 900 "Home">)";
+  _dccexProtocol.check();
+  _stream << R"(<jP 1 1 450 "Position 1">)";
+  EXPECT_CALL(_delegate, receivedTurntableList()).Times(Exactly(1));
+  _dccexProtocol.check();
+
+  MemoryUsage indexes = _dccexProtocol.getMemoryUsage(MemoryTurntableIndexes);
+  EXPECT_EQ(indexes.objectCount, 2);
+  EXPECT_EQ(indexes.objectBytes, 2 * sizeof(TurntableIndex));
+  EXPECT_EQ(indexes.bufferBytes, 0);
+  EXPECT_EQ(indexes.nameBytes, strlen("Home") + 1 + strlen("Position 1") + 1);
+
+  _dccexProtocol.clearTurntableList();
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryTurntables).totalBytes, 0);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryTurntableIndexes).totalBytes, 0);
+}
+
+/**
+ * @brief Test CSConsists, their members, and the member index are reported
+ */
+TEST_F(DCCEXProtocolTests, TestCSConsistMemoryUsage) {
+  CSConsist *csConsist = _dccexProtocol.createCSConsist(10, false);
+  _dccexProtocol.addCSConsistMember(csConsist, 11, false);
+
+  MemoryUsage csConsists = _dccexProtocol.getMemoryUsage(MemoryCSConsists);
+  EXPECT_EQ(csConsists.objectCount, 3);
+  EXPECT_EQ(csConsists.objectBytes, sizeof(CSConsist) + 2 * sizeof(CSConsistMember));
+  EXPECT_GT(csConsists.bufferBytes, 0);
+
+  _dccexProtocol.deleteCSConsist(csConsist);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryCSConsists).totalBytes, 0);
+}
+
+/**
+ * @brief Test the parser and outbound buffers are reported and included in the total
+ */
+TEST_F(DCCEXProtocolTests, TestBufferMemoryUsage) {
+  size_t total = _dccexProtocol.getTotalMemoryBytes();
+  EXPECT_GT(_dccexProtocol.getMemoryUsage(MemoryParser).bufferBytes, 0);
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryOutbound).bufferBytes, MAX_OUTBOUND_COMMAND_LENGTH);
+
+  {
+    DCCEXProtocol dccexProtocol(100, 10);
+    EXPECT_GT(_dccexProtocol.getTotalMemoryBytes(), total);
+  }
+
+  // Subsystems outside the enum report nothing
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage((MemorySubsystem)MEMORY_SUBSYSTEM_COUNT).totalBytes, 0);
+}
@@ -0,0 +1,97 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+/**
+ * @brief Test observers only receive the event types they subscribe to, while the delegate receives everything
+ */
+TEST_F(DCCEXProtocolTests, TestObserversReceiveSubscribedEvents) {
+  MockDCCEXProtocolDelegate display;
+  MockDCCEXProtocolDelegate logger;
+  ASSERT_TRUE(_dccexProtocol.addObserver(&display, (1UL << EventTrackPower)));
+  ASSERT_TRUE(_dccexProtocol.addObserver(&logger));
+  new Turnout(100, false);
+
+  EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOn)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedTurnoutAction(100, true)).Times(Exactly(1));
+  EXPECT_CALL(display, receivedTrackPower(TrackPower::PowerOn)).Times(Exactly(1));
+  EXPECT_CALL(display, receivedTurnoutAction(_, _)).Times(0);
+  EXPECT_CALL(logger, receivedTrackPower(TrackPower::PowerOn)).Times(Exactly(1));
+  EXPECT_CALL(logger, receivedTurnoutAction(100, true)).Times(Exactly(1));
+  _stream << "<p1><H 100 1>";
+  _dccexProtocol.check();
+  Mock::VerifyAndClearExpectations(&_delegate);
+  Mock::VerifyAndClearExpectations(&display);
+  Mock::VerifyAndClearExpectations(&logger);
+
+  // Adding again changes the subscription, removing stops all events
+  ASSERT_TRUE(_dccexProtocol.addObserver(&display, (1UL << EventTurnoutAction)));
+  ASSERT_TRUE(_dccexProtocol.removeObserver(&logger));
+  EXPECT_FALSE(_dccexProtocol.removeObserver(&logger));
+  EXPECT_CALL(_delegate, receivedTurnoutAction(100, false)).Times(Exactly(1));
+  EXPECT_CALL(display, receivedTurnoutAction(100, false)).Times(Exactly(1));
+  EXPECT_CALL(logger, receivedTurnoutAction(_, _)).Times(0);
+  _stream << "<H 100 0>";
+  _dccexProtocol.check();
+}
+
+/**
+ * @brief Test the subscribed mask follows the delegate and observers, and objects are updated with no subscribers
+ */
+TEST_F(DCCEXProtocolTests, TestObserverSubscribedEventMask) {
+  MockDCCEXProtocolDelegate observers[MAX_OBSERVERS + 1];
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), EVENT_MASK_ALL);
+
+  _dccexProtocol.setDelegate(nullptr);
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), 0);
+  Turnout *turnout = new Turnout(100, false);
+  _stream << "<H 100 1>";
+  _dccexProtocol.check();
+  EXPECT_TRUE(turnout->getThrown());
+
+  for (int index = 0; index < MAX_OBSERVERS; index++) {
+    EXPECT_TRUE(_dccexProtocol.addObserver(&observers[index], (1UL << index)));
+  }
+  EXPECT_FALSE(_dccexProtocol.addObserver(&observers[MAX_OBSERVERS]));
+  EXPECT_FALSE(_dccexProtocol.addObserver(nullptr));
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), (1UL << MAX_OBSERVERS) - 1);
+}
+
+/**
+ * @brief Test queued events are only recorded for the queue's mask and processed for subscribed observers
+ */
+TEST_F(DCCEXProtocolTests, TestObserversWithEventQueue) {
+  MockDCCEXProtocolDelegate display;
+  _dccexProtocol.setDelegate(nullptr);
+  ASSERT_TRUE(_dccexProtocol.addObserver(&display, (1UL << EventMessage)));
+  ASSERT_TRUE(_dccexProtocol.enableEventQueue(4, (1UL << EventMessage) | (1UL << EventTrackPower)));
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), (1UL << EventMessage) | (1UL << EventTrackPower));
+
+  _stream << R"(<m "Hello"><p1><@ 0 1 "Screen">)";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getEventCount(), 2);
+
+  EXPECT_CALL(display, receivedMessage(StrEq("Hello"))).Times(Exactly(1));
+  EXPECT_CALL(display, receivedTrackPower(_)).Times(0);
+  EXPECT_EQ(_dccexProtocol.processEvents(), 2);
+}
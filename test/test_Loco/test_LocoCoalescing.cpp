@@ -0,0 +1,90 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/LocoTests.h"
+
+/**
+ * @brief Test several broadcasts for one Loco in a single check() are delivered once with the latest state
+ */
+TEST_F(LocoTests, TestCoalescedLocoBroadcastsPerCheck) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceRoster);
+  _dccexProtocol.setLocoBroadcastCoalescing(true);
+  EXPECT_TRUE(_dccexProtocol.getLocoBroadcastCoalescing());
+
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedCoalescedLocoBroadcast(42, 31, Direction::Forward, 1, 3)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedCoalescedLocoBroadcast(120, 11, Direction::Reverse, 2, 1)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(_, _, _, _)).Times(0);
+  _stream << "<l 42 0 140 0><l 120 0 12 2><l 42 0 150 0><l 42 0 160 1>";
+  _dccexProtocol.check();
+
+  EXPECT_EQ(loco42->getSpeed(), 31);
+  EXPECT_EQ(loco42->isFunctionOn(0), true);
+  EXPECT_EQ(_dccexProtocol.getMergedLocoBroadcastCount(), 2);
+}
+
+/**
+ * @brief Test Loco state is updated for every broadcast while delivery waits for the interval
+ */
+TEST_F(LocoTests, TestCoalescedLocoBroadcastsInterval) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceRoster);
+  _dccexProtocol.setLocoBroadcastCoalescing(true, 100);
+
+  // Delivery waits for the interval from when coalescing was enabled
+  EXPECT_CALL(_delegate, receivedLocoUpdate(_)).Times(0);
+  EXPECT_CALL(_delegate, receivedCoalescedLocoBroadcast(_, _, _, _, _)).Times(0);
+  advanceMillis(50);
+  _stream << "<l 42 0 140 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(loco42->getSpeed(), 11);
+  _stream << "<l 42 0 150 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(loco42->getSpeed(), 21);
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedCoalescedLocoBroadcast(42, 21, Direction::Forward, 0, 2)).Times(Exactly(1));
+  advanceMillis(60);
+  _dccexProtocol.check();
+}
+
+/**
+ * @brief Test held broadcasts are delivered early when every slot is in use, and when coalescing is disabled
+ */
+TEST_F(LocoTests, TestCoalescedLocoBroadcastsDeliveredEarly) {
+  _dccexProtocol.setLocoBroadcastCoalescing(true, 1000);
+
+  EXPECT_CALL(_delegate, receivedCoalescedLocoBroadcast(_, _, _, _, 1)).Times(Exactly(COALESCED_LOCO_SLOTS));
+  for (int address = 1; address <= COALESCED_LOCO_SLOTS + 1; address++) {
+    _stream << "<l " + std::to_string(address) + " 0 140 0>";
+  }
+  _dccexProtocol.check();
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  // Disabling delivers the last one held, later broadcasts are delivered as received
+  EXPECT_CALL(_delegate, receivedCoalescedLocoBroadcast(COALESCED_LOCO_SLOTS + 1, 11, Direction::Forward, 0, 1))
+      .Times(Exactly(1));
+  _dccexProtocol.setLocoBroadcastCoalescing(false);
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(3, 11, Direction::Forward, 0)).Times(Exactly(1));
+  _stream << "<l 3 0 140 0>";
+  _dccexProtocol.check();
+}
@@ -54,3 +54,174 @@ TEST_F(LocoTests, TestIsFunctionOn) {
   _dccexProtocol.check();
   EXPECT_TRUE(_dccexProtocol.isFunctionOn(loco42, 0));
 }
+
+/**
+ * @brief Test single function states can be set across the full range without affecting other functions
+ */
+TEST_F(LocoTests, TestExtendedFunctionStates) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  EXPECT_EQ(MAX_FUNCTIONS, 69);
+
+  loco42->setFunctionState(0, true);
+  loco42->setFunctionState(31, true);
+  loco42->setFunctionState(68, true);
+  for (int function = 0; function < MAX_FUNCTIONS; function++) {
+    EXPECT_EQ(loco42->isFunctionOn(function), function == 0 || function == 31 || function == 68);
+  }
+  loco42->setFunctionState(31, false);
+  EXPECT_FALSE(loco42->isFunctionOn(31));
+  EXPECT_TRUE(loco42->isFunctionOn(68));
+
+  // Out of range functions are ignored and reported as off
+  loco42->setFunctionState(-1, true);
+  loco42->setFunctionState(MAX_FUNCTIONS, true);
+  EXPECT_FALSE(loco42->isFunctionOn(-1));
+  EXPECT_FALSE(loco42->isFunctionOn(MAX_FUNCTIONS));
+
+  // Broadcast function maps only replace F0 to F28
+  loco42->setFunctionStates(2);
+  EXPECT_FALSE(loco42->isFunctionOn(0));
+  EXPECT_TRUE(loco42->isFunctionOn(1));
+  EXPECT_TRUE(loco42->isFunctionOn(68));
+  EXPECT_EQ(loco42->getFunctionStates(), 2);
+}
+
+/**
+ * @brief Test functions above F28 are tracked locally as they are not included in broadcasts
+ */
+TEST_F(LocoTests, TestExtendedFunctionOnOff) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(Exactly(1));
+  _dccexProtocol.functionOn(loco42, 68);
+  EXPECT_EQ(_stream.getOutput(), "<F 42 68 1>");
+  EXPECT_TRUE(_dccexProtocol.isFunctionOn(loco42, 68));
+  _stream.clearOutput();
+
+  // A broadcast does not reset the locally tracked state
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(Exactly(1));
+  _stream << "<l 42 0 128 1>";
+  _dccexProtocol.check();
+  EXPECT_TRUE(loco42->isFunctionOn(0));
+  EXPECT_TRUE(loco42->isFunctionOn(68));
+
+  // Functions within the broadcast range wait for the broadcast
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(Exactly(1));
+  _dccexProtocol.functionOff(loco42, 0);
+  _dccexProtocol.functionOff(loco42, 68);
+  EXPECT_EQ(_stream.getOutput(), "<F 42 0 0><F 42 68 0>");
+  EXPECT_TRUE(loco42->isFunctionOn(0));
+  EXPECT_FALSE(loco42->isFunctionOn(68));
+}
+
+/**
+ * @brief Test momentary flags are set for functions above F31
+ */
+TEST_F(LocoTests, TestExtendedFunctionMomentary) {
+  std::string labels;
+  for (int i = 0; i < MAX_FUNCTIONS; i++) {
+    if (i > 0)
+      labels += "/";
+    labels += (i % 2) ? "*F" : "F";
+    labels += std::to_string(i);
+  }
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  loco42->setupFunctions(labels.c_str());
+  EXPECT_FALSE(loco42->isFunctionMomentary(66));
+  EXPECT_TRUE(loco42->isFunctionMomentary(67));
+  EXPECT_STREQ(loco42->getFunctionName(67), "F67");
+  EXPECT_FALSE(loco42->isFunctionMomentary(MAX_FUNCTIONS));
+}
+
+/**
+ * @brief Test function labels are stored contiguously and unlabelled functions return nullptr
+ */
+TEST_F(LocoTests, TestFunctionLabelsSingleBuffer) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  loco42->setupFunctions("Lights/*Horn//Bell");
+
+  // Labels are consecutive in one buffer
+  ASSERT_NE(loco42->getFunctionName(0), nullptr);
+  EXPECT_STREQ(loco42->getFunctionName(0), "Lights");
+  EXPECT_EQ(loco42->getFunctionName(1), loco42->getFunctionName(0) + strlen("Lights/*"));
+  EXPECT_STREQ(loco42->getFunctionName(1), "Horn");
+  EXPECT_STREQ(loco42->getFunctionName(2), "");
+  EXPECT_STREQ(loco42->getFunctionName(3), "Bell");
+  EXPECT_TRUE(loco42->isFunctionMomentary(1));
+  EXPECT_FALSE(loco42->isFunctionMomentary(3));
+
+  // Functions without labels, or outside the valid range, have no name
+  EXPECT_EQ(loco42->getFunctionName(4), nullptr);
+  EXPECT_EQ(loco42->getFunctionName(-1), nullptr);
+  EXPECT_EQ(loco42->getFunctionName(MAX_FUNCTIONS), nullptr);
+
+  // Setting up again replaces all labels and momentary flags
+  loco42->setupFunctions("Headlight");
+  EXPECT_STREQ(loco42->getFunctionName(0), "Headlight");
+  EXPECT_EQ(loco42->getFunctionName(1), nullptr);
+  EXPECT_FALSE(loco42->isFunctionMomentary(1));
+}
+
+/**
+ * @brief Test labels beyond the maximum number of functions are ignored
+ */
+TEST_F(LocoTests, TestFunctionLabelsBeyondMaxFunctions) {
+  std::string labels;
+  for (int i = 0; i <= MAX_FUNCTIONS; i++) {
+    if (i > 0)
+      labels += "/";
+    labels += "*F" + std::to_string(i);
+  }
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  loco42->setupFunctions(labels.c_str());
+
+  EXPECT_STREQ(loco42->getFunctionName(MAX_FUNCTIONS - 1), ("F" + std::to_string(MAX_FUNCTIONS - 1)).c_str());
+  EXPECT_TRUE(loco42->isFunctionMomentary(MAX_FUNCTIONS - 1));
+  EXPECT_EQ(loco42->getFunctionName(MAX_FUNCTIONS), nullptr);
+}
+
+/**
+ * @brief Test function labels are only decoded on first use when lazy function labels are enabled
+ */
+TEST_F(LocoTests, TestLazyFunctionLabels) {
+  EXPECT_FALSE(Loco::getLazyFunctionLabels());
+  Loco::setLazyFunctionLabels(true);
+  EXPECT_TRUE(Loco::getLazyFunctionLabels());
+
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  loco42->setupFunctions("Lights/*Horn/Bell");
+  Loco *loco43 = new Loco(43, LocoSource::LocoSourceEntry);
+  loco43->setupFunctions("*Whistle/Lights");
+
+  // Momentary flags are decoded on first use
+  EXPECT_TRUE(loco43->isFunctionMomentary(0));
+  EXPECT_FALSE(loco43->isFunctionMomentary(1));
+  EXPECT_STREQ(loco43->getFunctionName(1), "Lights");
+
+  // Names are decoded on first use
+  EXPECT_STREQ(loco42->getFunctionName(0), "Lights");
+  EXPECT_STREQ(loco42->getFunctionName(1), "Horn");
+  EXPECT_STREQ(loco42->getFunctionName(2), "Bell");
+  EXPECT_EQ(loco42->getFunctionName(3), nullptr);
+  EXPECT_TRUE(loco42->isFunctionMomentary(1));
+
+  // Setting up again defers decoding the new labels
+  loco42->setupFunctions("*Headlight");
+  EXPECT_STREQ(loco42->getFunctionName(0), "Headlight");
+  EXPECT_TRUE(loco42->isFunctionMomentary(0));
+  EXPECT_FALSE(loco42->isFunctionMomentary(1));
+  EXPECT_EQ(loco42->getFunctionName(1), nullptr);
+}
+
+/**
+ * @brief Test the label offsets are sized from the number of labels rather than the maximum number of functions
+ */
+TEST_F(LocoTests, TestFunctionLabelOffsetsSizedFromLabels) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceEntry);
+  MemoryUsage before = MemoryStats::getUsage(MemoryLocalLocos);
+  loco42->setupFunctions("Lights/*Horn/Bell");
+  MemoryUsage after = MemoryStats::getUsage(MemoryLocalLocos);
+  EXPECT_EQ(after.labelBytes - before.labelBytes, strlen("Lights/*Horn/Bell") + 1 + 3 * sizeof(uint16_t));
+  EXPECT_STREQ(loco42->getFunctionName(2), "Bell");
+  EXPECT_EQ(loco42->getFunctionName(3), nullptr);
+}
@@ -0,0 +1,103 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/LocoTests.h"
+
+/**
+ * @brief Test adding, removing, and clearing Loco addresses of interest
+ */
+TEST_F(LocoTests, TestLocoInterestBitmap) {
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(3));
+  EXPECT_TRUE(_dccexProtocol.addLocoInterest(3));
+  EXPECT_TRUE(_dccexProtocol.addLocoInterest(10239));
+  EXPECT_TRUE(_dccexProtocol.isLocoInterest(3));
+  EXPECT_TRUE(_dccexProtocol.isLocoInterest(10239));
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(4));
+
+  // Out of range addresses are never of interest
+  EXPECT_FALSE(_dccexProtocol.addLocoInterest(0));
+  EXPECT_FALSE(_dccexProtocol.addLocoInterest(10240));
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(-1));
+
+  _dccexProtocol.removeLocoInterest(3);
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(3));
+  EXPECT_TRUE(_dccexProtocol.isLocoInterest(10239));
+
+  _dccexProtocol.clearLocoInterest();
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(10239));
+}
+
+/**
+ * @brief Test broadcasts for uninteresting addresses are dropped when the filter is enabled
+ */
+TEST_F(LocoTests, TestLocoInterestFilterDropsBroadcasts) {
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceRoster);
+  Loco *loco120 = new Loco(120, LocoSource::LocoSourceRoster);
+  _dccexProtocol.addLocoInterest(42);
+  _dccexProtocol.setLocoInterestFilter(true);
+  EXPECT_TRUE(_dccexProtocol.getLocoInterestFilter());
+
+  // Only the interesting address is processed
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(42, 21, Direction::Forward, 1)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco120)).Times(0);
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(120, _, _, _)).Times(0);
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(355, _, _, _)).Times(0);
+  _stream << "<l 42 0 150 1><l 120 0 12 2><l 355 0 160 0>";
+  _dccexProtocol.check();
+
+  EXPECT_EQ(loco42->getSpeed(), 21);
+  EXPECT_EQ(loco120->getSpeed(), 0);
+  EXPECT_EQ(_dccexProtocol.getFilteredLocoBroadcastCount(), 2);
+}
+
+/**
+ * @brief Test every broadcast is processed when the filter is disabled, even with addresses of interest
+ */
+TEST_F(LocoTests, TestLocoInterestFilterDisabledByDefault) {
+  _dccexProtocol.addLocoInterest(42);
+  EXPECT_FALSE(_dccexProtocol.getLocoInterestFilter());
+
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(120, 11, Direction::Reverse, 2)).Times(Exactly(1));
+  _stream << "<l 120 0 12 2>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getFilteredLocoBroadcastCount(), 0);
+}
+
+/**
+ * @brief Test a caller-provided bitmap replaces any allocated one, and too small a bitmap is rejected
+ */
+TEST_F(LocoTests, TestLocoInterestBuffer) {
+  uint8_t bitmap[LOCO_INTEREST_BYTES];
+  memset(bitmap, 0xFF, sizeof(bitmap));
+  EXPECT_TRUE(_dccexProtocol.addLocoInterest(42));
+
+  // Addresses added before are discarded, and the bitmap starts empty
+  EXPECT_TRUE(_dccexProtocol.setLocoInterestBuffer(bitmap, sizeof(bitmap)));
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(42));
+  EXPECT_TRUE(_dccexProtocol.addLocoInterest(3));
+  EXPECT_EQ(bitmap[0], 1 << 3);
+
+  EXPECT_FALSE(_dccexProtocol.setLocoInterestBuffer(bitmap, sizeof(bitmap) - 1));
+  EXPECT_FALSE(_dccexProtocol.isLocoInterest(3));
+  EXPECT_FALSE(_dccexProtocol.setLocoInterestBuffer(nullptr, sizeof(bitmap)));
+}
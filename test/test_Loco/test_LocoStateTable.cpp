@@ -0,0 +1,120 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/LocoTests.h"
+
+/**
+ * @brief Test each Loco gets a dense slot, and slots stay dense when Locos are deleted
+ */
+TEST_F(LocoTests, TestLocoStateTableSlotsStayDense) {
+  EXPECT_EQ(LocoStateTable::getCount(), 0);
+  EXPECT_EQ(LocoStateTable::getBytesAllocated(), 0);
+
+  Loco *loco1 = new Loco(1, LocoSource::LocoSourceRoster);
+  Loco *loco2 = new Loco(2, LocoSource::LocoSourceEntry);
+  Loco *loco3 = new Loco(3, LocoSource::LocoSourceRoster);
+  EXPECT_EQ(LocoStateTable::getCount(), 3);
+  EXPECT_EQ(loco1->getStateSlot(), 0);
+  EXPECT_EQ(loco2->getStateSlot(), 1);
+  EXPECT_EQ(loco3->getStateSlot(), 2);
+  EXPECT_GT(LocoStateTable::getBytesAllocated(), 0);
+
+  // State follows the Loco when the last slot moves into the released one
+  loco3->setSpeed(30);
+  loco3->setDirection(Reverse);
+  loco3->setFunctionState(60, true);
+  delete loco1;
+  EXPECT_EQ(LocoStateTable::getCount(), 2);
+  EXPECT_EQ(loco3->getStateSlot(), 0);
+  EXPECT_EQ(LocoStateTable::getLoco(0), loco3);
+  EXPECT_EQ(loco3->getSpeed(), 30);
+  EXPECT_EQ(loco3->getDirection(), Reverse);
+  EXPECT_TRUE(loco3->isFunctionOn(60));
+  EXPECT_EQ(LocoStateTable::findAddress(3), 0);
+  EXPECT_EQ(LocoStateTable::findAddress(1), -1);
+  EXPECT_EQ(LocoStateTable::getLoco(2), nullptr);
+
+  // Clearing every Loco frees the table
+  Loco::clearRoster();
+  Loco::clearLocalLocos();
+  EXPECT_EQ(LocoStateTable::getCount(), 0);
+  EXPECT_EQ(LocoStateTable::getBytesAllocated(), 0);
+}
+
+/**
+ * @brief Test the table grows beyond its initial capacity and keeps state intact
+ */
+TEST_F(LocoTests, TestLocoStateTableGrows) {
+  const int locoCount = LOCO_STATE_MIN_CAPACITY * 4 + 1;
+  for (int address = 1; address <= locoCount; address++) {
+    Loco *loco = new Loco(address, LocoSource::LocoSourceRoster);
+    loco->setSpeed(address);
+  }
+  EXPECT_EQ(LocoStateTable::getCount(), locoCount);
+  for (int slot = 0; slot < locoCount; slot++) {
+    Loco *loco = LocoStateTable::getLoco(slot);
+    ASSERT_NE(loco, nullptr);
+    EXPECT_EQ(loco->getSpeed(), loco->getAddress());
+  }
+  EXPECT_EQ(LocoStateTable::getMovingCount(), locoCount);
+}
+
+/**
+ * @brief Test the pending change and moving scans reflect the Loco API
+ */
+TEST_F(LocoTests, TestLocoStateTableScans) {
+  Loco *loco1 = new Loco(1, LocoSource::LocoSourceRoster);
+  Loco *loco2 = new Loco(2, LocoSource::LocoSourceRoster);
+  Loco *loco3 = new Loco(3, LocoSource::LocoSourceEntry);
+  EXPECT_EQ(LocoStateTable::findUserChangePending(), -1);
+  EXPECT_EQ(LocoStateTable::getMovingCount(), 0);
+
+  loco2->setUserSpeed(10);
+  loco3->setUserDirection(Reverse);
+  EXPECT_EQ(LocoStateTable::findUserChangePending(), loco2->getStateSlot());
+  EXPECT_EQ(LocoStateTable::findUserChangePending(loco2->getStateSlot() + 1), loco3->getStateSlot());
+  EXPECT_EQ(loco3->getUserDirection(), Reverse);
+  EXPECT_EQ(loco3->getDirection(), Forward);
+
+  loco1->setSpeed(5);
+  loco2->setSpeed(10);
+  EXPECT_EQ(LocoStateTable::getMovingCount(), 2);
+
+  loco2->resetUserChangePending();
+  loco3->resetUserChangePending();
+  EXPECT_EQ(LocoStateTable::findUserChangePending(), -1);
+}
+
+/**
+ * @brief Test pending changes for roster and local Locos are all sent from the state table
+ */
+TEST_F(LocoTests, TestLocoStateTableSendsPendingChanges) {
+  Loco *loco1 = new Loco(1, LocoSource::LocoSourceRoster);
+  Loco *loco2 = new Loco(2, LocoSource::LocoSourceEntry);
+  _dccexProtocol.setThrottle(loco1, 10, Forward);
+  _dccexProtocol.setThrottle(loco2, 20, Reverse);
+
+  advanceMillis(200);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<t 1 10 1><t 2 20 0>");
+  EXPECT_EQ(LocoStateTable::findUserChangePending(), -1);
+}
@@ -110,3 +110,49 @@ TEST_F(LocoTests, TestLocoNotInRoster) {
   test = _dccexProtocol.findLocoInRoster(42);
   EXPECT_EQ(test, nullptr);
 }
+
+/**
+ * @brief Test a 2000 entry roster is loaded in order with constant time appends and counts
+ */
+TEST_F(LocoTests, parseRosterWith2000IDs) {
+  const int rosterSize = 2000;
+  DCCEXProtocol dccexProtocol(rosterSize * 6, rosterSize + 2);
+  dccexProtocol.setDelegate(&_delegate);
+  dccexProtocol.connect(&_stream);
+
+  std::string rosterList = "<jR";
+  for (int address = 1; address <= rosterSize; address++) {
+    rosterList += " " + std::to_string(address);
+  }
+  rosterList += ">";
+
+  dccexProtocol.getLists(true, false, false, false);
+  _stream.clearOutput();
+  _stream << rosterList;
+  dccexProtocol.check();
+
+  EXPECT_EQ(dccexProtocol.getRosterCount(), rosterSize);
+  EXPECT_EQ(Loco::getRosterList().getCount(), rosterSize);
+  EXPECT_EQ(Loco::getRosterList().getLast()->getAddress(), rosterSize);
+
+  // Respond to each entry request in turn
+  EXPECT_CALL(_delegate, receivedRosterList()).Times(Exactly(1));
+  for (int address = 1; address <= rosterSize; address++) {
+    _stream << "<jR " << std::to_string(address) << " \"Loco" << std::to_string(address) << "\" \"Lights\">";
+    dccexProtocol.check();
+  }
+  EXPECT_TRUE(dccexProtocol.receivedRoster());
+
+  // Range-based for visits every entry in the order received
+  int expectedAddress = 1;
+  for (Loco *loco : Loco::getRosterList()) {
+    ASSERT_EQ(loco->getAddress(), expectedAddress);
+    ASSERT_STREQ(loco->getName(), ("Loco" + std::to_string(expectedAddress)).c_str());
+    expectedAddress++;
+  }
+  EXPECT_EQ(expectedAddress, rosterSize + 1);
+
+  dccexProtocol.clearRoster();
+  EXPECT_EQ(Loco::getRosterList().getCount(), 0);
+  EXPECT_EQ(Loco::getRosterList().getLast(), nullptr);
+}
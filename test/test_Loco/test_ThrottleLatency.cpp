@@ -0,0 +1,109 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/LocoTests.h"
+
+/**
+ * @brief Test a throttle command is timed until the broadcast confirming it
+ */
+TEST_F(LocoTests, TestThrottleLatencyRoundTrip) {
+  ASSERT_TRUE(_dccexProtocol.enableThrottleLatency(2));
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceRoster);
+  EXPECT_CALL(_delegate, receivedLocoUpdate(loco42)).Times(2);
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(42, _, _, _)).Times(2);
+
+  loco42->setUserSpeed(10);
+  advanceMillis(101);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<t 42 10 1>");
+
+  // A broadcast with another speed is not the confirmation
+  advanceMillis(20);
+  _stream << "<l 42 0 130 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getThrottleLatency()->getCount(), 0);
+
+  // Speed 10 forward confirms it
+  advanceMillis(15);
+  _stream << "<l 42 0 139 0>";
+  _dccexProtocol.check();
+
+  LatencyHistogram *all = _dccexProtocol.getThrottleLatency();
+  LatencyHistogram *perLoco = _dccexProtocol.getThrottleLatency(42);
+  ASSERT_NE(perLoco, nullptr);
+  EXPECT_EQ(all->getCount(), 1);
+  EXPECT_EQ(perLoco->getCount(), 1);
+  EXPECT_EQ(perLoco->getMax(), 35);
+  EXPECT_EQ(perLoco->getPercentile(50), 35);
+  EXPECT_EQ(_dccexProtocol.getThrottleLatency(24), nullptr);
+}
+
+/**
+ * @brief Test addresses beyond the entries available are counted but not timed
+ */
+TEST_F(LocoTests, TestThrottleLatencyUntracked) {
+  ThrottleLatencyEntry entries[1];
+  ASSERT_TRUE(_dccexProtocol.enableThrottleLatency(entries, 1));
+  Loco *loco42 = new Loco(42, LocoSource::LocoSourceRoster);
+  Loco *loco24 = new Loco(24, LocoSource::LocoSourceRoster);
+
+  loco42->setUserSpeed(10);
+  loco24->setUserSpeed(20);
+  advanceMillis(101);
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getThrottleLatencyUntracked(), 1);
+  EXPECT_NE(_dccexProtocol.getThrottleLatency(42), nullptr);
+  EXPECT_EQ(_dccexProtocol.getThrottleLatency(24), nullptr);
+
+  // Reset frees the entry for the next address sent
+  _dccexProtocol.resetThrottleLatency();
+  EXPECT_EQ(_dccexProtocol.getThrottleLatency(42), nullptr);
+
+  _dccexProtocol.disableThrottleLatency();
+  EXPECT_EQ(_dccexProtocol.getThrottleLatency(), nullptr);
+}
+
+/**
+ * @brief Test percentiles are estimated from the histogram buckets
+ */
+TEST_F(LocoTests, TestLatencyHistogramPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.getPercentile(50), 0);
+
+  // 90 fast responses and 10 slow ones
+  for (int i = 0; i < 90; i++) {
+    histogram.add(8);
+  }
+  for (int i = 0; i < 10; i++) {
+    histogram.add(180);
+  }
+
+  EXPECT_EQ(histogram.getCount(), 100);
+  EXPECT_EQ(histogram.getMean(), 25);
+  EXPECT_EQ(histogram.getPercentile(50), 10);
+  EXPECT_EQ(histogram.getPercentile(90), 10);
+  EXPECT_EQ(histogram.getPercentile(95), 180);
+  EXPECT_EQ(histogram.getPercentile(99), 180);
+  EXPECT_EQ(histogram.getMax(), 180);
+  EXPECT_EQ(histogram.getBucketCount(1), 90);
+  EXPECT_EQ(LatencyHistogram::getBucketLimit(1), 10);
+}
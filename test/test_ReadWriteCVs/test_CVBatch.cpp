@@ -0,0 +1,183 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/CVTests.h"
+#include "DCCEXCVBatch.h"
+
+/// @brief Progress reported to recordProgress()
+struct ProgressLog {
+  CVBatchProgress last;
+  int calls = 0;
+};
+
+static void recordProgress(const CVBatchProgress &progress, void *context) {
+  ProgressLog *log = (ProgressLog *)context;
+  log->last = progress;
+  log->calls++;
+}
+
+/**
+ * @brief Test a backup reads each CV as soon as the previous response arrives, and writes the results as text
+ */
+TEST_F(CVTests, TestCVBatchBackup) {
+  CVBatchEntry entries[4];
+  DCCEXCVBatch batch(&_dccexProtocol);
+  ProgressLog log;
+  ASSERT_TRUE(batch.begin(entries, 4));
+  EXPECT_EQ(batch.addRange(1, 3), 3);
+  EXPECT_TRUE(batch.addCV(29));
+  EXPECT_FALSE(batch.addCV(30));
+  ASSERT_TRUE(batch.startBackup(recordProgress, &log));
+  EXPECT_TRUE(batch.isRunning());
+  EXPECT_FALSE(batch.startBackup(recordProgress, &log));
+
+  // Only the first is sent, the next is queued behind it
+  EXPECT_EQ(_stream.getOutput(), "<R 1>");
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), CV_BATCH_PIPELINE_DEPTH);
+  advanceMillis(500);
+  _stream << "<v 1 3>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<R 1><R 2>");
+  _stream << "<v 2 0><v 3 -1><v 29 6>";
+  _dccexProtocol.check();
+  EXPECT_FALSE(batch.isRunning());
+  EXPECT_EQ(_stream.getOutput(), "<R 1><R 2><R 3><R 29>");
+
+  CVBatchProgress progress = batch.getProgress();
+  EXPECT_EQ(progress.total, 4);
+  EXPECT_EQ(progress.completed, 4);
+  EXPECT_EQ(progress.failed, 1);
+  EXPECT_EQ(progress.elapsed, 500);
+  EXPECT_EQ(progress.cvsPerMinute, 480);
+  EXPECT_EQ(batch.getEntry(0)->value, 3);
+  EXPECT_EQ(batch.getEntry(2)->status, CVBatchFailed);
+  EXPECT_EQ(batch.getEntry(3)->value, 6);
+  EXPECT_EQ(batch.getEntry(4), nullptr);
+  EXPECT_EQ(log.calls, 4);
+
+  Stream file;
+  EXPECT_EQ(batch.writeTo(&file), 3);
+  EXPECT_EQ(file.getOutput(), "# DCCEX CV backup: cv,value\r\n1,3\r\n2,0\r\n29,6\r\n");
+}
+
+/**
+ * @brief Test a restore writes the CVs read from text, and reports progress with an estimate of the time left
+ */
+TEST_F(CVTests, TestCVBatchRestore) {
+  DCCEXCVBatch batch(&_dccexProtocol);
+  ProgressLog log;
+  ASSERT_TRUE(batch.begin(8));
+
+  Stream file;
+  file << "# DCCEX CV backup: cv,value\r\n1,3\r\n\r\n29,6\nbad\n8,300\n2000,1\n3,4";
+  EXPECT_EQ(batch.readFrom(&file), 3);
+  ASSERT_TRUE(batch.startRestore(recordProgress, &log));
+  EXPECT_EQ(_stream.getOutput(), "<W 1 3>");
+
+  advanceMillis(1000);
+  _stream << "<r 1 3>";
+  _dccexProtocol.check();
+  EXPECT_EQ(log.calls, 1);
+  EXPECT_EQ(log.last.completed, 1);
+  EXPECT_EQ(log.last.eta, 2000);
+
+  _stream << "<r 29 -1><r 3 4>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<W 1 3><W 29 6><W 3 4>");
+  EXPECT_FALSE(batch.isRunning());
+  EXPECT_EQ(log.calls, 3);
+  EXPECT_EQ(log.last.completed, 3);
+  EXPECT_EQ(log.last.failed, 1);
+  EXPECT_EQ(log.last.eta, 0);
+  EXPECT_EQ(batch.getEntry(1)->status, CVBatchFailed);
+  EXPECT_EQ(batch.getEntry(2)->status, CVBatchDone);
+}
+
+/**
+ * @brief Test cancelling stops queueing, and the batch stops once queued operations complete
+ */
+TEST_F(CVTests, TestCVBatchCancel) {
+  CVBatchEntry entries[5];
+  DCCEXCVBatch batch(&_dccexProtocol);
+  ASSERT_TRUE(batch.begin(entries, 5));
+  batch.addRange(1, 5);
+  ASSERT_TRUE(batch.startBackup(nullptr));
+  batch.cancel();
+
+  _stream << "<v 1 1>";
+  _dccexProtocol.check();
+  EXPECT_TRUE(batch.isRunning());
+  _stream << "<v 2 2>";
+  _dccexProtocol.check();
+  EXPECT_FALSE(batch.isRunning());
+  EXPECT_EQ(_stream.getOutput(), "<R 1><R 2>");
+  EXPECT_EQ(batch.getProgress().completed, 2);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 0);
+}
+
+/**
+ * @brief Test a batch still completes when other tracked operations fill the table between its completions
+ */
+TEST_F(CVTests, TestCVBatchSharedTable) {
+  CVBatchEntry entries[4];
+  DCCEXCVBatch batch(&_dccexProtocol);
+  ASSERT_TRUE(batch.begin(entries, 4));
+  batch.addRange(1, 4);
+  ASSERT_TRUE(batch.startBackup(nullptr));
+  for (int cv = 10; _dccexProtocol.readCV(cv, nullptr) != -1; cv++) {
+  }
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), MAX_PENDING_CV_OPERATIONS);
+
+  // The first response frees the slot the batch queues CV 3 into, behind the other reads
+  _stream << "<v 1 1><v 2 2>";
+  _dccexProtocol.check();
+  for (int cv = 10; cv < 10 + MAX_PENDING_CV_OPERATIONS - CV_BATCH_PIPELINE_DEPTH; cv++) {
+    _stream << "<v " + std::to_string(cv) + " 0>";
+    _dccexProtocol.check();
+  }
+  _stream << "<v 3 3><v 4 4>";
+  _dccexProtocol.check();
+  EXPECT_FALSE(batch.isRunning());
+  EXPECT_EQ(batch.getProgress().failed, 0);
+  EXPECT_EQ(batch.getEntry(3)->value, 4);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 0);
+}
+
+/**
+ * @brief Test destroying a running batch cancels its operations, so later responses do not call back into it
+ */
+TEST_F(CVTests, TestCVBatchDestroyedWhileRunning) {
+  CVBatchEntry entries[4];
+  DCCEXCVBatch *batch = new DCCEXCVBatch(&_dccexProtocol);
+  ASSERT_TRUE(batch->begin(entries, 4));
+  batch->addRange(1, 4);
+  ASSERT_TRUE(batch->startBackup(nullptr));
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), CV_BATCH_PIPELINE_DEPTH);
+  delete batch;
+
+  // The sent read waits for its response, the queued one is removed
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 1);
+  _stream << "<v 1 3>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 0);
+  EXPECT_EQ(_stream.getOutput(), "<R 1>");
+}
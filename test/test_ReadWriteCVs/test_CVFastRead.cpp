@@ -0,0 +1,172 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/CVTests.h"
+
+static void recordFastRead(const CVOperation &operation, void *context) { *(CVOperation *)context = operation; }
+
+/**
+ * @brief Test a fast read sends every bit check at once, assembles the byte from replies in any order, then confirms it
+ */
+TEST_F(CVTests, TestCVFastRead) {
+  CVOperation result = {};
+  ASSERT_NE(_dccexProtocol.readCVFast(29, recordFastRead, &result), -1);
+  EXPECT_EQ(_stream.getOutput(), "<V 29 0 0><V 29 1 0><V 29 2 0><V 29 3 0><V 29 4 0><V 29 5 0><V 29 6 0><V 29 7 0>");
+  _stream.clearOutput();
+
+  // 0b00100110 = 38, with a reply for another CV ignored
+  _stream << "<v 29 7 0><v 29 2 1><v 1 1 1><v 29 0 0><v 29 5 1><v 29 1 1><v 29 6 0><v 29 4 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+  _stream << "<v 29 3 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 29 38>");
+  EXPECT_EQ(result.result, CVResultPending);
+
+  _stream << "<v 29 38>";
+  _dccexProtocol.check();
+  EXPECT_EQ(result.type, CVOpFastReadCV);
+  EXPECT_EQ(result.result, CVResultSuccess);
+  EXPECT_EQ(result.value, 38);
+  EXPECT_EQ(result.attempts, 1);
+}
+
+/**
+ * @brief Test a failed bit check retries the whole fast read once every bit check of the attempt has responded
+ */
+TEST_F(CVTests, TestCVFastReadRetry) {
+  CVOperation result = {};
+  _dccexProtocol.setCVOperationTimeout(5000, 1);
+  ASSERT_NE(_dccexProtocol.readCVFast(1, recordFastRead, &result), -1);
+  _stream.clearOutput();
+
+  // The remaining responses to the failed attempt are still in flight, so nothing is resent yet
+  _stream << "<v 1 0 -1><v 1 1 0><v 1 2 1><v 1 3 1><v 1 4 1><v 1 5 1><v 1 6 1>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+  _stream << "<v 1 7 1>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 1 0 0><V 1 1 0><V 1 2 0><V 1 3 0><V 1 4 0><V 1 5 0><V 1 6 0><V 1 7 0>");
+  _stream.clearOutput();
+
+  // Only responses to the new attempt make up the byte
+  _stream << "<v 1 0 1><v 1 1 1><v 1 2 0><v 1 3 0><v 1 4 0><v 1 5 0><v 1 6 0><v 1 7 0><v 1 3>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 1 3>");
+  EXPECT_EQ(result.result, CVResultSuccess);
+  EXPECT_EQ(result.value, 3);
+  EXPECT_EQ(result.attempts, 2);
+}
+
+/**
+ * @brief Test several failed bit checks in one attempt only use one retry
+ */
+TEST_F(CVTests, TestCVFastReadSeveralFailedBits) {
+  CVOperation result = {};
+  _dccexProtocol.setCVOperationTimeout(5000, 1);
+  ASSERT_NE(_dccexProtocol.readCVFast(1, recordFastRead, &result), -1);
+  _stream.clearOutput();
+
+  _stream << "<v 1 0 -1><v 1 1 0><v 1 2 -1><v 1 3 0><v 1 4 -1><v 1 5 0><v 1 6 0><v 1 7 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(result.result, CVResultPending);
+  EXPECT_EQ(_stream.getOutput(), "<V 1 0 0><V 1 1 0><V 1 2 0><V 1 3 0><V 1 4 0><V 1 5 0><V 1 6 0><V 1 7 0>");
+  _stream.clearOutput();
+
+  // The retry fails the same way, which completes the read as failed
+  _stream << "<v 1 0 -1><v 1 1 0><v 1 2 0><v 1 3 0><v 1 4 0><v 1 5 0><v 1 6 0><v 1 7 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+  EXPECT_EQ(result.result, CVResultFailed);
+  EXPECT_EQ(result.value, -1);
+  EXPECT_EQ(result.attempts, 2);
+  EXPECT_EQ(_dccexProtocol.getCVOperationStats().retries, 1UL);
+}
+
+/**
+ * @brief Test responses to a timed out attempt that arrive after the retry are ignored
+ */
+TEST_F(CVTests, TestCVFastReadLateResponsesAfterTimeout) {
+  CVOperation result = {};
+  _dccexProtocol.setCVOperationTimeout(1000, 1);
+  ASSERT_NE(_dccexProtocol.readCVFast(1, recordFastRead, &result), -1);
+
+  // Three bit checks are still due when the attempt times out
+  _stream << "<v 1 0 1><v 1 1 1><v 1 2 0><v 1 3 0><v 1 4 0>";
+  _dccexProtocol.check();
+  advanceMillis(1000);
+  _stream.clearOutput();
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 1 0 0><V 1 1 0><V 1 2 0><V 1 3 0><V 1 4 0><V 1 5 0><V 1 6 0><V 1 7 0>");
+  _stream.clearOutput();
+
+  // The late responses, one failed, arrive first and do not count towards the retry
+  _stream << "<v 1 5 -1><v 1 6 1><v 1 7 1>";
+  _dccexProtocol.check();
+  _stream << "<v 1 0 1><v 1 1 1><v 1 2 0><v 1 3 0><v 1 4 0><v 1 5 0><v 1 6 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+  _stream << "<v 1 7 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 1 3>");
+
+  _stream << "<v 1 3>";
+  _dccexProtocol.check();
+  EXPECT_EQ(result.result, CVResultSuccess);
+  EXPECT_EQ(result.value, 3);
+  EXPECT_EQ(result.attempts, 2);
+}
+
+/**
+ * @brief Test late responses to an attempt with no responses in time, and a late confirmation, are ignored by retries
+ */
+TEST_F(CVTests, TestCVFastReadLateConfirmationAfterTimeout) {
+  CVOperation result = {};
+  _dccexProtocol.setCVOperationTimeout(1000, 2);
+  ASSERT_NE(_dccexProtocol.readCVFast(1, recordFastRead, &result), -1);
+
+  // Nothing arrives in time for the first attempt, so all eight of its responses are ignored by the retry
+  advanceMillis(1000);
+  _dccexProtocol.check();
+  _stream.clearOutput();
+  _stream << "<v 1 0 0><v 1 1 0><v 1 2 0><v 1 3 0><v 1 4 0><v 1 5 0><v 1 6 0><v 1 7 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+  _stream << "<v 1 0 1><v 1 1 0><v 1 2 0><v 1 3 0><v 1 4 0><v 1 5 0><v 1 6 0><v 1 7 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 1 1>");
+
+  // The confirmation times out, and its late response is ignored by the third attempt
+  advanceMillis(1000);
+  _dccexProtocol.check();
+  _stream.clearOutput();
+  _stream << "<v 1 1>";
+  _dccexProtocol.check();
+  _stream << "<v 1 0 0><v 1 1 1><v 1 2 0><v 1 3 0><v 1 4 0><v 1 5 0><v 1 6 0><v 1 7 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<V 1 2>");
+  _stream << "<v 1 2>";
+  _dccexProtocol.check();
+  EXPECT_EQ(result.result, CVResultSuccess);
+  EXPECT_EQ(result.value, 2);
+  EXPECT_EQ(result.attempts, 3);
+}
@@ -0,0 +1,220 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/CVTests.h"
+
+/// @brief Completed operations recorded by recordCVOperation()
+struct CVOperationLog {
+  CVOperation operations[MAX_PENDING_CV_OPERATIONS + 1];
+  int count = 0;
+};
+
+static void recordCVOperation(const CVOperation &operation, void *context) {
+  CVOperationLog *log = (CVOperationLog *)context;
+  log->operations[log->count++] = operation;
+}
+
+/**
+ * @brief Test tracked operations are sent one at a time in order, and completed with the value and latency
+ */
+TEST_F(CVTests, TestCVOperationsSentInOrder) {
+  CVOperationLog log;
+  int readId = _dccexProtocol.readCV(29, recordCVOperation, &log);
+  int writeId = _dccexProtocol.writeCV(3, 10, recordCVOperation, &log);
+  EXPECT_EQ(writeId, readId + 1);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 2);
+  EXPECT_EQ(_stream.getOutput(), "<R 29>");
+  _stream.clearOutput();
+
+  // A response for another CV is not matched, the delegate is still called for both
+  EXPECT_CALL(_delegate, receivedValidateCV(1, 3)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedValidateCV(29, 6)).Times(Exactly(1));
+  advanceMillis(250);
+  _stream << "<v 1 3><v 29 6>";
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 1);
+  EXPECT_EQ(log.operations[0].id, readId);
+  EXPECT_EQ(log.operations[0].type, CVOpReadCV);
+  EXPECT_EQ(log.operations[0].result, CVResultSuccess);
+  EXPECT_EQ(log.operations[0].value, 6);
+  EXPECT_EQ(log.operations[0].attempts, 1);
+  EXPECT_EQ(log.operations[0].latency, 250);
+  EXPECT_EQ(_stream.getOutput(), "<W 3 10>");
+
+  // A -1 response fails the operation
+  _stream << "<r 3 -1>";
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 2);
+  EXPECT_EQ(log.operations[1].id, writeId);
+  EXPECT_EQ(log.operations[1].result, CVResultFailed);
+  EXPECT_EQ(log.operations[1].value, -1);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 0);
+
+  CVOperationStats stats = _dccexProtocol.getCVOperationStats();
+  EXPECT_EQ(stats.succeeded, 1);
+  EXPECT_EQ(stats.failed, 1);
+  EXPECT_EQ(stats.timedOut, 0);
+  EXPECT_EQ(stats.maxLatency, 250);
+  EXPECT_EQ(stats.totalLatency, 250);
+}
+
+/**
+ * @brief Test tracked operations are retried after a timeout or a failure, then complete
+ */
+TEST_F(CVTests, TestCVOperationRetries) {
+  CVOperationLog log;
+  _dccexProtocol.setCVOperationTimeout(1000, 1);
+  EXPECT_EQ(_dccexProtocol.getCVOperationTimeout(), 1000);
+  EXPECT_EQ(_dccexProtocol.getCVOperationRetries(), 1);
+
+  // Timed out twice
+  _dccexProtocol.readLoco(recordCVOperation, &log);
+  advanceMillis(999);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<R>");
+  advanceMillis(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<R><R>");
+  advanceMillis(1000);
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 1);
+  EXPECT_EQ(log.operations[0].result, CVResultTimeout);
+  EXPECT_EQ(log.operations[0].attempts, 2);
+  _stream.clearOutput();
+
+  // Late responses to both timed out attempts are ignored
+  EXPECT_CALL(_delegate, receivedReadLoco(-1)).Times(Exactly(2));
+  _stream << "<r -1><r -1>";
+  _dccexProtocol.check();
+  EXPECT_EQ(log.count, 1);
+
+  // Failed once, then succeeded
+  EXPECT_CALL(_delegate, receivedWriteLoco(_)).Times(Exactly(2));
+  _dccexProtocol.writeLocoAddress(1234, recordCVOperation, &log);
+  _stream << "<w -1>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<W 1234><W 1234>");
+  _stream << "<w 1234>";
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 2);
+  EXPECT_EQ(log.operations[1].result, CVResultSuccess);
+  EXPECT_EQ(log.operations[1].value, 1234);
+  EXPECT_EQ(log.operations[1].attempts, 2);
+
+  CVOperationStats stats = _dccexProtocol.getCVOperationStats();
+  EXPECT_EQ(stats.timedOut, 1);
+  EXPECT_EQ(stats.succeeded, 1);
+  EXPECT_EQ(stats.retries, 2);
+  _dccexProtocol.resetCVOperationStats();
+  EXPECT_EQ(_dccexProtocol.getCVOperationStats().retries, 0);
+}
+
+/**
+ * @brief Test a late response to a timed out attempt is ignored, so each response completes the operation it answers
+ */
+TEST_F(CVTests, TestCVOperationLateResponseAfterTimeout) {
+  CVOperationLog log;
+  _dccexProtocol.setCVOperationTimeout(1000, 1);
+  _dccexProtocol.readCV(1, recordCVOperation, &log);
+  _dccexProtocol.readCV(1, recordCVOperation, &log);
+  advanceMillis(1000);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<R 1><R 1>");
+  _stream.clearOutput();
+
+  // The response to the first attempt arrives after the retry was sent
+  EXPECT_CALL(_delegate, receivedValidateCV(1, 3)).Times(Exactly(2));
+  advanceMillis(200);
+  _stream << "<v 1 3>";
+  _dccexProtocol.check();
+  EXPECT_EQ(log.count, 0);
+  EXPECT_EQ(_stream.getOutput(), "");
+
+  // The response to the retry completes the first operation, timed from the retry
+  advanceMillis(300);
+  _stream << "<v 1 3>";
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 1);
+  EXPECT_EQ(log.operations[0].result, CVResultSuccess);
+  EXPECT_EQ(log.operations[0].value, 3);
+  EXPECT_EQ(log.operations[0].attempts, 2);
+  EXPECT_EQ(log.operations[0].latency, 500);
+  EXPECT_EQ(_stream.getOutput(), "<R 1>");
+
+  // The second operation is only completed by its own response
+  EXPECT_CALL(_delegate, receivedValidateCV(1, 4)).Times(Exactly(1));
+  advanceMillis(100);
+  _stream << "<v 1 4>";
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 2);
+  EXPECT_EQ(log.operations[1].result, CVResultSuccess);
+  EXPECT_EQ(log.operations[1].value, 4);
+  EXPECT_EQ(log.operations[1].attempts, 1);
+  EXPECT_EQ(log.operations[1].latency, 100);
+}
+
+/**
+ * @brief Test the table refuses operations when full, and untracked responses do not complete operations
+ */
+TEST_F(CVTests, TestCVOperationTableFull) {
+  CVOperationLog log;
+  for (int cv = 1; cv <= MAX_PENDING_CV_OPERATIONS; cv++) {
+    EXPECT_NE(_dccexProtocol.validateCVBit(cv, 0, 1, recordCVOperation, &log), -1);
+  }
+  EXPECT_EQ(_dccexProtocol.validateCV(1, 1, recordCVOperation, &log), -1);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), MAX_PENDING_CV_OPERATIONS);
+
+  // Wrong bit, then wrong response type, then the match
+  _stream << "<v 1 1 1><v 1 1><v 1 0 1>";
+  _dccexProtocol.check();
+  ASSERT_EQ(log.count, 1);
+  EXPECT_EQ(log.operations[0].type, CVOpValidateCVBit);
+  EXPECT_EQ(log.operations[0].cv, 1);
+  EXPECT_EQ(log.operations[0].value, 1);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), MAX_PENDING_CV_OPERATIONS - 1);
+  EXPECT_NE(_dccexProtocol.validateCV(1, 1, nullptr), -1);
+}
+
+/**
+ * @brief Test cancelling by context removes only that context's operations, and never calls their callbacks
+ */
+TEST_F(CVTests, TestCVOperationsCancelByContext) {
+  CVOperationLog cancelledLog;
+  CVOperationLog keptLog;
+  _dccexProtocol.readCV(1, recordCVOperation, &cancelledLog);
+  _dccexProtocol.readCV(2, recordCVOperation, &keptLog);
+  _dccexProtocol.readCV(3, recordCVOperation, &cancelledLog);
+  _dccexProtocol.readCV(4, recordCVOperation, &keptLog);
+  EXPECT_EQ(_dccexProtocol.cancelCVOperations(nullptr), 0);
+  EXPECT_EQ(_dccexProtocol.cancelCVOperations(&cancelledLog), 2);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 3);
+
+  // CV 1 was already sent, so its response is still consumed before CV 2 is sent
+  _stream << "<v 1 1><v 2 2><v 4 4>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<R 1><R 2><R 4>");
+  EXPECT_EQ(cancelledLog.count, 0);
+  ASSERT_EQ(keptLog.count, 2);
+  EXPECT_EQ(keptLog.operations[0].value, 2);
+  EXPECT_EQ(keptLog.operations[1].value, 4);
+  EXPECT_EQ(_dccexProtocol.getPendingCVOperationCount(), 0);
+}
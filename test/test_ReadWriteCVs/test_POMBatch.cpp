@@ -0,0 +1,74 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/CVTests.h"
+
+static void recordPOMBatch(int written, void *context) { *(int *)context = written; }
+
+/**
+ * @brief Test a batch sends one write per interval, with throttle commands in between, then reports completion
+ */
+TEST_F(CVTests, TestPOMBatchPaced) {
+  const POMWrite writes[] = {{3, 3, -1, 10}, {4, 3, -1, 10}, {5, 29, 5, 1}};
+  int written = -1;
+  ASSERT_TRUE(_dccexProtocol.writeCVsOnMain(writes, 3, 100, recordPOMBatch, &written));
+  EXPECT_TRUE(_dccexProtocol.isPOMBatchRunning());
+  EXPECT_FALSE(_dccexProtocol.writeCVsOnMain(writes, 3));
+
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<w 3 3 10>");
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<w 3 3 10>");
+
+  // Other commands go out between writes
+  _dccexProtocol.powerOn();
+  advanceMillis(100);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<w 3 3 10><1><w 4 3 10>");
+  EXPECT_EQ(_dccexProtocol.getPOMBatchWritten(), 2);
+  EXPECT_EQ(written, -1);
+
+  advanceMillis(100);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<w 3 3 10><1><w 4 3 10><b 5 29 5 1>");
+  EXPECT_FALSE(_dccexProtocol.isPOMBatchRunning());
+  EXPECT_EQ(written, 3);
+}
+
+/**
+ * @brief Test cancelling a batch stops it and reports the writes sent, and invalid batches are refused
+ */
+TEST_F(CVTests, TestPOMBatchCancel) {
+  const POMWrite writes[] = {{3, 3, -1, 10}, {4, 3, -1, 10}};
+  int written = -1;
+  EXPECT_FALSE(_dccexProtocol.writeCVsOnMain(nullptr, 2));
+  EXPECT_FALSE(_dccexProtocol.writeCVsOnMain(writes, 0));
+
+  ASSERT_TRUE(_dccexProtocol.writeCVsOnMain(writes, 2, 100, recordPOMBatch, &written));
+  _dccexProtocol.check();
+  _dccexProtocol.cancelPOMBatch();
+  EXPECT_EQ(written, 1);
+  EXPECT_FALSE(_dccexProtocol.isPOMBatchRunning());
+  advanceMillis(100);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<w 3 3 10>");
+}
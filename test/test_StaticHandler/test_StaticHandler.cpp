@@ -0,0 +1,100 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+#include "../setup/TestHarnessNoDelegate.h"
+#include <DCCEXStaticHandler.h>
+
+// These tests only apply when built with a static handler, see the native_test_static_handler environment
+#ifdef DCCEX_STATIC_HANDLER
+
+/**
+ * @brief Test the handler mask only covers the event types the handler has methods for
+ */
+TEST_F(TestHarnessNoDelegate, TestStaticHandlerEventMask) {
+  uint32_t expected = (1UL << EventTrackPower) | (1UL << EventTurnoutAction) | (1UL << EventLocoBroadcast);
+  EXPECT_EQ(DCCEXStaticDispatch::handlerMask, expected);
+
+  TestStaticHandler handler;
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), 0);
+  _dccexProtocol.setStaticHandler(&handler);
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), expected);
+  _dccexProtocol.setStaticHandler(nullptr);
+  EXPECT_EQ(_dccexProtocol.getSubscribedEventMask(), 0);
+}
+
+/**
+ * @brief Test the handler is called directly with no delegate, and only for the event types it has methods for
+ */
+TEST_F(TestHarnessNoDelegate, TestStaticHandlerWithoutDelegate) {
+  TestStaticHandler handler;
+  _dccexProtocol.setStaticHandler(&handler);
+  new Turnout(100, false);
+
+  _stream << R"(<p1><H 100 1><m "Not handled">)";
+  _dccexProtocol.check();
+  EXPECT_EQ(handler.trackPower, PowerOn);
+  EXPECT_EQ(handler.trackPowerCount, 1);
+  EXPECT_EQ(handler.lastTurnoutId, 100);
+  EXPECT_TRUE(handler.lastTurnoutThrown);
+  EXPECT_TRUE(Turnout::getById(100)->getThrown());
+}
+
+/**
+ * @brief Test the handler and delegate both receive the events they want
+ */
+TEST_F(DCCEXProtocolTests, TestStaticHandlerWithDelegate) {
+  TestStaticHandler handler;
+  _dccexProtocol.setStaticHandler(&handler);
+
+  EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOff)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedMessage(StrEq("Hello"))).Times(Exactly(1));
+  _stream << R"(<p0><m "Hello">)";
+  _dccexProtocol.check();
+  EXPECT_EQ(handler.trackPower, PowerOff);
+  EXPECT_EQ(handler.trackPowerCount, 1);
+
+  // Removing the delegate leaves the handler
+  _dccexProtocol.setDelegate(nullptr);
+  _stream << "<p1>";
+  _dccexProtocol.check();
+  EXPECT_EQ(handler.trackPower, PowerOn);
+  EXPECT_EQ(handler.trackPowerCount, 2);
+}
+
+/**
+ * @brief Test a handler with only receivedCoalescedLocoBroadcast() receives uncoalesced broadcasts through it
+ */
+TEST_F(DCCEXProtocolTests, TestStaticHandlerLocoBroadcastFallback) {
+  TestStaticHandler handler;
+  _dccexProtocol.setStaticHandler(&handler);
+
+  EXPECT_CALL(_delegate, receivedLocoBroadcast(355, 31, Direction::Forward, 0)).Times(Exactly(1));
+  _stream << "<l 355 0 160 0>";
+  _dccexProtocol.check();
+  EXPECT_EQ(handler.lastLocoAddress, 355);
+  EXPECT_EQ(handler.lastLocoSpeed, 31);
+  EXPECT_EQ(handler.lastLocoDirection, Forward);
+  EXPECT_EQ(handler.lastLocoMergedCount, 1);
+}
+
+#endif // DCCEX_STATIC_HANDLER
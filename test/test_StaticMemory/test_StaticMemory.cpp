@@ -0,0 +1,172 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+// These tests only apply to the static memory profile, see the native_test_static environment
+#ifdef DCCEX_STATIC_MEMORY
+
+typedef StaticStringPool<DCCEX_STATIC_NAME_BYTES> NamePool;
+
+/**
+ * @brief Test roster Locos beyond the static pool capacity are refused and counted
+ */
+TEST_F(DCCEXProtocolTests, TestStaticLocoPoolOverflow) {
+  StaticPoolStats stats = _dccexProtocol.getStaticPoolStats(StaticPoolLocos);
+  EXPECT_EQ(stats.capacity, DCCEX_STATIC_LOCOS);
+  EXPECT_EQ(stats.used, 0);
+
+  _dccexProtocol.getLists(true, false, false, false);
+  _stream << "<jR 1 2 3 4 5 6>";
+  _dccexProtocol.check();
+
+  stats = _dccexProtocol.getStaticPoolStats(StaticPoolLocos);
+  EXPECT_EQ(stats.used, DCCEX_STATIC_LOCOS);
+  EXPECT_EQ(stats.overflowCount, 6 - DCCEX_STATIC_LOCOS);
+  EXPECT_EQ(_dccexProtocol.getStaticOverflowCount(), 6 - DCCEX_STATIC_LOCOS);
+  EXPECT_EQ(Loco::getRosterList().getCount(), DCCEX_STATIC_LOCOS);
+  EXPECT_EQ(LocoStateTable::getCount(), DCCEX_STATIC_LOCOS);
+
+  // A local Loco is also refused while the pool is full
+  Loco *localLoco = new Loco(10, LocoSource::LocoSourceEntry);
+  EXPECT_EQ(localLoco, nullptr);
+
+  // Clearing returns every slot to the pool
+  _dccexProtocol.clearRoster();
+  EXPECT_EQ(_dccexProtocol.getStaticPoolStats(StaticPoolLocos).used, 0);
+  localLoco = new Loco(10, LocoSource::LocoSourceEntry);
+  ASSERT_NE(localLoco, nullptr);
+  EXPECT_EQ(localLoco->getStateSlot(), 0);
+}
+
+/**
+ * @brief Test names beyond the static name pool are refused, and the pool is reclaimed when lists are cleared
+ */
+TEST_F(DCCEXProtocolTests, TestStaticNamePoolOverflow) {
+  _dccexProtocol.getLists(false, true, false, false);
+  _stream << "<jT 1 2>";
+  _dccexProtocol.check();
+  _stream << R"(<jT 1 C "Turnout 1 with a long name">)";
+  _dccexProtocol.check();
+  _stream << R"(<jT 2 C "Turnout 2 with a name too long for the pool">)";
+  EXPECT_CALL(_delegate, receivedTurnoutList()).Times(Exactly(1));
+  _dccexProtocol.check();
+
+  EXPECT_STREQ(_dccexProtocol.getTurnoutById(1)->getName(), "Turnout 1 with a long name");
+  EXPECT_EQ(_dccexProtocol.getTurnoutById(2)->getName(), nullptr);
+  StaticPoolStats stats = _dccexProtocol.getStaticPoolStats(StaticPoolNames);
+  EXPECT_EQ(stats.capacity, DCCEX_STATIC_NAME_BYTES);
+  EXPECT_EQ(stats.used, (int)NamePool::blockSize(strlen("Turnout 1 with a long name") + 1));
+  EXPECT_EQ(stats.overflowCount, 1);
+
+  _dccexProtocol.clearTurnoutList();
+  EXPECT_EQ(_dccexProtocol.getStaticPoolStats(StaticPoolNames).used, 0);
+}
+
+/**
+ * @brief Test renaming the most recently named object reuses its bytes
+ */
+TEST_F(DCCEXProtocolTests, TestStaticNamePoolRename) {
+  Loco *loco = new Loco(3, LocoSource::LocoSourceEntry);
+  ASSERT_NE(loco, nullptr);
+  loco->setName("First");
+  loco->setName("Second");
+  EXPECT_STREQ(loco->getName(), "Second");
+  EXPECT_EQ(_dccexProtocol.getStaticPoolStats(StaticPoolNames).used, (int)NamePool::blockSize(strlen("Second") + 1));
+}
+
+/**
+ * @brief Test renaming one object many times while another keeps its name never fills the pool
+ */
+TEST_F(DCCEXProtocolTests, TestStaticNamePoolRenameWithSurvivor) {
+  Loco *survivor = new Loco(3, LocoSource::LocoSourceEntry);
+  Loco *loco = new Loco(4, LocoSource::LocoSourceEntry);
+  ASSERT_NE(survivor, nullptr);
+  ASSERT_NE(loco, nullptr);
+  int overflowCount = _dccexProtocol.getStaticPoolStats(StaticPoolNames).overflowCount;
+  loco->setName("Renamed 0");
+  survivor->setName("Survivor");
+
+  char name[16];
+  for (int i = 1; i <= 100; i++) {
+    snprintf(name, sizeof(name), "Renamed %d", i % 10);
+    loco->setName(name);
+    ASSERT_STREQ(loco->getName(), name);
+  }
+  EXPECT_STREQ(survivor->getName(), "Survivor");
+  StaticPoolStats stats = _dccexProtocol.getStaticPoolStats(StaticPoolNames);
+  EXPECT_EQ(stats.overflowCount, overflowCount);
+  EXPECT_EQ(stats.used, (int)(NamePool::blockSize(strlen("Survivor") + 1) + NamePool::blockSize(strlen(name) + 1)));
+
+  // Releasing everything hands back the whole pool
+  delete loco;
+  delete survivor;
+  EXPECT_EQ(_dccexProtocol.getStaticPoolStats(StaticPoolNames).used, 0);
+}
+
+/**
+ * @brief Test CSConsists and their members are refused once their pools are full
+ */
+TEST_F(DCCEXProtocolTests, TestStaticCSConsistPoolOverflow) {
+  for (int i = 0; i < DCCEX_STATIC_CSCONSISTS; i++) {
+    EXPECT_NE(_dccexProtocol.createCSConsist(100 + i, false), nullptr);
+  }
+  EXPECT_EQ(_dccexProtocol.createCSConsist(200, false), nullptr);
+  EXPECT_EQ(_dccexProtocol.getStaticPoolStats(StaticPoolCSConsists).overflowCount, 1);
+
+  // Each CSConsist already holds its lead loco, so fill the remaining member slots
+  CSConsist *csConsist = CSConsist::getFirst();
+  int freeMembers = DCCEX_STATIC_CSCONSIST_MEMBERS - DCCEX_STATIC_CSCONSISTS;
+  for (int i = 0; i < freeMembers; i++) {
+    EXPECT_TRUE(_dccexProtocol.addCSConsistMember(csConsist, 300 + i, false));
+  }
+  _stream.clearOutput();
+  csConsist->addMember(400, false);
+  EXPECT_FALSE(csConsist->isInConsist(400));
+  EXPECT_EQ(_dccexProtocol.getStaticPoolStats(StaticPoolCSConsistMembers).overflowCount, 1);
+  EXPECT_EQ(CSConsist::getMemberCSConsist(300), csConsist);
+}
+
+/**
+ * @brief Test the command buffer and parameters are limited to the static sizes
+ */
+TEST_F(DCCEXProtocolTests, TestStaticCommandLimits) {
+  DCCEXProtocol dccexProtocol(DCCEX_STATIC_COMMAND_BUFFER * 2, DCCEX_STATIC_COMMAND_PARAMS * 2);
+  dccexProtocol.connect(&_stream);
+  _stream << "<@ 0 1 \"Static\">";
+  EXPECT_CALL(_delegate, receivedScreenUpdate(0, 1, StrEq("Static"))).Times(Exactly(1));
+  dccexProtocol.setDelegate(&_delegate);
+  dccexProtocol.check();
+}
+
+/**
+ * @brief Test the Loco address interest bitmap must be provided by the caller
+ */
+TEST_F(DCCEXProtocolTests, TestStaticLocoInterestBuffer) {
+  static uint8_t bitmap[LOCO_INTEREST_BYTES];
+  EXPECT_FALSE(_dccexProtocol.addLocoInterest(3));
+  EXPECT_TRUE(_dccexProtocol.setLocoInterestBuffer(bitmap, sizeof(bitmap)));
+  EXPECT_TRUE(_dccexProtocol.addLocoInterest(3));
+  EXPECT_TRUE(_dccexProtocol.isLocoInterest(3));
+}
+
+#endif // DCCEX_STATIC_MEMORY
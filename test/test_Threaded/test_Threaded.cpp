@@ -0,0 +1,167 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/DCCEXProtocolTests.h"
+
+// These tests only apply to the threaded build, see the native_test_threaded environment
+#ifdef DCCEX_THREADED
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Delegate recording the address of each Loco broadcast, in order
+class BroadcastRecorder : public DCCEXProtocolDelegate {
+public:
+  void receivedLocoBroadcast(int address, int speed, Direction direction, int functionMap) override {
+    (void)speed;
+    (void)direction;
+    (void)functionMap;
+    addresses.push_back(address);
+  }
+
+  std::vector<int> addresses;
+};
+
+/**
+ * @brief Test commands only move between the stream and check() when pollStream() is called
+ */
+TEST_F(DCCEXProtocolTests, TestThreadedCommandsPassThroughQueues) {
+  new Turnout(100, false);
+  size_t parserBytes = _dccexProtocol.getMemoryUsage(MemoryParser).bufferBytes;
+  ASSERT_TRUE(_dccexProtocol.enableThreading());
+  EXPECT_TRUE(_dccexProtocol.isThreadingEnabled());
+  EXPECT_EQ(_dccexProtocol.getMemoryUsage(MemoryParser).bufferBytes, parserBytes + 1024);
+
+  // Inbound commands wait for pollStream() to frame them
+  EXPECT_CALL(_delegate, receivedTrackPower(_)).Times(0);
+  _stream << "<p1><H 100 1>";
+  _dccexProtocol.check();
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOn)).Times(Exactly(1));
+  EXPECT_CALL(_delegate, receivedTurnoutAction(100, true)).Times(Exactly(1));
+  _dccexProtocol.pollStream();
+  _dccexProtocol.check();
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  // Outbound commands wait for pollStream() to write them
+  _dccexProtocol.powerOn();
+  EXPECT_EQ(_stream.getOutput(), "");
+  _dccexProtocol.pollStream();
+  EXPECT_EQ(_stream.getOutput(), "<1>");
+  _stream.clearOutput();
+
+  // Disabling returns the stream to check()
+  _dccexProtocol.disableThreading();
+  EXPECT_FALSE(_dccexProtocol.isThreadingEnabled());
+  EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOff)).Times(Exactly(1));
+  _stream << "<p0>";
+  _dccexProtocol.check();
+  _dccexProtocol.powerOff();
+  EXPECT_EQ(_stream.getOutput(), "<0>");
+}
+
+/**
+ * @brief Test commands that do not fit in caller-provided queues are dropped whole and counted
+ */
+TEST_F(DCCEXProtocolTests, TestThreadedQueueOverflow) {
+  char inbound[16];
+  char outbound[8];
+  EXPECT_FALSE(_dccexProtocol.enableThreading(nullptr, sizeof(inbound), outbound, sizeof(outbound)));
+  EXPECT_FALSE(_dccexProtocol.isThreadingEnabled());
+  ASSERT_TRUE(_dccexProtocol.enableThreading(inbound, sizeof(inbound), outbound, sizeof(outbound)));
+
+  // Each <p1> needs 5 bytes, and one byte is always kept free
+  EXPECT_CALL(_delegate, receivedTrackPower(TrackPower::PowerOn)).Times(Exactly(3));
+  _stream << "<p1><p1><p1><p1><p1>";
+  _dccexProtocol.pollStream();
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getInboundOverflowCount(), 2);
+
+  _dccexProtocol.powerOn();
+  _dccexProtocol.powerOff();
+  _dccexProtocol.pollStream();
+  EXPECT_EQ(_stream.getOutput(), "<1>");
+  EXPECT_EQ(_dccexProtocol.getOutboundOverflowCount(), 1);
+}
+
+/**
+ * @brief Test commands pass between an I/O thread and the application thread in order, with none lost or corrupted
+ */
+TEST_F(DCCEXProtocolTests, TestThreadedStress) {
+  const int inboundCount = 2000;
+  const int outboundCount = 2000;
+  BroadcastRecorder recorder;
+  _dccexProtocol.setDelegate(&recorder);
+  ASSERT_TRUE(_dccexProtocol.enableThreading(256, 128));
+
+  for (int address = 1; address <= inboundCount; address++) {
+    _stream << "<l " + std::to_string(address) + " 0 0 0>";
+  }
+
+  std::atomic<bool> stop(false);
+  std::thread io([this, &stop]() {
+    while (!stop.load()) {
+      _dccexProtocol.pollStream();
+      std::this_thread::yield();
+    }
+  });
+
+  int sent = 0;
+  while ((int)recorder.addresses.size() + (int)_dccexProtocol.getInboundOverflowCount() < inboundCount) {
+    if (sent < outboundCount) {
+      _dccexProtocol.sendCommand(std::to_string(sent++).c_str());
+    }
+    _dccexProtocol.check();
+  }
+  while (sent < outboundCount) {
+    _dccexProtocol.sendCommand(std::to_string(sent++).c_str());
+  }
+  stop.store(true);
+  io.join();
+  _dccexProtocol.pollStream();
+
+  // Every broadcast was either delivered in order or counted as dropped
+  for (size_t index = 1; index < recorder.addresses.size(); index++) {
+    ASSERT_LT(recorder.addresses[index - 1], recorder.addresses[index]);
+  }
+  EXPECT_EQ(recorder.addresses.size() + _dccexProtocol.getInboundOverflowCount(), (size_t)inboundCount);
+
+  // Every outbound command was either written whole and in order or counted as dropped
+  std::string output = _stream.getOutput();
+  int written = 0;
+  int last = -1;
+  for (size_t start = output.find('<'); start != std::string::npos; start = output.find('<', start + 1)) {
+    size_t end = output.find('>', start);
+    ASSERT_NE(end, std::string::npos);
+    int value = std::stoi(output.substr(start + 1, end - start - 1));
+    ASSERT_GT(value, last);
+    last = value;
+    written++;
+  }
+  EXPECT_EQ(written + (int)_dccexProtocol.getOutboundOverflowCount(), outboundCount);
+  _dccexProtocol.setDelegate(&_delegate);
+}
+
+#endif // DCCEX_THREADED
@@ -0,0 +1,139 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/TrackManagerTests.h"
+
+struct ThresholdLog {
+  int calls = 0;
+  char track = 0;
+  int percent = 0;
+  bool above = false;
+};
+
+static void recordThreshold(char track, int current, int percentOfGauge, bool above, void *context) {
+  (void)current;
+  ThresholdLog *log = static_cast<ThresholdLog *>(context);
+  log->calls++;
+  log->track = track;
+  log->percent = percentOfGauge;
+  log->above = above;
+}
+
+/**
+ * @brief Test currents are polled each period and the limits requested once
+ */
+TEST_F(TrackManagerTests, trackCurrentPollingPeriod) {
+  ASSERT_TRUE(_dccexProtocol.enableTrackCurrentPolling(500, 4));
+  EXPECT_TRUE(_dccexProtocol.isTrackCurrentPollingEnabled());
+  EXPECT_EQ(_stream.getOutput(), "<J G>");
+  _stream.clearOutput();
+
+  // Nothing until the period passes
+  advanceMillis(499);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+
+  advanceMillis(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "<J I>");
+  _stream.clearOutput();
+
+  // Disabled polling sends nothing
+  _dccexProtocol.disableTrackCurrentPolling();
+  advanceMillis(1000);
+  _dccexProtocol.check();
+  EXPECT_EQ(_stream.getOutput(), "");
+  EXPECT_EQ(_dccexProtocol.getTrackCurrentStats('A').samples, 0);
+}
+
+/**
+ * @brief Test rolling statistics over a full history
+ */
+TEST_F(TrackManagerTests, trackCurrentPollingStats) {
+  int buffer[TRACK_COUNT * 3];
+  ASSERT_TRUE(_dccexProtocol.enableTrackCurrentPolling(1000, 3, buffer));
+
+  EXPECT_CALL(_delegate, receivedTrackCurrentGauge(_, _)).Times(2);
+  EXPECT_CALL(_delegate, receivedTrackCurrent(_, _)).Times(8);
+  _stream << "<jG 1000 2000><jI 100 50><jI 400 60><jI 300 70><jI 200 80>";
+  _dccexProtocol.check();
+
+  // The first sample of A has rolled out of the history
+  TrackCurrentStats stats = _dccexProtocol.getTrackCurrentStats('A');
+  EXPECT_EQ(stats.samples, 3);
+  EXPECT_EQ(stats.latest, 200);
+  EXPECT_EQ(stats.min, 200);
+  EXPECT_EQ(stats.max, 400);
+  EXPECT_EQ(stats.mean, 300);
+  EXPECT_EQ(stats.gauge, 1000);
+  EXPECT_EQ(stats.percentOfGauge, 20);
+
+  stats = _dccexProtocol.getTrackCurrentStats('B');
+  EXPECT_EQ(stats.mean, 70);
+  EXPECT_EQ(stats.percentOfGauge, 4);
+
+  // No samples or limit for C
+  stats = _dccexProtocol.getTrackCurrentStats('C');
+  EXPECT_EQ(stats.samples, 0);
+  EXPECT_EQ(stats.latest, -1);
+  EXPECT_EQ(stats.percentOfGauge, -1);
+}
+
+/**
+ * @brief Test threshold crossings are reported once each way
+ */
+TEST_F(TrackManagerTests, trackCurrentPollingThreshold) {
+  ThresholdLog log;
+  ASSERT_TRUE(_dccexProtocol.enableTrackCurrentPolling(1000, 4));
+  _dccexProtocol.setTrackCurrentThreshold(80, recordThreshold, &log);
+
+  EXPECT_CALL(_delegate, receivedTrackCurrentGauge(_, _)).Times(2);
+  EXPECT_CALL(_delegate, receivedTrackCurrent(_, _)).Times(8);
+  _stream << "<jG 1000 1000><jI 500 100>";
+  _dccexProtocol.check();
+  EXPECT_EQ(log.calls, 0);
+
+  // B rises above, and stays above
+  _stream << "<jI 500 850><jI 500 900>";
+  _dccexProtocol.check();
+  EXPECT_EQ(log.calls, 1);
+  EXPECT_EQ(log.track, 'B');
+  EXPECT_EQ(log.percent, 85);
+  EXPECT_TRUE(log.above);
+
+  // B falls back below
+  _stream << "<jI 500 200>";
+  _dccexProtocol.check();
+  EXPECT_EQ(log.calls, 2);
+  EXPECT_EQ(log.track, 'B');
+  EXPECT_FALSE(log.above);
+}
+
+/**
+ * @brief Test a literal zero period picks the heap allocated overload rather than being taken as a buffer
+ */
+TEST_F(TrackManagerTests, trackCurrentPollingZeroPeriod) {
+  ASSERT_TRUE(_dccexProtocol.enableTrackCurrentPolling(0, 8));
+  EXPECT_TRUE(_dccexProtocol.isTrackCurrentPollingEnabled());
+  EXPECT_FALSE(_dccexProtocol.enableTrackCurrentPolling(0, 8, nullptr));
+  EXPECT_FALSE(_dccexProtocol.isTrackCurrentPollingEnabled());
+}
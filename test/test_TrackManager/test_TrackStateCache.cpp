@@ -0,0 +1,169 @@
+/* -*- c++ -*-
+ *
+ * Copyright © 2026 Peter Cole
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike
+ * 4.0 International License. To view a copy of this license, visit
+ * http://creativecommons.org/licenses/by-sa/4.0/ or send a letter to
+ * Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ * Attribution — You must give appropriate credit, provide a link to the
+ * license, and indicate if changes were made. You may do so in any
+ * reasonable manner, but not in any way that suggests the licensor
+ * endorses you or your use.
+ *
+ * ShareAlike — If you remix, transform, or build upon the material, you
+ * must distribute your contributions under the same license as the
+ * original.
+ *
+ * All other rights reserved.
+ *
+ */
+
+#include "../setup/TrackManagerTests.h"
+
+/**
+ * @brief Test track power and type responses are cached per track
+ */
+TEST_F(TrackManagerTests, trackStateCacheUpdates) {
+  // Nothing known yet
+  TrackState state = _dccexProtocol.getTrackState('A');
+  EXPECT_FALSE(state.modeKnown);
+  EXPECT_EQ(state.power, PowerUnknown);
+  EXPECT_EQ(state.current, -1);
+  EXPECT_EQ(state.gauge, -1);
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0);
+
+  // Track types, power, gauges, and currents
+  _stream << "<= A MAIN><= B PROG><= C DC 1234><p1 A><jG 1499 1000 500><jI 120 0 35>";
+  EXPECT_CALL(_delegate, receivedTrackType(_, _, _)).Times(3);
+  EXPECT_CALL(_delegate, receivedTrackCurrentGauge(_, _)).Times(3);
+  EXPECT_CALL(_delegate, receivedTrackCurrent(_, _)).Times(3);
+  _dccexProtocol.check();
+
+  state = _dccexProtocol.getTrackState('C');
+  EXPECT_TRUE(state.modeKnown);
+  EXPECT_EQ(state.mode, DC);
+  EXPECT_EQ(state.address, 1234);
+  EXPECT_EQ(state.gauge, 500);
+  EXPECT_EQ(state.current, 35);
+  EXPECT_EQ(_dccexProtocol.getTrackPower('A'), PowerOn);
+  EXPECT_EQ(_dccexProtocol.getTrackPower('B'), PowerUnknown);
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0x01);
+  EXPECT_EQ(_dccexProtocol.getTrackModeMask(MAIN), 0x01);
+  EXPECT_EQ(_dccexProtocol.getTrackModeMask(PROG), 0x02);
+  EXPECT_EQ(_dccexProtocol.getTrackModeMask(DC), 0x04);
+
+  // Changing a track's mode moves it between masks
+  _stream << "<= A DCX 3>";
+  EXPECT_CALL(_delegate, receivedTrackType('A', DCX, 3)).Times(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackModeMask(MAIN), 0x00);
+  EXPECT_EQ(_dccexProtocol.getTrackModeMask(DCX), 0x01);
+
+  // Invalid tracks are never known
+  EXPECT_EQ(_dccexProtocol.getTrackPower('Z'), PowerUnknown);
+  EXPECT_FALSE(_dccexProtocol.getTrackState('Z').modeKnown);
+}
+
+/**
+ * @brief Test global, MAIN, PROG, and JOIN power responses apply to the right tracks
+ */
+TEST_F(TrackManagerTests, trackStateCacheGroupPower) {
+  _stream << "<= A MAIN><= B PROG><= C MAIN><= D NONE><= E NONE><= F NONE><= G NONE><= H NONE>";
+  EXPECT_CALL(_delegate, receivedTrackType(_, _, _)).Times(8);
+  _dccexProtocol.check();
+
+  // Global power applies to every track
+  _stream << "<p1>";
+  EXPECT_CALL(_delegate, receivedTrackPower(PowerOn)).Times(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0xFF);
+
+  // MAIN off applies to the MAIN tracks only
+  _stream << "<p0 MAIN>";
+  EXPECT_CALL(_delegate, receivedTrackPower(PowerOff)).Times(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0xFA);
+  EXPECT_EQ(_dccexProtocol.getTrackPower('A'), PowerOff);
+  EXPECT_EQ(_dccexProtocol.getTrackPower('B'), PowerOn);
+
+  // PROG off then JOIN on
+  _stream << "<p0 PROG>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0xF8);
+
+  _stream << "<p1 JOIN>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0xFF);
+}
+
+/**
+ * @brief Test MAIN power with unknown track modes leaves the track powers unknown so commands are still sent
+ */
+TEST_F(TrackManagerTests, trackStateCacheGroupPowerUnknownModes) {
+  _stream << "<p1 A>";
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPower('A'), PowerOn);
+
+  // A may be a MAIN track, so its power is no longer known
+  _stream << "<p0 MAIN>";
+  EXPECT_CALL(_delegate, receivedTrackPower(PowerOff)).Times(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPower('A'), PowerUnknown);
+  EXPECT_EQ(_dccexProtocol.getTrackPowerMask(), 0x00);
+
+  _dccexProtocol.powerTrackOn('A');
+  EXPECT_EQ(_stream.getOutput(), "<1 A>");
+  _stream.clearOutput();
+
+  // Once the mode is known, only the MAIN tracks change
+  _stream << "<= A MAIN><= B PROG><p1 A><p1 B>";
+  EXPECT_CALL(_delegate, receivedTrackType(_, _, _)).Times(2);
+  _dccexProtocol.check();
+  _stream << "<p0 MAIN>";
+  EXPECT_CALL(_delegate, receivedTrackPower(PowerOff)).Times(1);
+  _dccexProtocol.check();
+  EXPECT_EQ(_dccexProtocol.getTrackPower('A'), PowerOff);
+  EXPECT_EQ(_dccexProtocol.getTrackPower('B'), PowerOn);
+}
+
+/**
+ * @brief Test commands matching the cached state are not sent
+ */
+TEST_F(TrackManagerTests, trackStateCacheSkipsRedundantCommands) {
+  // Unknown state always sends
+  _dccexProtocol.powerTrackOn('A');
+  _dccexProtocol.setTrackType('A', MAIN, 0);
+  EXPECT_EQ(_stream.getOutput(), "<1 A><= A MAIN>");
+  _stream.clearOutput();
+
+  _stream << "<p1 A><= A MAIN><= B DC 10>";
+  EXPECT_CALL(_delegate, receivedTrackType(_, _, _)).Times(2);
+  _dccexProtocol.check();
+
+  // Known state matches, nothing sent
+  _dccexProtocol.powerTrackOn('A');
+  _dccexProtocol.setTrackType('A', MAIN, 0);
+  _dccexProtocol.setTrackType('B', DC, 10);
+  EXPECT_EQ(_stream.getOutput(), "");
+
+  // Differences are sent
+  _dccexProtocol.powerTrackOff('A');
+  _dccexProtocol.setTrackType('B', DC, 11);
+  EXPECT_EQ(_stream.getOutput(), "<0 A><= B DC 11>");
+  _stream.clearOutput();
+
+  // Clearing the cache sends again
+  _dccexProtocol.clearTrackStates();
+  _dccexProtocol.setTrackType('A', MAIN, 0);
+  EXPECT_EQ(_stream.getOutput(), "<= A MAIN>");
+}
+
+/**
+ * @brief Test requesting all track types
+ */
+TEST_F(TrackManagerTests, requestTrackTypes) {
+  _dccexProtocol.requestTrackTypes();
+  ASSERT_EQ(_stream.getOutput(), "<=>");
+}
@@ -117,3 +117,73 @@ TEST_F(TurntableTests, orphanedIndexEntryLeak) {
   // Cleanup
   Turntable::clearTurntableList();
 }
+
+/**
+ * @brief Test indexes are stored in one block per turntable and the list completes on the last expected index
+ */
+TEST_F(TurntableTests, parseIndexesIntoReservedBlock) {
+  _dccexProtocol.getLists(false, false, false, true);
+  _stream << "<jO 1 2>";
+  _dccexProtocol.check();
+  _stream << R"(<jO 1 1 0 3 "EX-Turntable">)";
+  _stream << R"(<jO 2 0 0 2 "DCC Turntable">)";
+  _dccexProtocol.check();
+
+  // Not complete until every expected index has arrived
+  EXPECT_CALL(_delegate, receivedTurntableList()).Times(0);
+  _stream << R"(<jP 1 0 900 "Home">)";
+  _stream << R"(<jP 1 1 450 "Position 1">)";
+  _stream << R"(<jP 2 0 0 "Home">)";
+  _stream << R"(<jP 1 2 1800 "Position 2">)";
+  _dccexProtocol.check();
+  EXPECT_FALSE(_dccexProtocol.receivedTurntableList());
+  Mock::VerifyAndClearExpectations(&_delegate);
+
+  EXPECT_CALL(_delegate, receivedTurntableList()).Times(Exactly(1));
+  _stream << R"(<jP 2 1 450 "Position 1">)";
+  _dccexProtocol.check();
+  EXPECT_TRUE(_dccexProtocol.receivedTurntableList());
+
+  // Indexes are adjacent in memory, in the order received
+  Turntable *turntable1 = _dccexProtocol.getTurntableById(1);
+  ASSERT_NE(turntable1, nullptr);
+  EXPECT_EQ(turntable1->getIndexCount(), 3);
+  TurntableIndex *home = turntable1->getFirstIndex();
+  ASSERT_NE(home, nullptr);
+  int expectedId = 0;
+  for (TurntableIndex *index : turntable1->getIndexList()) {
+    EXPECT_EQ(index, home + expectedId);
+    EXPECT_EQ(index->getId(), expectedId);
+    EXPECT_EQ(index->getTTId(), 1);
+    expectedId++;
+  }
+  EXPECT_STREQ(turntable1->getIndexById(2)->getName(), "Position 2");
+}
+
+/**
+ * @brief Test indexes beyond the reserved space are allocated individually
+ */
+TEST_F(TurntableTests, addIndexesBeyondReservedBlock) {
+  Turntable *turntable = new Turntable(1);
+  EXPECT_FALSE(turntable->reserveIndexes(0));
+  ASSERT_TRUE(turntable->reserveIndexes(2));
+  TurntableIndex *index0 = turntable->addIndex(0, 0, "Home");
+  TurntableIndex *index1 = turntable->addIndex(1, 900, "Position 1");
+  EXPECT_EQ(index1, index0 + 1);
+
+  // Can't reserve again once indexes are stored
+  EXPECT_FALSE(turntable->reserveIndexes(4));
+
+  // Overflow and manually created indexes still join the same list
+  TurntableIndex *index2 = turntable->addIndex(2, 1800, "Position 2");
+  TurntableIndex *index3 = new TurntableIndex(1, 3, 2700, "Position 3");
+  turntable->addIndex(index3);
+  EXPECT_EQ(turntable->getIndexCount(), 4);
+  EXPECT_EQ(index1->getNextIndex(), index2);
+  EXPECT_EQ(index2->getNextIndex(), index3);
+  EXPECT_STREQ(turntable->getIndexById(2)->getName(), "Position 2");
+
+  // Mixed storage is cleaned up by the destructor
+  delete turntable;
+  EXPECT_EQ(Turntable::getFirst(), nullptr);
+}